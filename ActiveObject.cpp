@@ -1,45 +1,54 @@
 #include "ActiveObject.hpp"
+#include "NumaTopology.hpp"
+#include <algorithm>
 
-ActiveObject::ActiveObject(int stage) : stageID(stage), working(false), stop(false)
+#define FUSION_PROBE_INTERVAL 64 // Every so many fusion decisions one task is handed over to keep the hand-off cost measured
+#define AVERAGE_WEIGHT_SHIFT 3   // Moving averages - each sample weighs 1/8
+
+// Exponential moving average - one compare-and-swap per sample, so samples from several threads are all kept
+static void updateAverage(std::atomic<int64_t> &average, int64_t sample)
+{
+    int64_t current = average.load(std::memory_order_relaxed);
+    while (!average.compare_exchange_weak(current, current == 0 ? sample : current + ((sample - current) >> AVERAGE_WEIGHT_SHIFT),
+                                          std::memory_order_relaxed))
+    {
+    }
+}
+
+ActiveObject::ActiveObject(int stage, const std::string &label, size_t batchSize)
+    : stop(false), stageID(stage), metricID(-1), joinStage(false), batchSize(batchSize > 0 ? batchSize : 1), adaptiveFusion(false),
+      statistics("Stage " + std::to_string(stage) + " (" + label + ")"), stageName("Stage " + std::to_string(stage) + " (" + label + ")"),
+      queueWaitName("Stage " + std::to_string(stage) + " (" + label + ") queue wait")
 {
-    this->queue_taskData = std::queue<std::weak_ptr<Graph>>();                           // task queue for the active object
+    this->queue_taskData = std::queue<GraphTask>();                                       // task queue for the active object
     this->activeObjectThread = std::make_unique<std::thread>(&ActiveObject::work, this); // Create a new thread for the active object
 }
 
 ActiveObject::~ActiveObject()
 {
     // // Check if the thread is joinable
-    {
-        std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex 
-        std::cout << "\nActive-Object - Stage " << stageID << " : Destruction Activated" << std::endl;
-    }
+    LOG_DEBUG("Active-Object - Stage " << stageID << " : Destruction Activated");
     if (this->activeObjectThread && this->activeObjectThread->joinable())
     {
-        {
-            std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex 
-            std::cout << "\nActive-Object - Stage " << stageID << ": Join Thread - Destruction" << std::endl;
-        }
+        LOG_DEBUG("Active-Object - Stage " << stageID << ": Join Thread - Destruction");
         this->activeObjectThread->join(); // Join the thread (wait for the thread to finish)
     }
 
     this->activeObjectThread.reset(); // release unique ptr - before destruction join
-    {
-        std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex 
-        std::cout << "\nStage " << this->stageID << " (Active-Object):  Release smart pointer - Thread" << std::endl;
-        std::cout << "\n********* FINISH Active Object " << stageID << " Stop Process *********" << std::endl;
-    }
+    LOG_DEBUG("Stage " << this->stageID << " (Active-Object):  Release smart pointer - Thread");
+    LOG_INFO("********* FINISH Active Object " << stageID << " Stop Process *********");
 }
 
-// Set the next stage
-void ActiveObject::setNextStage(std::weak_ptr<ActiveObject> wptr_nextStage)
+// Add a next stage - a task finished here goes to every next stage
+void ActiveObject::addNextStage(std::weak_ptr<ActiveObject> wptr_nextStage)
 {
     if (wptr_nextStage.lock() != nullptr)
     {
-        this->nextStage = wptr_nextStage;
+        this->nextStages.push_back(wptr_nextStage);
     }
     else
     {
-        std::cerr << "Set Next Stage Failed, Stage: " << stageID << std::endl;
+        LOG_ERROR("Set Next Stage Failed, Stage: " << stageID);
     }
 }
 
@@ -49,121 +58,292 @@ void ActiveObject::setTaskHandler(std::function<void(std::weak_ptr<Graph>)> task
     bool isValidTaskFunction = static_cast<bool>(taskFunction);
     if (isValidTaskFunction)
     {
-        {
-            std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex 
-            std::cout << "Set Task Handler for stage: " << stageID << std::endl;
-        }
+        LOG_DEBUG("Set Task Handler for stage: " << stageID);
         this->taskHandler = std::move(taskFunction); // Set the task handler to the provided handler
     }
     else
     {
-        std::cerr << "Set Task Handler Failed, Stage: " << stageID << std::endl;
+        LOG_ERROR("Set Task Handler Failed, Stage: " << stageID);
     }
 }
 
-// insert task to the queue
-void ActiveObject::enqueueTask(std::weak_ptr<Graph> wptr_graph)
+// Set the metric of the stage - tasks that did not request it skip the stage
+void ActiveObject::setMetric(int metric)
+{
+    this->metricID = metric;
+}
+
+// Set the stage to join the branches of forked tasks
+void ActiveObject::setJoinStage()
+{
+    this->joinStage = true;
+}
+
+// Set the adaptive fusion of the next stages
+void ActiveObject::setAdaptiveFusion(bool enabled)
+{
+    this->adaptiveFusion = enabled;
+}
+
+// insert tasks to the queue - one lock and at most one notify for the whole batch
+void ActiveObject::enqueueTasks(std::vector<GraphTask> tasks)
 {
-    if (wptr_graph.lock() != nullptr)
+    if (tasks.empty())
+    {
+        return;
+    }
+    bool wasEmpty;
     {
         std::lock_guard<std::mutex> lock(this->mtx_AO); // Lock the mutex for the task queue
-        this->queue_taskData.push(std::move(wptr_graph));
-        // Log it if it actually have next stage to enqueue
-        if(this->nextStage.lock()) 
+        wasEmpty = this->queue_taskData.empty();
+        auto enqueueTime = std::chrono::steady_clock::now();
+        if (wasEmpty && this->sleeping && !this->wakeupPending)
         {
-            std::cout<<"Active-Object: Stage "<<this->stageID<<" - Enqueue Task"<<std::endl;
-        }else
+            this->wakeupPending = true; // Hand-off cost sample - the thread measures when it wakes up
+            this->notifyTime = enqueueTime;
+        }
+        for (GraphTask &task : tasks)
         {
-            std::cout<<"Active-Object: Stage "<<this->stageID<<" - No Next Stage \n**Task is Done**"<<std::endl;
+            task.enqueueTime = enqueueTime;
+            this->queue_taskData.push(std::move(task));
+            this->statistics.recordEnqueue(this->queue_taskData.size());
         }
     }
-    else
+    LOG_DEBUG("Active-Object: Stage " << this->stageID << " - Enqueue " << tasks.size() << " Tasks");
+
+    // The thread only sleeps on an empty queue
+    if (wasEmpty)
+    {
+        this->cv_AO.notify_one();
+    }
+}
+
+// The handler of this stage costs less than waking its thread - run it in the thread of the previous stage
+bool ActiveObject::shouldFuse()
+{
+    int64_t handler = this->handlerNs.load(std::memory_order_relaxed);
+    int64_t handoff = this->handoffNs.load(std::memory_order_relaxed);
+    if (handler == 0 || handoff == 0 || handler >= handoff)
     {
-        std::cerr << "Enqueue Failed, Stage: " << this->stageID << std::endl;
+        return false; // Not measured yet, or worth its own thread
     }
+    return this->fusionDecisions.fetch_add(1, std::memory_order_relaxed) % FUSION_PROBE_INTERVAL != 0;
+}
 
-    if (!this->working)
+// Run the handler of this stage on a task - on the stage thread, or fused into the thread of an earlier stage
+// caller is the statistics of the running thread's stage (cancellations are counted where they happen)
+bool ActiveObject::runHandler(GraphTask &task, StageStatistics &caller, bool fused)
+{
+    auto handlerStart = std::chrono::steady_clock::now();
+    try
     {
-        this->cv_AO.notify_one();
+        if (task.cancellation != nullptr && task.cancellation->isCancelled()) // Stage boundary - the rest of the pipeline is skipped
+        {
+            throw JobCancelled(task.cancellation->reason());
+        }
+        CancellationToken::Scope cancellationScope(task.cancellation.get());
+        this->taskHandler(task.graph); // Call the task handler
+        auto handlerEnd = std::chrono::steady_clock::now();
+        updateAverage(this->handlerNs, std::chrono::duration_cast<std::chrono::nanoseconds>(handlerEnd - handlerStart).count());
+        if (fused)
+        {
+            this->statistics.recordFused();
+        }
+        else
+        {
+            this->statistics.recordExecution(handlerEnd - handlerStart, true);
+        }
+        Tracer::getInstance().recordComplete(this->stageName, fused ? "pipeline (fused)" : "pipeline", task.graphID, handlerStart, handlerEnd);
+        return true;
+    }
+    catch (const JobCancelled &e)
+    {
+        caller.recordCancelled();
+        if (auto sharedGraph = task.graph.lock())
+        {
+            sharedGraph->resetMSTDataCalculation(); // Processed again by the next request
+        }
+        LOG_DEBUG("Stage " << this->stageID << ": graph " << task.graphID << " dropped - " << e.what());
+    }
+    catch (const std::exception &e)
+    {
+        if (!fused)
+        {
+            this->statistics.recordExecution(std::chrono::steady_clock::now() - handlerStart, false);
+        }
+        LOG_ERROR("Error - Execute task: " << e.what());
+    }
+    return false;
+}
+
+// Metric stages run only for the tasks that requested their metric
+bool ActiveObject::accepts(const GraphTask &task) const
+{
+    return this->metricID < 0 || (task.metrics >> this->metricID) & 1u;
+}
+
+// Send a task finished by this stage to the next stages - several next stages fork it into branches
+void ActiveObject::forward(GraphTask task, StageStatistics &caller, Handoffs &handoffs)
+{
+    std::vector<std::shared_ptr<ActiveObject>> targets;
+    for (const auto &wptr_next : this->nextStages)
+    {
+        if (auto next = wptr_next.lock())
+        {
+            targets.push_back(std::move(next));
+        }
+    }
+    if (targets.size() > 1)
+    {
+        task.join = std::make_shared<BranchJoin>(static_cast<int>(targets.size()));
+    }
+    for (size_t i = 0; i < targets.size(); ++i)
+    {
+        targets[i]->deliver(i + 1 == targets.size() ? std::move(task) : task, caller, handoffs);
+    }
+}
+
+// A task arrives at this stage - the join waits for the other branches, an unrequested metric is skipped,
+// a cheap handler runs inline in the caller's thread, and the rest is queued with the caller's batch
+void ActiveObject::deliver(GraphTask task, StageStatistics &caller, Handoffs &handoffs)
+{
+    if (this->joinStage && task.join != nullptr)
+    {
+        if (task.join->pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+        {
+            return; // The last branch continues
+        }
+        bool dropped = task.join->dropped.load(std::memory_order_relaxed);
+        task.join.reset();
+        if (dropped)
+        {
+            if (auto sharedGraph = task.graph.lock())
+            {
+                sharedGraph->resetMSTDataCalculation(); // The other branches may have finished after the drop reset the graph
+            }
+            return;
+        }
+    }
+    if (!accepts(task))
+    {
+        forward(std::move(task), caller, handoffs);
+        return;
+    }
+    if (this->adaptiveFusion && shouldFuse())
+    {
+        if (!runHandler(task, caller, true))
+        {
+            dropBranch(task);
+            return;
+        }
+        forward(std::move(task), caller, handoffs);
+        return;
+    }
+    auto handoff = std::find_if(handoffs.begin(), handoffs.end(), [this](const auto &entry) { return entry.first.get() == this; });
+    if (handoff == handoffs.end())
+    {
+        handoff = handoffs.insert(handoffs.end(), {shared_from_this(), {}});
+    }
+    handoff->second.push_back(std::move(task));
+}
+
+// A branch of a forked task was cancelled or failed - the join ends the task instead of finishing it
+void ActiveObject::dropBranch(GraphTask &task)
+{
+    if (task.join == nullptr)
+    {
+        return;
+    }
+    task.join->dropped.store(true, std::memory_order_relaxed);
+    if (task.join->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+    {
+        if (auto sharedGraph = task.graph.lock())
+        {
+            sharedGraph->resetMSTDataCalculation();
+        }
     }
 }
 
 // The main work function for the active object
 void ActiveObject::work()
 {
+    Tracer::setThreadName("Pipeline " + this->stageName);
+    NumaTopology::getInstance().pinCurrentThread(this->stageID);
+    std::vector<GraphTask> batch;
+    Handoffs handoffs;
     // infinite loop till the stop flag is set to true so that the thread can be stopped
-    while (!this->stop)
-    { // Loop until the stop flag is set
-
-        if (queue_taskData.empty())
-        {                          // Check if the task queue is empty
-            this->working = false; // Set the working flag to false (in case it was working before it was empty)
-
+    while (true)
+    {
+        {
             std::unique_lock<std::mutex> lock(this->mtx_AO);
-            std::cout << "Stage " << this->stageID << " (Thread " << std::this_thread::get_id() << ") is sleeping" << std::endl;
             // Wait until a task is [enqueued] or [stop flag is set] and [notify condition]
+            this->sleeping = this->queue_taskData.empty();
             cv_AO.wait(lock, [this]
                        { return (!this->queue_taskData.empty()) || this->stop; });
-
-            this->working = true; // Set the working flag to true
-            std::cout << "Stage " << stageID << " (Thread " << std::this_thread::get_id() << ") has woke up" << std::endl;
+            this->sleeping = false;
+            if (this->wakeupPending)
+            {
+                this->wakeupPending = false;
+                updateAverage(this->handoffNs, std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - this->notifyTime).count());
+            }
+            if (this->stop)
+            {
+                lock.unlock();
+                stopProcess();
+                return;
+            }
+            // Drain up to a batch under one lock acquisition
+            while (!this->queue_taskData.empty() && batch.size() < this->batchSize)
+            {
+                batch.push_back(std::move(this->queue_taskData.front()));
+                this->queue_taskData.pop();
+            }
+            this->statistics.recordDequeue(this->queue_taskData.size());
         }
 
-        if (this->stop)
-        {
-            stopProcess();
-            return;
-        }
-        else
+        for (GraphTask &task : batch)
         {
-            try{
-                std::weak_ptr<Graph> wptr_graph;
-                {
-                    std::lock_guard<std::mutex> lock(this->mtx_AO); // Lock the mutex for the active task
-                    wptr_graph = this->queue_taskData.front();
-                    this->queue_taskData.pop();
-                }
-                this->taskHandler(wptr_graph); // Call the task handler
-
-                // get the next stage shared ptr
-                if (auto nextStagePtr = this->nextStage.lock())
-                {
-                    {
-                        std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex
-                        std::cout<<"Active-Object: Stage "<<this->stageID<<" - Enqueue Task to Next Stage: "<<nextStagePtr->stageID<<std::endl;
-                    }
-                    nextStagePtr->enqueueTask(wptr_graph);
-                }
-            }
-            catch(const std::exception& e)
+            this->statistics.recordWait(task.enqueueTime);
+            Tracer::getInstance().recordAsync(this->queueWaitName, "queue", task.graphID, task.enqueueTime, std::chrono::steady_clock::now());
+            if (!runHandler(task, this->statistics, false))
             {
-                std::cerr << "Error - Execute task: " << e.what() << std::endl;
+                dropBranch(task);
+                continue;
             }
+            forward(std::move(task), this->statistics, handoffs);
         }
+        batch.clear();
+
+        for (auto &[stage, tasks] : handoffs)
+        {
+            LOG_DEBUG("Active-Object: Stage " << this->stageID << " - Enqueue " << tasks.size() << " Tasks to Stage " << stage->stageID);
+            stage->enqueueTasks(std::move(tasks));
+        }
+        handoffs.clear();
     }
 }
 
 void ActiveObject::stopActiveObject()
 {
+    LOG_INFO("********* START Active Object " << this->stageID << " Stop Process *********");
     {
         std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex        
-        std::cout << "\n********* START Active Object " << this->stageID << " Stop Process *********" << std::endl;
         this->stop = true;
     }
-    if (!this->working)
-    {
-        this->cv_AO.notify_all();
-    }
+    this->cv_AO.notify_all();
 }
 
 void ActiveObject::stopProcess()
 {
-    std::unique_lock<std::mutex> lock(mtx_AO); // Lock the mutex 
+    std::lock_guard<std::mutex> lock(mtx_AO); // Lock the mutex 
     while (!this->queue_taskData.empty())
     {
-        lock.unlock();
-        this->queue_taskData.front().reset(); // release weak ptr
-        this->queue_taskData.pop();
+        this->queue_taskData.pop(); // release weak ptr
     }
-    std::cout << "\nActive-Object: Stage " << this->stageID << " (Active-Object):  Clean tasks queue" << std::endl;
+    LOG_DEBUG("Active-Object: Stage " << this->stageID << " (Active-Object):  Clean tasks queue");
+}
+
+std::string ActiveObject::getStatistics() const
+{
+    return this->statistics.report();
 }
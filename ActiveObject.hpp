@@ -7,31 +7,78 @@
 #include <atomic>
 #include <queue>
 #include <functional>
+#include <memory>
 #include <utility>
+#include <string>
+#include <vector>
 #include "Graph.hpp"
+#include "Logger.hpp"
+#include "GraphTask.hpp"
+#include "StageStatistics.hpp"
+#include "Tracer.hpp"
 
-class ActiveObject
+/*
+    Stage of the pipeline - a thread serving a queue of graphs with one handler.
+    Stages form a DAG: a stage with several next stages forks a task into parallel branches, and
+    a join stage runs a task once every branch has reached it (BranchJoin of the task). A metric
+    stage only runs for the tasks that requested its metric - the others pass through it to its
+    next stage without a hand-off.
+    The thread takes up to batchSize tasks per lock acquisition and hands the finished ones to
+    the next stages in one batch per stage (one lock and one notify per batch instead of per graph).
+    With adaptive fusion a stage runs the handler of a next stage inline when that handler is
+    measured to be cheaper than handing a task over, and so on down the branch, so cheap stages
+    of small graphs cost no context switch. The hand-off cost is the notify-to-wakeup latency of
+    the stage thread, sampled only when a task arrives at an empty queue while the thread sleeps -
+    time spent queued behind other tasks is load, not hand-off cost. Both costs are moving
+    averages; every FUSION_PROBE_INTERVAL-th task is still handed over so the hand-off cost
+    stays measured.
+*/
+class ActiveObject : public std::enable_shared_from_this<ActiveObject>
 {
 private:
     std::function<void(std::weak_ptr<Graph>)> taskHandler; // Task handler for the active object
-    std::queue<std::weak_ptr<Graph>> queue_taskData;       // Task queue for the active object
+    std::queue<GraphTask> queue_taskData;                  // Task queue for the active object
     std::unique_ptr<std::thread> activeObjectThread;       // Thread for the active object
-    std::weak_ptr<ActiveObject> nextStage;                 // Pointer to the next stage
+    std::vector<std::weak_ptr<ActiveObject>> nextStages;   // Next stages - more than one forks the task into branches
     std::mutex mtx_AO;                                     // Mutex for the active task
     std::condition_variable cv_AO;                         // Condition variable for the active task
     std::atomic<bool> stop{false};                         // Flag to stop the thread
     int stageID;                                           // ID of the stage
-    bool working;                                          // Flag to check if the active object is working
+    int metricID;                                          // MetricRegistry id the stage computes (-1 - runs for every task)
+    bool joinStage;                                        // Waits for all the branches of a task
+    size_t const batchSize;                                // Tasks taken per lock acquisition
+    bool adaptiveFusion;                                   // Run cheap next stages inline (set before the first task)
+    std::atomic<int64_t> handlerNs{0};                     // Moving average of the handler time (written by whoever runs it)
+    std::atomic<int64_t> handoffNs{0};                     // Moving average of the notify-to-wakeup latency (stage thread)
+    bool sleeping = false;                                 // The thread waits on an empty queue (guarded by mtx_AO)
+    bool wakeupPending = false;                            // A notify to the sleeping thread is to be measured (guarded by mtx_AO)
+    std::chrono::steady_clock::time_point notifyTime;      // Time of that notify (guarded by mtx_AO)
+    std::atomic<uint64_t> fusionDecisions{0};              // Counts fusion decisions - every probe interval one is handed over
+    StageStatistics statistics;                            // Queue and handler statistics of the stage
+    std::string stageName;                                 // Name of the stage in statistics and traces
+    std::string queueWaitName;                             // Trace name of the queue wait
+
+    using Handoffs = std::vector<std::pair<std::shared_ptr<ActiveObject>, std::vector<GraphTask>>>; // Finished tasks by the stage they go to
 
     void work();        // Work function for the active object
     void stopProcess(); // After stop flag detected - initial process to stop the active object before destruction
+    bool runHandler(GraphTask &task, StageStatistics &caller, bool fused); // False if the task ends here (cancelled or failed)
+    bool shouldFuse();  // The handler of this stage is cheaper than a hand-off to it
+    bool accepts(const GraphTask &task) const;                                  // The task requested the metric of the stage
+    void forward(GraphTask task, StageStatistics &caller, Handoffs &handoffs);  // Send a finished task to the next stages
+    void deliver(GraphTask task, StageStatistics &caller, Handoffs &handoffs);  // Task arriving at this stage - join, skip, fuse or queue
+    static void dropBranch(GraphTask &task);                                    // The branch of a task ended early
 
 public:
-    ActiveObject(int stage);                                                     // Constructor
+    ActiveObject(int stage, const std::string &label, size_t batchSize = 1);     // Constructor - label names the stage in statistics
     ~ActiveObject();                                                             // Destructor
-    void enqueueTask(std::weak_ptr<Graph> wptr_graph);                           // Enqueue a graph to the task queue
-    void setNextStage(std::weak_ptr<ActiveObject> wptr_nextStage);               // Set the next stage
+    void enqueueTasks(std::vector<GraphTask> tasks);                             // Enqueue graphs to the task queue (one lock)
+    void addNextStage(std::weak_ptr<ActiveObject> wptr_nextStage);               // Add a next stage (a second one forks)
+    void setMetric(int metric);                                                  // Run only for the tasks requesting the metric
+    void setJoinStage();                                                         // Wait for every branch of a forked task
     void setTaskHandler(std::function<void(std::weak_ptr<Graph>)> taskFunction); // Set the task handler
+    void setAdaptiveFusion(bool enabled);                                        // Fuse cheap next stages into this thread
     void stopActiveObject();                                                     // Stop the active object
+    std::string getStatistics() const;                                           // Statistics summary of the stage
 };
 #endif
\ No newline at end of file
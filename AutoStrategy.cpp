@@ -0,0 +1,41 @@
+#include "AutoStrategy.hpp"
+#include <algorithm>
+#include <limits>
+
+template <typename Weight, typename NoEdge>
+MSTCostModel::GraphFeatures BasicAutoStrategy<Weight, NoEdge>::features(const Matrix &graphAdjacencyMatrix)
+{
+    int numVertices = graphAdjacencyMatrix.size();
+    int64_t numEdges = 0;
+    Weight lightest = std::numeric_limits<Weight>::max();
+    Weight heaviest = std::numeric_limits<Weight>::lowest();
+    for (int i = 0; i < numVertices; i++)
+    {
+        for (int j = i + 1; j < numVertices; j++)
+        {
+            Weight weight = graphAdjacencyMatrix[i][j];
+            if (NoEdge::isEdge(weight))
+            {
+                ++numEdges;
+                lightest = std::min(lightest, weight);
+                heaviest = std::max(heaviest, weight);
+            }
+        }
+    }
+    double possibleEdges = numVertices > 1 ? static_cast<double>(numVertices) * (numVertices - 1) / 2 : 1;
+    double weightRange = numEdges > 0 ? static_cast<double>(heaviest) - static_cast<double>(lightest) : 0;
+    return {numVertices, numEdges, numEdges / possibleEdges, weightRange};
+}
+
+template <typename Weight, typename NoEdge>
+std::unique_ptr<BasicAdjacencyMatrix<Weight>> BasicAutoStrategy<Weight, NoEdge>::computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource)
+{
+    // The scan is a fraction of either strategy - both read the whole matrix at least once
+    if (MSTCostModel::getInstance().choose(features(graphAdjacencyMatrix)) == MSTCostModel::Kruskal)
+    {
+        return this->kruskal.computeMST(graphAdjacencyMatrix, resultResource);
+    }
+    return this->prim.computeMST(graphAdjacencyMatrix, resultResource);
+}
+
+INSTANTIATE_WEIGHT_POLICIES(BasicAutoStrategy)
@@ -0,0 +1,27 @@
+#ifndef AUTO_STRATEGY_HPP
+#define AUTO_STRATEGY_HPP
+
+#include "MSTStrategy.hpp"
+#include "PrimStrategy.hpp"
+#include "KruskalStrategy.hpp"
+#include "MSTCostModel.hpp"
+#include <memory>
+
+// Picks Prim or Kruskal per graph by the estimated time of the calibrated cost model (MSTCostModel.hpp)
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicAutoStrategy : public BasicMSTStrategy<Weight, NoEdge>
+{
+public:
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+
+    std::unique_ptr<Matrix> computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource) override;
+    static MSTCostModel::GraphFeatures features(const Matrix &graphAdjacencyMatrix); // One pass over the upper triangle
+
+private:
+    BasicPrimStrategy<Weight, NoEdge> prim;
+    BasicKruskalStrategy<Weight, NoEdge> kruskal;
+};
+
+using AutoStrategy = BasicAutoStrategy<int>;
+
+#endif
@@ -0,0 +1,56 @@
+#include "CancellationToken.hpp"
+
+static thread_local const CancellationToken *currentToken = nullptr; // Token of the job the thread runs
+
+CancellationToken::CancellationToken(std::chrono::steady_clock::time_point deadline, std::shared_ptr<const CancellationToken> parent)
+    : deadline(deadline), parent(std::move(parent))
+{
+}
+
+std::shared_ptr<CancellationToken> CancellationToken::forJob(std::chrono::milliseconds timeout, std::shared_ptr<const CancellationToken> parent)
+{
+    auto deadline = timeout.count() > 0 ? std::chrono::steady_clock::now() + timeout : std::chrono::steady_clock::time_point::max();
+    return std::make_shared<CancellationToken>(deadline, std::move(parent));
+}
+
+void CancellationToken::cancel()
+{
+    this->cancelled.store(true, std::memory_order_relaxed);
+}
+
+bool CancellationToken::isCancelled() const
+{
+    return this->cancelled.load(std::memory_order_relaxed) || isExpired() || (this->parent != nullptr && this->parent->isCancelled());
+}
+
+bool CancellationToken::isExpired() const
+{
+    if (this->deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() >= this->deadline)
+    {
+        return true;
+    }
+    return this->parent != nullptr && this->parent->isExpired();
+}
+
+const char *CancellationToken::reason() const
+{
+    return isExpired() ? "deadline exceeded" : "cancelled";
+}
+
+CancellationToken::Scope::Scope(const CancellationToken *token) : previous(currentToken)
+{
+    currentToken = token;
+}
+
+CancellationToken::Scope::~Scope()
+{
+    currentToken = this->previous;
+}
+
+void CancellationToken::checkpoint()
+{
+    if (currentToken != nullptr && currentToken->isCancelled())
+    {
+        throw JobCancelled(currentToken->reason());
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef CANCELLATIONTOKEN_HPP
+#define CANCELLATIONTOKEN_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+// Thrown by CancellationToken::checkpoint() when the work of the calling thread is no longer wanted
+class JobCancelled : public std::runtime_error
+{
+public:
+    explicit JobCancelled(const std::string &reason) : std::runtime_error(reason) {}
+};
+
+/*
+    Cooperative cancellation of a job (an MST computation, or the metrics of a graph in the
+    Pipeline / Leader-Follower). A token is cancelled explicitly, when its deadline passes, or
+    when its parent is cancelled - a job token has the client session as parent, so a client
+    that disconnects cancels all its jobs.
+    The thread running a job installs the token with a Scope, and the long loops (computeMST,
+    Floyd-Warshall) call checkpoint() once per row - the thread's current token is a thread
+    local, so the strategies and metric kernels keep their signatures. Queues check the token
+    at every stage boundary and drop the job without running it.
+*/
+class CancellationToken
+{
+private:
+    std::atomic<bool> cancelled{false};
+    std::chrono::steady_clock::time_point deadline;         // time_point::max() - no deadline
+    std::shared_ptr<const CancellationToken> parent;        // Cancels this token too (nullptr - none)
+
+public:
+    CancellationToken(std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max(),
+                      std::shared_ptr<const CancellationToken> parent = nullptr);
+    // Token of a job - no deadline if the timeout is zero
+    static std::shared_ptr<CancellationToken> forJob(std::chrono::milliseconds timeout, std::shared_ptr<const CancellationToken> parent);
+
+    void cancel();
+    bool isCancelled() const;  // Cancelled, past the deadline, or the parent is cancelled
+    bool isExpired() const;    // Past the deadline (of this token or a parent)
+    const char *reason() const;
+
+    // Makes a token the current token of the calling thread until the scope ends
+    class Scope
+    {
+    private:
+        const CancellationToken *previous;
+
+    public:
+        explicit Scope(const CancellationToken *token);
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+    };
+
+    static void checkpoint(); // Throws JobCancelled if the current token of the thread is cancelled
+};
+
+#endif
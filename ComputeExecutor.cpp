@@ -0,0 +1,112 @@
+#include "ComputeExecutor.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include "NumaTopology.hpp"
+
+ComputeExecutor::ComputeExecutor(int numThreads, size_t queueLimit)
+    : stop(false), queueLimit(queueLimit), queueStatistics("MST Compute Queue")
+{
+    LOG_INFO("Starting MST Compute Executor: " << numThreads << " threads, queue limit " << queueLimit);
+    for (int i = 0; i < numThreads; ++i)
+    {
+        this->workerStatistics.push_back(std::make_unique<StageStatistics>("MST Compute Worker " + std::to_string(i)));
+    }
+    for (int i = 0; i < numThreads; ++i)
+    {
+        this->workers.emplace_back(&ComputeExecutor::work, this, i);
+    }
+}
+
+ComputeExecutor::~ComputeExecutor()
+{
+    size_t droppedJobs;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_executor);
+        this->stop = true;
+        droppedJobs = this->queue_jobs.size();
+        this->queue_jobs = std::queue<Job>();
+    }
+    this->cv_executor.notify_all();
+    for (auto &worker : this->workers)
+    {
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+    LOG_INFO("MST Compute Executor: Stopped, " << droppedJobs << " waiting jobs dropped");
+}
+
+bool ComputeExecutor::trySubmit(int graphID, std::function<void()> job, std::shared_ptr<const CancellationToken> cancellation)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_executor);
+        if (this->stop || this->queue_jobs.size() >= this->queueLimit)
+        {
+            this->rejectedJobs.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        this->queue_jobs.push(Job{std::move(job), std::chrono::steady_clock::now(), graphID, std::move(cancellation)});
+        this->queueStatistics.recordEnqueue(this->queue_jobs.size());
+    }
+    this->cv_executor.notify_one();
+    return true;
+}
+
+void ComputeExecutor::work(int workerIndex)
+{
+    Tracer::setThreadName("MST Compute Worker " + std::to_string(workerIndex));
+    NumaTopology::getInstance().pinCurrentThread(workerIndex);
+    StageStatistics &statistics = *this->workerStatistics[workerIndex];
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(this->mtx_executor);
+            this->cv_executor.wait(lock, [this] { return this->stop || !this->queue_jobs.empty(); });
+            if (this->stop)
+            {
+                return;
+            }
+            job = std::move(this->queue_jobs.front());
+            this->queue_jobs.pop();
+            this->queueStatistics.recordDequeue(this->queue_jobs.size());
+        }
+
+        statistics.recordWait(job.enqueueTime);
+        auto executionStart = std::chrono::steady_clock::now();
+        Tracer::getInstance().recordAsync("MST compute queue wait", "queue", job.graphID, job.enqueueTime, executionStart);
+        try
+        {
+            CancellationToken::Scope cancellationScope(job.cancellation.get());
+            job.work();
+            statistics.recordExecution(std::chrono::steady_clock::now() - executionStart, true);
+        }
+        catch (const JobCancelled &e)
+        {
+            statistics.recordCancelled();
+            LOG_DEBUG("MST Compute Executor: graph " << job.graphID << " dropped - " << e.what());
+        }
+        catch (const std::exception &e)
+        {
+            statistics.recordExecution(std::chrono::steady_clock::now() - executionStart, false);
+            LOG_ERROR("MST Compute Executor: Error - Execute job: " << e.what());
+        }
+    }
+}
+
+uint64_t ComputeExecutor::getRejectedJobs() const
+{
+    return this->rejectedJobs.load(std::memory_order_relaxed);
+}
+
+std::string ComputeExecutor::getStatistics() const
+{
+    std::string report = this->queueStatistics.report();
+    for (const auto &statistics : this->workerStatistics)
+    {
+        report += statistics->report();
+    }
+    report += "MST Compute Rejected (server busy): " + std::to_string(getRejectedJobs()) + "\n";
+    return report;
+}
@@ -0,0 +1,57 @@
+#ifndef COMPUTEEXECUTOR_HPP
+#define COMPUTEEXECUTOR_HPP
+
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "StageStatistics.hpp"
+#include "CancellationToken.hpp"
+
+/*
+    Bounded executor for MST computations, so they do not run on the client connection threads.
+    At most numThreads jobs run at the same time and at most queueLimit jobs wait. When the queue
+    is full trySubmit() rejects the job immediately (load shedding) instead of blocking the caller.
+    A job may carry a cancellation token: it is the thread's current token while the job runs, so
+    the job's first checkpoint drops it if it expired in the queue, and a JobCancelled escaping the
+    job is counted as cancelled rather than failed.
+*/
+class ComputeExecutor
+{
+private:
+    struct Job
+    {
+        std::function<void()> work;                            // Job body
+        std::chrono::steady_clock::time_point enqueueTime;     // When the job was accepted
+        int graphID;                                           // Graph the job computes (trace key)
+        std::shared_ptr<const CancellationToken> cancellation; // Current token of the thread while the job runs
+    };
+
+    std::queue<Job> queue_jobs;                                // Accepted jobs waiting for a thread
+    std::vector<std::thread> workers;                          // Compute threads (the concurrency cap)
+    std::mutex mtx_executor;                                   // Guards the queue
+    std::condition_variable cv_executor;                       // Wakes workers on new jobs / stop
+    bool stop;                                                 // Stop flag (guarded by mtx_executor)
+    size_t const queueLimit;                                   // Maximum number of waiting jobs
+    std::atomic<uint64_t> rejectedJobs{0};                     // Jobs shed because the queue was full
+    StageStatistics queueStatistics;                           // Statistics of the job queue
+    std::vector<std::unique_ptr<StageStatistics>> workerStatistics; // Statistics of each compute thread
+
+    void work(int workerIndex); // Worker thread body
+
+public:
+    ComputeExecutor(int numThreads, size_t queueLimit);
+    ~ComputeExecutor(); // Waiting jobs are dropped, running jobs finish
+
+    bool trySubmit(int graphID, std::function<void()> job, std::shared_ptr<const CancellationToken> cancellation = nullptr); // False if the job was shed
+    uint64_t getRejectedJobs() const;
+    std::string getStatistics() const;
+};
+
+#endif
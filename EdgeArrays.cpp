@@ -0,0 +1,210 @@
+#include "EdgeArrays.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+
+#define RADIX_BITS 8
+#define RADIX_BUCKETS (1 << RADIX_BITS)
+#define EDGE_SORT_EDGES_PER_THREAD 65536      // Smaller slices do not pay for starting a thread
+#define EDGE_SORT_PARALLEL_MIN_EDGES (1 << 20) // Default (numThreads 0): smaller lists are sorted by the calling thread
+
+namespace
+{
+    template <size_t Bytes>
+    struct UnsignedOf;
+    template <>
+    struct UnsignedOf<1> { using type = uint8_t; };
+    template <>
+    struct UnsignedOf<2> { using type = uint16_t; };
+    template <>
+    struct UnsignedOf<4> { using type = uint32_t; };
+    template <>
+    struct UnsignedOf<8> { using type = uint64_t; };
+
+    // Unsigned radix key with the order of the weights (-0.0 and +0.0 are equal, as for operator<)
+    template <typename Weight>
+    struct RadixKey
+    {
+        using Key = typename UnsignedOf<sizeof(Weight)>::type;
+        static constexpr Key SIGN = Key(1) << (sizeof(Key) * 8 - 1);
+        static constexpr int DIGITS = sizeof(Key) * 8 / RADIX_BITS;
+
+        static Key toKey(Weight weight)
+        {
+            Key bits = std::bit_cast<Key>(weight);
+            if constexpr (std::is_floating_point_v<Weight>)
+            {
+                if (weight == Weight(0))
+                {
+                    return SIGN;
+                }
+                return (bits & SIGN) ? Key(~bits) : Key(bits | SIGN);
+            }
+            else if constexpr (std::is_signed_v<Weight>)
+            {
+                return bits ^ SIGN;
+            }
+            else
+            {
+                return bits;
+            }
+        }
+
+        static int digit(Key key, int pass)
+        {
+            return static_cast<int>((key >> (pass * RADIX_BITS)) & (RADIX_BUCKETS - 1));
+        }
+    };
+
+    // Run sliceTask(t, begin, end) on numThreads contiguous slices of [0, size); slice t precedes slice t + 1
+    template <typename SliceTask>
+    void forEachSlice(int numThreads, size_t size, SliceTask sliceTask)
+    {
+        if (numThreads == 1)
+        {
+            sliceTask(0, size_t(0), size);
+            return;
+        }
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                sliceTask(t, size * t / numThreads, size * (t + 1) / numThreads);
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+    }
+}
+
+template <typename Weight>
+BasicEdgeArrays<Weight>::BasicEdgeArrays(std::pmr::memory_resource *resource)
+    : weights(resource), sources(resource), destinations(resource)
+{
+}
+
+template <typename Weight>
+void BasicEdgeArrays<Weight>::reserve(size_t edges)
+{
+    this->weights.reserve(edges);
+    this->sources.reserve(edges);
+    this->destinations.reserve(edges);
+}
+
+template <typename Weight>
+void BasicEdgeArrays<Weight>::push(Weight weight, int source, int destination)
+{
+    this->weights.push_back(weight);
+    this->sources.push_back(source);
+    this->destinations.push_back(destination);
+}
+
+template <typename Weight>
+size_t BasicEdgeArrays<Weight>::size() const
+{
+    return this->weights.size();
+}
+
+template <typename Weight>
+void BasicEdgeArrays<Weight>::sortByWeight(int numThreads)
+{
+    using Radix = RadixKey<Weight>;
+    using Key = typename Radix::Key;
+    size_t numEdges = size();
+    if (numEdges < 2)
+    {
+        return;
+    }
+    if (numThreads <= 0)
+    {
+        numThreads = numEdges < EDGE_SORT_PARALLEL_MIN_EDGES ? 1 : static_cast<int>(std::thread::hardware_concurrency());
+    }
+    numThreads = static_cast<int>(std::clamp<size_t>(numThreads, 1, std::max<size_t>(1, numEdges / EDGE_SORT_EDGES_PER_THREAD)));
+
+    std::pmr::memory_resource *resource = this->weights.get_allocator().resource();
+    std::pmr::vector<Key> keys(numEdges, resource);
+    std::pmr::vector<Key> keysOut(numEdges, resource);
+    std::pmr::vector<Weight> weightsOut(numEdges, resource);
+    std::pmr::vector<int> sourcesOut(numEdges, resource);
+    std::pmr::vector<int> destinationsOut(numEdges, resource);
+
+    // Keys, and the digit histograms of the whole list: a digit with a single bucket needs no pass
+    using Histograms = std::array<std::array<size_t, RADIX_BUCKETS>, Radix::DIGITS>;
+    std::pmr::vector<Histograms> sliceHistograms(numThreads, Histograms{}, resource);
+    forEachSlice(numThreads, numEdges, [&](int t, size_t begin, size_t end)
+    {
+        Histograms &histograms = sliceHistograms[t];
+        for (size_t i = begin; i < end; ++i)
+        {
+            keys[i] = Radix::toKey(this->weights[i]);
+            for (int pass = 0; pass < Radix::DIGITS; ++pass)
+            {
+                ++histograms[pass][Radix::digit(keys[i], pass)];
+            }
+        }
+    });
+
+    std::pmr::vector<size_t> offsets(static_cast<size_t>(numThreads) * RADIX_BUCKETS, resource); // [thread][bucket]
+    for (int pass = 0; pass < Radix::DIGITS; ++pass)
+    {
+        bool trivial = false;
+        for (int bucket = 0; bucket < RADIX_BUCKETS && !trivial; ++bucket)
+        {
+            size_t count = 0;
+            for (const Histograms &histograms : sliceHistograms)
+            {
+                count += histograms[pass][bucket];
+            }
+            trivial = count == numEdges;
+        }
+        if (trivial)
+        {
+            continue;
+        }
+
+        // Bucket counts of each slice in the current order, then stable offsets: bucket major, slice minor
+        forEachSlice(numThreads, numEdges, [&](int t, size_t begin, size_t end)
+        {
+            size_t *count = &offsets[static_cast<size_t>(t) * RADIX_BUCKETS];
+            std::fill(count, count + RADIX_BUCKETS, 0);
+            for (size_t i = begin; i < end; ++i)
+            {
+                ++count[Radix::digit(keys[i], pass)];
+            }
+        });
+        size_t position = 0;
+        for (int bucket = 0; bucket < RADIX_BUCKETS; ++bucket)
+        {
+            for (int t = 0; t < numThreads; ++t)
+            {
+                size_t count = offsets[static_cast<size_t>(t) * RADIX_BUCKETS + bucket];
+                offsets[static_cast<size_t>(t) * RADIX_BUCKETS + bucket] = position;
+                position += count;
+            }
+        }
+        forEachSlice(numThreads, numEdges, [&](int t, size_t begin, size_t end)
+        {
+            size_t *next = &offsets[static_cast<size_t>(t) * RADIX_BUCKETS];
+            for (size_t i = begin; i < end; ++i)
+            {
+                size_t target = next[Radix::digit(keys[i], pass)]++;
+                keysOut[target] = keys[i];
+                weightsOut[target] = this->weights[i];
+                sourcesOut[target] = this->sources[i];
+                destinationsOut[target] = this->destinations[i];
+            }
+        });
+        keys.swap(keysOut);
+        this->weights.swap(weightsOut);
+        this->sources.swap(sourcesOut);
+        this->destinations.swap(destinationsOut);
+    }
+}
+
+INSTANTIATE_WEIGHT_TYPES(BasicEdgeArrays)
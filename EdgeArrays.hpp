@@ -0,0 +1,37 @@
+#ifndef EDGEARRAYS_HPP
+#define EDGEARRAYS_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+#include "WeightTraits.hpp"
+
+/*
+    Edge list as structure of arrays (weights, sources, destinations), sorted by weight for Kruskal.
+    sortByWeight() is a stable LSD radix sort on the weight bits, 8 bits per pass: the weights are
+    mapped to unsigned keys with the same order (sign bit flipped, negative floats inverted, -0.0
+    keyed as +0.0), and a pass whose digit is equal for every edge is skipped - small bounded
+    weights need one or two passes instead of E log E comparisons. The weights are moved with the
+    edges, so they keep their exact values. Edge lists of over a million edges are sorted by
+    several threads, each counting and scattering its own slice of the arrays.
+    Temporaries come from the resource of the arrays (the thread scratch arena in Kruskal).
+*/
+template <typename Weight>
+class BasicEdgeArrays
+{
+public:
+    std::pmr::vector<Weight> weights;
+    std::pmr::vector<int> sources;
+    std::pmr::vector<int> destinations;
+
+    explicit BasicEdgeArrays(std::pmr::memory_resource *resource = std::pmr::get_default_resource());
+
+    void reserve(size_t edges);
+    void push(Weight weight, int source, int destination);
+    size_t size() const;
+    void sortByWeight(int numThreads = 0); // 0 - single threaded, hardware concurrency for very large lists
+};
+
+using EdgeArrays = BasicEdgeArrays<int>;
+
+#endif
@@ -0,0 +1,155 @@
+// edgesortbench - Kruskal edge sort: std::sort of (weight, src, dest) tuples against the radix sort of EdgeArrays.hpp
+#include "EdgeArrays.hpp"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#define EDGES_PER_SOURCE 64 // Edges of one matrix row in the generated lists
+
+struct Options
+{
+    std::vector<size_t> edgeCounts = {10000, 100000, 1000000, 10000000};
+    int maxWeight = 1000;
+    int threads = 0;          // Threads of the parallel radix sort (0 - hardware concurrency)
+    int repeat = 3;           // Runs per measurement, the fastest is reported
+    unsigned long seed = 1;
+};
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --edges=N[,N...]     Edge list sizes (default 10000,100000,1000000,10000000)\n"
+              << "  --max-weight=N       Weights are drawn from 1..N (default 1000)\n"
+              << "  --threads=N          Threads of the parallel radix sort (default hardware concurrency)\n"
+              << "  --repeat=N           Runs per measurement, the fastest is reported (default 3)\n"
+              << "  --seed=N             Generator seed (default 1)\n";
+}
+
+// Edges in the order Kruskal collects them from the matrix: (src, dest) ascending, random weights
+static EdgeArrays generate(size_t numEdges, const Options &options)
+{
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<int> weight(1, options.maxWeight);
+    EdgeArrays edges;
+    edges.reserve(numEdges);
+    for (size_t e = 0; e < numEdges; ++e)
+    {
+        edges.push(weight(rng), static_cast<int>(e / EDGES_PER_SOURCE), static_cast<int>(e % EDGES_PER_SOURCE));
+    }
+    return edges;
+}
+
+template <typename Sort>
+static double fastestMs(int repeat, Sort sort)
+{
+    double best = 0.0;
+    for (int run = 0; run < repeat; ++run)
+    {
+        auto start = std::chrono::steady_clock::now();
+        sort();
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        best = run == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            size_t separator = arg.find('=');
+            std::string key = arg.substr(0, separator);
+            std::string value = separator == std::string::npos ? "" : arg.substr(separator + 1);
+
+            if (key == "--max-weight") options.maxWeight = std::stoi(value);
+            else if (key == "--threads") options.threads = std::stoi(value);
+            else if (key == "--repeat") options.repeat = std::stoi(value);
+            else if (key == "--seed") options.seed = std::stoul(value);
+            else if (key == "--edges")
+            {
+                options.edgeCounts.clear();
+                for (size_t begin = 0; begin <= value.size();)
+                {
+                    size_t comma = std::min(value.find(',', begin), value.size());
+                    options.edgeCounts.push_back(std::stoull(value.substr(begin, comma - begin)));
+                    begin = comma + 1;
+                }
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return key == "--help" ? 0 : 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (options.maxWeight <= 0 || options.threads < 0 || options.repeat <= 0)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    int threads = options.threads > 0 ? options.threads : static_cast<int>(std::thread::hardware_concurrency());
+    std::cout << "Weights 1.." << options.maxWeight << ", parallel radix sort on " << threads << " threads, fastest of "
+              << options.repeat << " runs\n"
+              << std::setw(12) << "edges" << std::setw(16) << "std::sort ms" << std::setw(14) << "radix ms"
+              << std::setw(18) << "radix x" + std::to_string(threads) + " ms" << std::setw(10) << "speedup" << "\n";
+
+    for (size_t numEdges : options.edgeCounts)
+    {
+        const EdgeArrays input = generate(numEdges, options);
+
+        std::vector<std::tuple<int, int, int>> tuples;
+        double tupleMs = fastestMs(options.repeat, [&]()
+        {
+            tuples.clear();
+            for (size_t e = 0; e < numEdges; ++e)
+            {
+                tuples.emplace_back(input.weights[e], input.sources[e], input.destinations[e]);
+            }
+            std::sort(tuples.begin(), tuples.end());
+        });
+
+        EdgeArrays sorted;
+        auto radix = [&](int numThreads)
+        {
+            return fastestMs(options.repeat, [&]()
+            {
+                sorted = input;
+                sorted.sortByWeight(numThreads);
+            });
+        };
+        double radixMs = radix(1);
+        double parallelMs = radix(threads);
+
+        // The radix sort is stable and the input is in (src, dest) order, so both orders are identical
+        for (size_t e = 0; e < numEdges; ++e)
+        {
+            if (tuples[e] != std::make_tuple(sorted.weights[e], sorted.sources[e], sorted.destinations[e]))
+            {
+                std::cerr << "Sort mismatch at edge " << e << " of " << numEdges << "\n";
+                return 1;
+            }
+        }
+
+        std::cout << std::fixed << std::setprecision(2)
+                  << std::setw(12) << numEdges << std::setw(16) << tupleMs << std::setw(14) << radixMs
+                  << std::setw(18) << parallelMs
+                  << std::setw(9) << tupleMs / std::max(parallelMs, 1e-6) << "x\n";
+    }
+    return 0;
+}
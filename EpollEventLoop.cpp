@@ -0,0 +1,195 @@
+#include "EpollEventLoop.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include "NumaTopology.hpp"
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+
+#define MAX_EPOLL_EVENTS 64
+
+EpollEventLoop::EpollEventLoop(int index) : EventLoop(index)
+{
+    this->epollFD = epoll_create1(EPOLL_CLOEXEC);
+    if (this->epollFD < 0)
+    {
+        throw std::runtime_error("Event loop: epoll failed: " + std::string(strerror(errno)));
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr; // Marks the wake up eventfd
+    epoll_ctl(this->epollFD, EPOLL_CTL_ADD, this->wakeFD, &event);
+    startThread();
+}
+
+EpollEventLoop::~EpollEventLoop()
+{
+    joinThread();
+    destroySessions();
+    close(this->epollFD);
+}
+
+void EpollEventLoop::run()
+{
+    Tracer::setThreadName("Event Loop " + std::to_string(this->index));
+    NumaTopology::getInstance().pinCurrentThread(this->index);
+    epoll_event events[MAX_EPOLL_EVENTS];
+    while (this->running)
+    {
+        int numReady = epoll_wait(this->epollFD, events, MAX_EPOLL_EVENTS, -1);
+        this->numWaits.fetch_add(1, std::memory_order_relaxed);
+        if (numReady < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            LOG_ERROR("Event loop " << this->index << ": epoll_wait failed: " << strerror(errno));
+            break;
+        }
+        this->numEvents.fetch_add(numReady, std::memory_order_relaxed);
+        for (int i = 0; i < numReady && this->running; ++i)
+        {
+            if (events[i].data.ptr == nullptr)
+            {
+                uint64_t count;
+                ::read(this->wakeFD, &count, sizeof(count));
+                runPosted();
+            }
+            else
+            {
+                static_cast<IOAwaitable *>(events[i].data.ptr)->handle.resume();
+            }
+        }
+    }
+}
+
+void EpollEventLoop::prepareSocket(int fd)
+{
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+}
+
+void EpollEventLoop::arm(int fd, uint32_t events, IOAwaitable *waiter)
+{
+    epoll_event event{};
+    event.events = events | EPOLLONESHOT | EPOLLRDHUP;
+    event.data.ptr = waiter;
+    bool registered = this->registeredFDs.count(fd) > 0;
+    if (epoll_ctl(this->epollFD, registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        // Resume anyway - the retried syscall reports the error to the session
+        LOG_ERROR("Event loop " << this->index << ": epoll_ctl failed for socket " << fd << ": " << strerror(errno));
+        std::coroutine_handle<> handle = waiter->handle;
+        post([handle]() { handle.resume(); });
+        return;
+    }
+    this->registeredFDs.insert(fd);
+}
+
+void EpollEventLoop::IOAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+    this->handle = awaiting;
+    this->loop.arm(this->fd, this->events, this);
+}
+
+Task<ssize_t> EpollEventLoop::read(int fd, char *buffer, size_t size)
+{
+    while (true)
+    {
+        ssize_t bytes = ::read(fd, buffer, size);
+        if (bytes >= 0)
+        {
+            co_return bytes;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            co_return -1;
+        }
+        co_await IOAwaitable{*this, fd, EPOLLIN, nullptr};
+    }
+}
+
+Task<bool> EpollEventLoop::sendAll(int fd, std::string message)
+{
+    size_t offset = 0;
+    while (offset < message.size())
+    {
+        ssize_t bytes = ::send(fd, message.data() + offset, message.size() - offset, MSG_NOSIGNAL);
+        if (bytes > 0)
+        {
+            offset += bytes;
+        }
+        else if (bytes < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        else if (bytes < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            co_await IOAwaitable{*this, fd, EPOLLOUT, nullptr};
+        }
+        else
+        {
+            co_return false;
+        }
+    }
+    co_return true;
+}
+
+Task<ssize_t> EpollEventLoop::receiveMsg(int fd, msghdr *message)
+{
+    while (true)
+    {
+        ssize_t bytes = ::recvmsg(fd, message, MSG_CMSG_CLOEXEC);
+        if (bytes >= 0)
+        {
+            co_return bytes;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            co_return -1;
+        }
+        co_await IOAwaitable{*this, fd, EPOLLIN, nullptr};
+    }
+}
+
+Task<ssize_t> EpollEventLoop::sendMsg(int fd, const msghdr *message)
+{
+    while (true)
+    {
+        ssize_t bytes = ::sendmsg(fd, message, MSG_NOSIGNAL);
+        if (bytes >= 0)
+        {
+            co_return bytes;
+        }
+        if (errno == EINTR)
+        {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK)
+        {
+            co_return -1;
+        }
+        co_await IOAwaitable{*this, fd, EPOLLOUT, nullptr};
+    }
+}
+
+void EpollEventLoop::closeFD(int fd)
+{
+    if (this->registeredFDs.erase(fd) > 0)
+    {
+        epoll_ctl(this->epollFD, EPOLL_CTL_DEL, fd, nullptr);
+    }
+    EventLoop::closeFD(fd);
+}
@@ -0,0 +1,49 @@
+#ifndef EPOLLEVENTLOOP_HPP
+#define EPOLLEVENTLOOP_HPP
+
+#include <unordered_set>
+#include "EventLoop.hpp"
+
+/*
+    Readiness based event loop: sessions use non-blocking sockets and suspend on EAGAIN until
+    epoll reports the socket ready again (one-shot interest, re-armed by the next wait).
+*/
+class EpollEventLoop : public EventLoop
+{
+public:
+    // Suspends the calling coroutine until the socket is ready for the events
+    struct IOAwaitable
+    {
+        EpollEventLoop &loop;
+        int fd;
+        uint32_t events;
+        std::coroutine_handle<> handle;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> awaiting);
+        void await_resume() const noexcept {}
+    };
+
+private:
+    int epollFD;                                                      // epoll instance of the loop
+    std::unordered_set<int> registeredFDs;                            // Sockets added to epoll
+
+    void arm(int fd, uint32_t events, IOAwaitable *waiter);           // One-shot interest in the socket
+
+protected:
+    void run() override;
+    void prepareSocket(int fd) override;                              // Non-blocking - sessions never block their loop
+
+public:
+    EpollEventLoop(int index);
+    ~EpollEventLoop() override;
+
+    Backend getBackend() const override { return Epoll; }
+    Task<ssize_t> read(int fd, char *buffer, size_t size) override;
+    Task<bool> sendAll(int fd, std::string message) override;
+    Task<ssize_t> receiveMsg(int fd, msghdr *message) override;
+    Task<ssize_t> sendMsg(int fd, const msghdr *message) override;
+    void closeFD(int fd) override;                                    // Remove the socket from epoll and close it
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "EventLoop.hpp"
+#include "EpollEventLoop.hpp"
+#include "UringEventLoop.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include <memory>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+// Detached coroutine owning a session - its frame is freed when the session ends
+struct EventLoop::SessionCoroutine
+{
+    struct promise_type
+    {
+        SessionCoroutine get_return_object() { return SessionCoroutine{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); } // runSession catches everything
+    };
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+EventLoop::EventLoop(int index) : index(index), running(true), nextSessionID(0), numSessions(0), numWaits(0), numEvents(0)
+{
+    this->wakeFD = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->wakeFD < 0)
+    {
+        throw std::runtime_error("Event loop: eventfd failed: " + std::string(strerror(errno)));
+    }
+}
+
+EventLoop::~EventLoop()
+{
+    joinThread();
+    destroySessions();
+    for (int fd : this->ownedFDs)
+    {
+        close(fd);
+    }
+    close(this->wakeFD);
+}
+
+std::unique_ptr<EventLoop> EventLoop::create(Backend backend, int index)
+{
+    if (backend == IoUring)
+    {
+        try
+        {
+            return std::make_unique<UringEventLoop>(index);
+        }
+        catch (const std::runtime_error &e)
+        {
+            LOG_WARN("Event loop " << index << ": io_uring not available, falling back to epoll (" << e.what() << ")");
+        }
+    }
+    return std::make_unique<EpollEventLoop>(index);
+}
+
+EventLoop::Backend EventLoop::parseBackend(const std::string &name)
+{
+    if (name == "epoll") return Epoll;
+    if (name == "uring" || name == "io_uring") return IoUring;
+    throw std::invalid_argument("Unknown I/O backend " + name + " (expected epoll or uring)");
+}
+
+std::string EventLoop::backendName(Backend backend)
+{
+    return backend == IoUring ? "io_uring" : "epoll";
+}
+
+void EventLoop::startThread()
+{
+    this->thread = std::thread(&EventLoop::run, this);
+}
+
+void EventLoop::joinThread()
+{
+    stop();
+    if (this->thread.joinable())
+    {
+        this->thread.join();
+    }
+}
+
+void EventLoop::destroySessions()
+{
+    // The loop thread is gone - suspended sessions are destroyed here with their whole await chain
+    this->posted.clear();
+    for (auto &session : this->sessions)
+    {
+        session.second.destroy();
+    }
+    this->sessions.clear();
+}
+
+void EventLoop::post(std::function<void()> function)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        this->posted.push_back(std::move(function));
+    }
+    uint64_t one = 1;
+    write(this->wakeFD, &one, sizeof(one));
+}
+
+void EventLoop::spawn(int fd, Task<void> session)
+{
+    prepareSocket(fd);
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        this->ownedFDs.insert(fd);
+    }
+    auto pending = std::make_shared<Task<void>>(std::move(session)); // std::function needs a copyable callable
+    post([this, fd, pending]() { startSession(fd, std::move(*pending)); });
+}
+
+void EventLoop::stop()
+{
+    this->running = false;
+    uint64_t one = 1;
+    write(this->wakeFD, &one, sizeof(one));
+}
+
+void EventLoop::prepareSocket(int)
+{
+}
+
+bool EventLoop::startAccept(int, std::function<void(int)>)
+{
+    return false;
+}
+
+void EventLoop::startSession(int fd, Task<void> session)
+{
+    uint64_t sessionID = this->nextSessionID++;
+    SessionCoroutine coroutine = runSession(sessionID, fd, std::move(session));
+    this->sessions.emplace(sessionID, coroutine.handle);
+    this->numSessions++;
+    coroutine.handle.resume();
+}
+
+EventLoop::SessionCoroutine EventLoop::runSession(uint64_t sessionID, int fd, Task<void> session)
+{
+    try
+    {
+        co_await session;
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Event loop " << this->index << ": Session ended with error: " << e.what());
+    }
+    catch (...)
+    {
+        LOG_ERROR("Event loop " << this->index << ": Session ended with unknown error");
+    }
+    bool stillOwned;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        stillOwned = this->ownedFDs.count(fd) > 0;
+    }
+    if (stillOwned)
+    {
+        closeFD(fd);
+    }
+    this->sessions.erase(sessionID);
+    this->numSessions--;
+}
+
+void EventLoop::runPosted()
+{
+    std::vector<std::function<void()>> functions;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        functions.swap(this->posted);
+    }
+    for (auto &function : functions)
+    {
+        if (!this->running)
+        {
+            return;
+        }
+        function();
+    }
+}
+
+bool EventLoop::OffloadAwaitable::await_suspend(std::coroutine_handle<> awaiting)
+{
+    EventLoop *eventLoop = &this->loop;
+    std::function<void()> work = std::move(this->job);
+    this->accepted = this->executor.trySubmit(this->graphID, [eventLoop, awaiting, work]()
+    {
+        try
+        {
+            work();
+        }
+        catch (...)
+        {
+            eventLoop->post([awaiting]() { awaiting.resume(); });
+            throw;
+        }
+        eventLoop->post([awaiting]() { awaiting.resume(); });
+    });
+    return this->accepted; // Not accepted - continue without suspending
+}
+
+EventLoop::OffloadAwaitable EventLoop::offload(ComputeExecutor &executor, int graphID, std::function<void()> job)
+{
+    return OffloadAwaitable{*this, executor, graphID, std::move(job)};
+}
+
+void EventLoop::closeFD(int fd)
+{
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        this->ownedFDs.erase(fd);
+    }
+    close(fd);
+}
+
+size_t EventLoop::getNumSessions() const
+{
+    return this->numSessions.load(std::memory_order_relaxed);
+}
+
+std::string EventLoop::getStatistics() const
+{
+    uint64_t waits = this->numWaits.load(std::memory_order_relaxed);
+    uint64_t events = this->numEvents.load(std::memory_order_relaxed);
+    char perWait[32];
+    snprintf(perWait, sizeof(perWait), "%.2f", waits > 0 ? static_cast<double>(events) / waits : 0.0);
+    return "Event Loop " + std::to_string(this->index) + " (" + backendName(getBackend()) + "): " +
+           std::to_string(getNumSessions()) + " sessions, " + std::to_string(waits) + " waits, " +
+           std::to_string(events) + " events (" + perWait + " per wait)\n";
+}
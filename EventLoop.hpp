@@ -0,0 +1,104 @@
+#ifndef EVENTLOOP_HPP
+#define EVENTLOOP_HPP
+
+#include <coroutine>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <string>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include "Task.hpp"
+#include "ComputeExecutor.hpp"
+
+/*
+    Single-threaded event loop running client sessions as coroutines.
+    A session is a Task<void> pinned to one loop. It reads and sends through the loop and only
+    suspends while its socket is not ready, so an idle client costs its coroutine frames instead
+    of a thread. The I/O backend (epoll readiness or io_uring completions) is a subclass.
+    Everything except post() and spawn() must be called on the loop thread.
+*/
+class EventLoop
+{
+public:
+    enum Backend
+    {
+        Epoll,
+        IoUring
+    };
+
+    // Runs a job on the compute executor and resumes the coroutine on this loop when it finishes
+    // Resumes with false, without suspending, if the executor shed the job
+    struct OffloadAwaitable
+    {
+        EventLoop &loop;
+        ComputeExecutor &executor;
+        int graphID;
+        std::function<void()> job;
+        bool accepted = false;
+
+        bool await_ready() const noexcept { return false; }
+        bool await_suspend(std::coroutine_handle<> awaiting);
+        bool await_resume() const noexcept { return this->accepted; }
+    };
+
+protected:
+    int index;                                                        // Loop number (thread name)
+    int wakeFD;                                                       // eventfd waking the loop for posted functions
+    std::thread thread;                                               // Loop thread
+    std::atomic<bool> running;                                        // Cleared by stop()
+    std::mutex mtx_posted;                                            // Guards posted and ownedFDs
+    std::vector<std::function<void()>> posted;                        // Functions to run on the loop thread
+    std::unordered_map<uint64_t, std::coroutine_handle<>> sessions;   // Live sessions (destroyed on shutdown)
+    uint64_t nextSessionID;                                           // Key of the next session
+    std::unordered_set<int> ownedFDs;                                 // Sockets of the sessions
+    std::atomic<size_t> numSessions;                                  // Live sessions (statistics)
+    std::atomic<uint64_t> numWaits;                                   // Blocking waits for events (epoll_wait / io_uring_enter)
+    std::atomic<uint64_t> numEvents;                                  // Events / completions handled
+
+    struct SessionCoroutine;                                          // Top-level frame of a session
+
+    SessionCoroutine runSession(uint64_t sessionID, int fd, Task<void> session);
+    void startSession(int fd, Task<void> session);                    // Loop thread side of spawn()
+    void runPosted();                                                 // Run the posted functions
+    void startThread();                                               // Start the loop thread (end of the subclass constructor)
+    void destroySessions();                                           // Destroy the suspended sessions (loop thread joined)
+
+    virtual void run() = 0;                                           // Loop thread body
+    virtual void prepareSocket(int fd);                               // Adjust a new session socket for the backend
+
+public:
+    EventLoop(int index);
+    virtual ~EventLoop();                                             // Destroys the sessions and closes their sockets
+
+    // Loop with the requested backend - falls back to epoll if io_uring is not available
+    static std::unique_ptr<EventLoop> create(Backend backend, int index);
+    static Backend parseBackend(const std::string &name);             // Throws std::invalid_argument
+    static std::string backendName(Backend backend);
+
+    void post(std::function<void()> function);                        // Run a function on the loop thread (any thread)
+    void spawn(int fd, Task<void> session);                           // Start a session owning the socket (any thread)
+    void stop();
+    void joinThread();                                                // Stop and join the loop thread - its sessions stay suspended until destruction
+
+    virtual Backend getBackend() const = 0;
+    virtual Task<ssize_t> read(int fd, char *buffer, size_t size) = 0; // Read what is available (0 - closed, -1 - error)
+    virtual Task<bool> sendAll(int fd, std::string message) = 0;      // Send the whole message (false - error)
+    virtual Task<ssize_t> receiveMsg(int fd, msghdr *message) = 0;    // recvmsg (passed descriptors are close-on-exec), -1 - error
+    virtual Task<ssize_t> sendMsg(int fd, const msghdr *message) = 0; // sendmsg - may send part of the data, -1 - error
+    virtual void closeFD(int fd);                                     // Close a session socket
+    // Accept connections on the loop and hand them to onAccept (loop thread) - false if the backend does not accept
+    virtual bool startAccept(int listenFD, std::function<void(int)> onAccept);
+
+    OffloadAwaitable offload(ComputeExecutor &executor, int graphID, std::function<void()> job);
+    size_t getNumSessions() const;
+    std::string getStatistics() const;                                // One line summary
+};
+
+#endif
@@ -0,0 +1,407 @@
+#include "ExternalKruskal.hpp"
+#include "CancellationToken.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#define DEFAULT_EXTERNAL_SORT_BYTES (64u << 20)
+#define DEFAULT_EXTERNAL_SORT_DIRECTORY "/tmp"
+#define MIN_RUN_EDGES 1024
+#define MIN_BLOCK_EDGES 256
+#define MERGE_BLOCK_BYTES (1u << 20) // Buffer of a run while merging
+#define CHECKPOINT_EDGES 65536       // Edges merged between cancellation checks
+#define BYTES_PER_MB (1024.0 * 1024.0)
+
+static std::atomic<uint64_t> nextRunFile{0};
+
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Run files of a computation - removed on every exit path (cancellation and I/O errors too)
+class RunFiles
+{
+private:
+    std::vector<std::string> paths;
+
+public:
+    RunFiles() = default;
+    RunFiles(const RunFiles &) = delete;
+    RunFiles &operator=(const RunFiles &) = delete;
+    ~RunFiles()
+    {
+        for (const std::string &path : this->paths)
+        {
+            std::remove(path.c_str());
+        }
+    }
+    void add(const std::string &path) { this->paths.push_back(path); }
+    void remove(const std::string &path)
+    {
+        std::remove(path.c_str());
+        this->paths.erase(std::find(this->paths.begin(), this->paths.end(), path));
+    }
+};
+
+// Read up to count whole records - 0 at the end of the file
+template <typename Record>
+static size_t readRecords(std::ifstream &file, Record *records, size_t count, const std::string &path)
+{
+    file.read(reinterpret_cast<char *>(records), count * sizeof(Record));
+    size_t bytes = static_cast<size_t>(file.gcount());
+    if (file.bad() || bytes % sizeof(Record) != 0)
+    {
+        throw std::runtime_error("External Kruskal: cannot read " + path + " (I/O error or truncated edge record)");
+    }
+    return bytes / sizeof(Record);
+}
+
+std::string ExternalKruskalStatistics::summary() const
+{
+    std::ostringstream text;
+    text << this->edges << " edges, " << this->vertices << " vertices | " << this->runs << " runs, " << this->mergePasses << " merge passes | read "
+         << this->bytesRead / BYTES_PER_MB << " MB, written " << this->bytesWritten / BYTES_PER_MB << " MB | run generation " << this->runGenerationMs
+         << " ms, merge " << this->mergeMs << " ms, Kruskal " << this->kruskalMs << " ms";
+    return text.str();
+}
+
+/*  Settings and totals */
+
+ExternalSortContext::ExternalSortContext() : memoryBytes(DEFAULT_EXTERNAL_SORT_BYTES), tempDirectory(DEFAULT_EXTERNAL_SORT_DIRECTORY) {}
+
+ExternalSortContext &ExternalSortContext::getInstance()
+{
+    static ExternalSortContext instance;
+    return instance;
+}
+
+void ExternalSortContext::configure(size_t memoryBytes, const std::string &tempDirectory)
+{
+    this->memoryBytes = memoryBytes;
+    this->tempDirectory = tempDirectory;
+}
+
+size_t ExternalSortContext::getMemoryBytes() const
+{
+    return this->memoryBytes;
+}
+
+const std::string &ExternalSortContext::getTempDirectory() const
+{
+    return this->tempDirectory;
+}
+
+void ExternalSortContext::record(const ExternalKruskalStatistics &statistics)
+{
+    std::lock_guard<std::mutex> lock(this->mtx);
+    ++this->computations;
+    this->totals.edges += statistics.edges;
+    this->totals.vertices += statistics.vertices;
+    this->totals.runs += statistics.runs;
+    this->totals.mergePasses += statistics.mergePasses;
+    this->totals.bytesRead += statistics.bytesRead;
+    this->totals.bytesWritten += statistics.bytesWritten;
+    this->totals.runGenerationMs += statistics.runGenerationMs;
+    this->totals.mergeMs += statistics.mergeMs;
+    this->totals.kruskalMs += statistics.kruskalMs;
+}
+
+std::string ExternalSortContext::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(this->mtx);
+    return "External Kruskal: " + std::to_string(this->computations) + " computations (sort memory " +
+           std::to_string(this->memoryBytes / (1u << 20)) + " MB, " + this->tempDirectory + ") | " + this->totals.summary() + "\n";
+}
+
+/*  Run files */
+
+template <typename Weight>
+class BasicExternalKruskal<Weight>::RunReader
+{
+private:
+    std::ifstream file;
+    std::string path;
+    std::vector<Edge> buffer;
+    size_t position = 0;
+    size_t count = 0;
+    uint64_t &bytesRead;
+
+public:
+    RunReader(const std::string &path, size_t blockEdges, uint64_t &bytesRead)
+        : file(path, std::ios::binary), path(path), buffer(blockEdges), bytesRead(bytesRead)
+    {
+        if (!this->file)
+        {
+            throw std::runtime_error("External Kruskal: cannot open run " + path);
+        }
+    }
+
+    bool next(Edge &edge)
+    {
+        if (this->position == this->count)
+        {
+            this->count = readRecords(this->file, this->buffer.data(), this->buffer.size(), this->path);
+            this->position = 0;
+            this->bytesRead += this->count * sizeof(Edge);
+            if (this->count == 0)
+            {
+                return false;
+            }
+        }
+        edge = this->buffer[this->position++];
+        return true;
+    }
+};
+
+template <typename Weight>
+class BasicExternalKruskal<Weight>::RunWriter
+{
+private:
+    std::ofstream file;
+    std::string path;
+    std::vector<Edge> buffer;
+    uint64_t &bytesWritten;
+
+public:
+    RunWriter(const std::string &path, size_t blockEdges, uint64_t &bytesWritten)
+        : file(path, std::ios::binary | std::ios::trunc), path(path), bytesWritten(bytesWritten)
+    {
+        if (!this->file)
+        {
+            throw std::runtime_error("External Kruskal: cannot create run " + path);
+        }
+        this->buffer.reserve(blockEdges);
+    }
+
+    void write(const Edge *edges, size_t count)
+    {
+        this->file.write(reinterpret_cast<const char *>(edges), count * sizeof(Edge));
+        this->bytesWritten += count * sizeof(Edge);
+    }
+
+    void push(const Edge &edge)
+    {
+        this->buffer.push_back(edge);
+        if (this->buffer.size() == this->buffer.capacity())
+        {
+            write(this->buffer.data(), this->buffer.size());
+            this->buffer.clear();
+        }
+    }
+
+    void close()
+    {
+        write(this->buffer.data(), this->buffer.size());
+        this->buffer.clear();
+        if (!this->file.flush())
+        {
+            throw std::runtime_error("External Kruskal: cannot write run " + this->path);
+        }
+    }
+};
+
+/*  Computation */
+
+template <typename Weight>
+BasicExternalKruskal<Weight>::BasicExternalKruskal(size_t memoryBytes, std::string tempDirectory)
+    : memoryBytes(memoryBytes), tempDirectory(std::move(tempDirectory))
+{
+    this->runEdges = std::max<size_t>(MIN_RUN_EDGES, memoryBytes / sizeof(Edge));
+    this->blockEdges = std::max<size_t>(MIN_BLOCK_EDGES, std::min<size_t>(MERGE_BLOCK_BYTES, memoryBytes / 4) / sizeof(Edge));
+    size_t blocks = memoryBytes / (this->blockEdges * sizeof(Edge));
+    this->fanIn = blocks > 3 ? blocks - 1 : 2; // One block is the output buffer
+}
+
+template <typename Weight>
+std::string BasicExternalKruskal<Weight>::newRunPath()
+{
+    return this->tempDirectory + "/mst-run-" + std::to_string(getpid()) + "-" + std::to_string(nextRunFile++) + ".bin";
+}
+
+// K-way merge of sorted runs through a heap of the run heads
+template <typename Weight>
+template <typename Sink>
+void BasicExternalKruskal<Weight>::merge(const std::vector<std::string> &runs, ExternalKruskalStatistics &statistics, Sink &&sink)
+{
+    std::vector<std::unique_ptr<RunReader>> readers;
+    std::vector<Edge> heads(runs.size());
+    using Head = std::pair<Weight, size_t>; // (weight, run)
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heap;
+    for (size_t run = 0; run < runs.size(); ++run)
+    {
+        readers.push_back(std::make_unique<RunReader>(runs[run], this->blockEdges, statistics.bytesRead));
+        if (readers[run]->next(heads[run]))
+        {
+            heap.emplace(heads[run].weight, run);
+        }
+    }
+    uint64_t merged = 0;
+    while (!heap.empty())
+    {
+        if (++merged % CHECKPOINT_EDGES == 0)
+        {
+            CancellationToken::checkpoint();
+        }
+        size_t run = heap.top().second;
+        heap.pop();
+        if (!sink(heads[run]))
+        {
+            return;
+        }
+        if (readers[run]->next(heads[run]))
+        {
+            heap.emplace(heads[run].weight, run);
+        }
+    }
+}
+
+template <typename Weight>
+typename BasicExternalKruskal<Weight>::Result BasicExternalKruskal<Weight>::computeMST(const std::string &edgeFile)
+{
+    Result result;
+    ExternalKruskalStatistics &statistics = result.statistics;
+    RunFiles runFiles;
+    auto byWeight = [](const Edge &a, const Edge &b) { return a.weight < b.weight; };
+
+    // Run generation - sort memory sized chunks of the input
+    auto start = std::chrono::steady_clock::now();
+    std::ifstream input(edgeFile, std::ios::binary | std::ios::ate);
+    if (!input)
+    {
+        throw std::runtime_error("External Kruskal: cannot open edge file " + edgeFile);
+    }
+    uint64_t inputBytes = static_cast<uint64_t>(input.tellg());
+    if (inputBytes % sizeof(Edge) != 0)
+    {
+        throw std::runtime_error("External Kruskal: " + edgeFile + " is not a whole number of edge records");
+    }
+    uint64_t inputEdges = inputBytes / sizeof(Edge);
+    input.seekg(0);
+    std::vector<Edge> run(std::min<uint64_t>(this->runEdges, inputEdges));
+    std::vector<std::string> runs;
+    bool inMemory = false; // The whole input is one run - Kruskal reads it from the buffer
+    uint32_t maxVertex = 0;
+    while (size_t count = readRecords(input, run.data(), run.size(), edgeFile))
+    {
+        CancellationToken::checkpoint();
+        statistics.bytesRead += count * sizeof(Edge);
+        statistics.edges += count;
+        for (size_t i = 0; i < count; ++i)
+        {
+            maxVertex = std::max({maxVertex, run[i].u, run[i].v});
+        }
+        std::sort(run.begin(), run.begin() + count, byWeight);
+        if (runs.empty() && statistics.edges == inputEdges)
+        {
+            run.resize(count);
+            inMemory = true;
+            break;
+        }
+        runs.push_back(newRunPath());
+        runFiles.add(runs.back());
+        RunWriter writer(runs.back(), 0, statistics.bytesWritten);
+        writer.write(run.data(), count);
+        writer.close();
+    }
+    if (!inMemory)
+    {
+        std::vector<Edge>().swap(run); // The merge buffers take the memory
+    }
+    statistics.vertices = statistics.edges > 0 ? static_cast<int64_t>(maxVertex) + 1 : 0;
+    statistics.runs = static_cast<int>(runs.size());
+    statistics.runGenerationMs = millisecondsSince(start);
+
+    // Intermediate merge passes until the final merge can read every run at once
+    start = std::chrono::steady_clock::now();
+    while (runs.size() > this->fanIn)
+    {
+        std::vector<std::string> mergedRuns;
+        for (size_t first = 0; first < runs.size(); first += this->fanIn)
+        {
+            std::vector<std::string> group(runs.begin() + first, runs.begin() + std::min(runs.size(), first + this->fanIn));
+            if (group.size() == 1)
+            {
+                mergedRuns.push_back(group.front());
+                continue;
+            }
+            mergedRuns.push_back(newRunPath());
+            runFiles.add(mergedRuns.back());
+            RunWriter writer(mergedRuns.back(), this->blockEdges, statistics.bytesWritten);
+            merge(group, statistics, [&writer](const Edge &edge) { writer.push(edge); return true; });
+            writer.close();
+            for (const std::string &path : group)
+            {
+                runFiles.remove(path);
+            }
+        }
+        runs = std::move(mergedRuns);
+        ++statistics.mergePasses;
+    }
+    statistics.mergeMs = millisecondsSince(start);
+
+    // Kruskal over the edges in weight order - union-find by rank with path halving
+    start = std::chrono::steady_clock::now();
+    std::vector<uint32_t> parent(statistics.vertices);
+    std::iota(parent.begin(), parent.end(), 0u);
+    std::vector<uint8_t> rank(statistics.vertices, 0);
+    auto find = [&parent](uint32_t vertex)
+    {
+        while (parent[vertex] != vertex)
+        {
+            parent[vertex] = parent[parent[vertex]];
+            vertex = parent[vertex];
+        }
+        return vertex;
+    };
+    uint64_t spanningEdges = statistics.vertices > 0 ? statistics.vertices - 1 : 0;
+    auto take = [&](const Edge &edge)
+    {
+        uint32_t rootU = find(edge.u);
+        uint32_t rootV = find(edge.v);
+        if (rootU != rootV)
+        {
+            if (rank[rootU] < rank[rootV])
+            {
+                std::swap(rootU, rootV);
+            }
+            parent[rootV] = rootU;
+            rank[rootU] += rank[rootU] == rank[rootV];
+            result.mstEdges.push_back(edge);
+            result.totalWeight += edge.weight;
+        }
+        return result.mstEdges.size() < spanningEdges; // A spanning tree - the rest of the edges are not read
+    };
+    if (inMemory)
+    {
+        for (size_t i = 0; i < run.size(); ++i)
+        {
+            if ((i + 1) % CHECKPOINT_EDGES == 0)
+            {
+                CancellationToken::checkpoint();
+            }
+            if (!take(run[i]))
+            {
+                break;
+            }
+        }
+    }
+    else
+    {
+        merge(runs, statistics, take);
+    }
+    statistics.kruskalMs = millisecondsSince(start);
+    LOG_DEBUG("External Kruskal: " << edgeFile << " - " << statistics.summary());
+    return result;
+}
+
+INSTANTIATE_WEIGHT_TYPES(BasicExternalKruskal)
@@ -0,0 +1,104 @@
+#ifndef EXTERNALKRUSKAL_HPP
+#define EXTERNALKRUSKAL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "WeightTraits.hpp"
+
+// I/O volume and phase timings of one external-memory MST computation
+struct ExternalKruskalStatistics
+{
+    uint64_t edges = 0;          // Edges of the input file
+    int64_t vertices = 0;        // Highest vertex id + 1
+    int runs = 0;                // Sorted runs written by run generation (0 - the input fit in memory)
+    int mergePasses = 0;         // Intermediate merge passes (the final merge feeds Kruskal directly)
+    uint64_t bytesRead = 0;
+    uint64_t bytesWritten = 0;
+    double runGenerationMs = 0.0;
+    double mergeMs = 0.0;        // Intermediate merge passes
+    double kruskalMs = 0.0;      // Final merge and union-find
+
+    std::string summary() const;
+};
+
+/*
+    Settings of the external-memory MST computations of the process, and the totals of their
+    statistics for the server report. Set once at startup, before any computation.
+*/
+class ExternalSortContext
+{
+private:
+    size_t memoryBytes;
+    std::string tempDirectory;
+    std::mutex mtx;                      // Guards the totals
+    uint64_t computations = 0;
+    ExternalKruskalStatistics totals;
+
+    ExternalSortContext();
+
+public:
+    static ExternalSortContext &getInstance();
+
+    void configure(size_t memoryBytes, const std::string &tempDirectory);
+    size_t getMemoryBytes() const;
+    const std::string &getTempDirectory() const;
+    void record(const ExternalKruskalStatistics &statistics);
+    std::string getStatistics();
+};
+
+/*
+    Kruskal over an edge list file larger than memory.
+    The file is a sequence of Edge records in native layout. Run generation reads memoryBytes of
+    edges at a time, sorts them by weight and writes each as a run file; merge passes combine up
+    to fanIn runs at a time into longer runs until at most fanIn are left; the final merge streams
+    the edges in weight order into a union-find over the vertices. Besides the sort memory, what
+    stays in memory grows with the vertices only: the union-find (5 bytes per vertex) and the
+    MST edges of the result (up to V - 1 Edge records, 12 bytes each for int weights).
+    An input that fits in one run is never written.
+    Run files live in the temporary directory and are removed when the computation ends.
+*/
+template <typename Weight>
+class BasicExternalKruskal
+{
+public:
+    using Sum = typename WeightTraits<Weight>::Sum;
+
+    struct Edge
+    {
+        uint32_t u;
+        uint32_t v;
+        Weight weight;
+    };
+
+    struct Result
+    {
+        std::vector<Edge> mstEdges;   // Minimum spanning forest, in weight order
+        Sum totalWeight = 0;
+        ExternalKruskalStatistics statistics;
+    };
+
+    BasicExternalKruskal(size_t memoryBytes, std::string tempDirectory);
+
+    Result computeMST(const std::string &edgeFile); // Throws std::runtime_error on I/O errors, JobCancelled when cancelled
+
+private:
+    class RunReader;
+    class RunWriter;
+
+    size_t memoryBytes;
+    std::string tempDirectory;
+    size_t runEdges;      // Edges sorted in memory per run
+    size_t blockEdges;    // Edges buffered per run while merging
+    size_t fanIn;         // Runs merged at once
+
+    std::string newRunPath();
+    template <typename Sink>
+    void merge(const std::vector<std::string> &runs, ExternalKruskalStatistics &statistics, Sink &&sink); // Sink returns false to stop
+};
+
+using ExternalKruskal = BasicExternalKruskal<int>;
+
+#endif
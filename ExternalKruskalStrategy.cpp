@@ -0,0 +1,77 @@
+#include "ExternalKruskalStrategy.hpp"
+#include "CancellationToken.hpp"
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <unistd.h>
+
+#define EDGE_FILE_BLOCK_EDGES 65536 // Edges buffered while writing the edge file
+
+static std::atomic<uint64_t> nextEdgeFile{0};
+
+template <typename Weight, typename NoEdge>
+std::unique_ptr<BasicAdjacencyMatrix<Weight>> BasicExternalKruskalStrategy<Weight, NoEdge>::computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource)
+{
+    LOG_DEBUG("Strategy Activated - Start Compute MST using External Kruskal");
+    using Engine = BasicExternalKruskal<Weight>;
+    ExternalSortContext &context = ExternalSortContext::getInstance();
+    int numVertices = graphAdjacencyMatrix.size();
+
+    // Stream the upper triangle to the edge file
+    std::string path = context.getTempDirectory() + "/mst-edges-" + std::to_string(getpid()) + "-" + std::to_string(nextEdgeFile++) + ".bin";
+    struct RemoveFile
+    {
+        const std::string &path;
+        ~RemoveFile() { std::remove(path.c_str()); }
+    } removeEdgeFile{path};
+    uint64_t bytesWritten = 0;
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        std::vector<typename Engine::Edge> block;
+        block.reserve(EDGE_FILE_BLOCK_EDGES);
+        auto flush = [&file, &block, &bytesWritten]()
+        {
+            file.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(typename Engine::Edge));
+            bytesWritten += block.size() * sizeof(typename Engine::Edge);
+            block.clear();
+        };
+        for (int i = 0; i < numVertices; i++)
+        {
+            CancellationToken::checkpoint();
+            for (int j = i + 1; j < numVertices; j++)
+            {
+                if (NoEdge::isEdge(graphAdjacencyMatrix[i][j]))
+                {
+                    block.push_back({static_cast<uint32_t>(i), static_cast<uint32_t>(j), graphAdjacencyMatrix[i][j]});
+                    if (block.size() == block.capacity())
+                    {
+                        flush();
+                    }
+                }
+            }
+        }
+        flush();
+        if (!file.flush())
+        {
+            throw std::runtime_error("External Kruskal: cannot write edge file " + path);
+        }
+    }
+
+    typename Engine::Result result = Engine(context.getMemoryBytes(), context.getTempDirectory()).computeMST(path);
+    result.statistics.bytesWritten += bytesWritten;
+    context.record(result.statistics);
+    LOG_INFO("External Kruskal: " << result.statistics.summary());
+
+    auto mstMatrix = std::make_unique<Matrix>(
+        numVertices, std::pmr::vector<Weight>(numVertices, NoEdge::noEdge), resultResource);
+    for (const auto &edge : result.mstEdges)
+    {
+        (*mstMatrix)[edge.u][edge.v] = edge.weight;
+        (*mstMatrix)[edge.v][edge.u] = edge.weight;
+    }
+    LOG_DEBUG("Finish Compute MST using External Kruskal");
+    return mstMatrix;
+}
+
+INSTANTIATE_WEIGHT_POLICIES(BasicExternalKruskalStrategy)
@@ -0,0 +1,24 @@
+#ifndef EXTERNAL_KRUSKAL_STRATEGY_HPP
+#define EXTERNAL_KRUSKAL_STRATEGY_HPP
+
+#include "MSTStrategy.hpp"
+#include "ExternalKruskal.hpp"
+#include <memory>
+
+/*
+    Kruskal with the edges sorted on disk (ExternalKruskal.hpp) under the memory and directory of
+    ExternalSortContext - the sort of a large graph no longer needs memory for all its edges.
+    The edges of the matrix are streamed to an edge file in the temporary directory first.
+*/
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicExternalKruskalStrategy : public BasicMSTStrategy<Weight, NoEdge>
+{
+public:
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+
+    std::unique_ptr<Matrix> computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource) override;
+};
+
+using ExternalKruskalStrategy = BasicExternalKruskalStrategy<int>;
+
+#endif
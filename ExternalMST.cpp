@@ -0,0 +1,141 @@
+// externalmst - minimum spanning tree of an edge list file larger than memory (ExternalKruskal.hpp)
+#include "ExternalKruskal.hpp"
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#define GENERATE_BLOCK_EDGES 65536
+
+struct Options
+{
+    std::string input;
+    std::string output;
+    std::string tempDirectory = "/tmp";
+    size_t memoryMB = 64;
+    uint64_t generateVertices = 0; // Write a random graph to the input file first (0 - read an existing file)
+    uint64_t generateEdges = 0;
+    int maxWeight = 1000;
+    unsigned long seed = 1;
+};
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " --input=FILE [options]\n"
+              << "  --input=FILE         Edge list: records of (uint32 u, uint32 v, int32 weight) in native byte order\n"
+              << "  --memory-mb=N        Memory of the edge sort before it merges runs from disk (default 64)\n"
+              << "  --tmp-dir=DIR        Directory of the sorted runs (default /tmp)\n"
+              << "  --output=FILE        Write the MST edges in the input format\n"
+              << "  --generate=V:E       First write a random connected graph of V vertices and E edges to the input file\n"
+              << "  --max-weight=N       Maximum generated edge weight (default 1000)\n"
+              << "  --seed=N             Generator seed (default 1)\n";
+}
+
+// Random spanning tree (connected) plus random edges - streamed, the graph is never held in memory
+static void generate(const Options &options)
+{
+    std::mt19937_64 rng(options.seed);
+    std::uniform_int_distribution<int> weight(1, options.maxWeight);
+    std::ofstream file(options.input, std::ios::binary | std::ios::trunc);
+    std::vector<ExternalKruskal::Edge> block;
+    block.reserve(GENERATE_BLOCK_EDGES);
+    auto push = [&](uint32_t u, uint32_t v)
+    {
+        block.push_back({u, v, weight(rng)});
+        if (block.size() == block.capacity())
+        {
+            file.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(ExternalKruskal::Edge));
+            block.clear();
+        }
+    };
+    for (uint64_t v = 1; v < options.generateVertices; ++v)
+    {
+        push(static_cast<uint32_t>(rng() % v), static_cast<uint32_t>(v));
+    }
+    for (uint64_t e = options.generateVertices - 1; e < options.generateEdges; ++e)
+    {
+        uint32_t u = static_cast<uint32_t>(rng() % options.generateVertices);
+        uint32_t v = static_cast<uint32_t>(rng() % options.generateVertices);
+        push(u, v == u ? (v + 1) % options.generateVertices : v);
+    }
+    file.write(reinterpret_cast<const char *>(block.data()), block.size() * sizeof(ExternalKruskal::Edge));
+    if (!file.flush())
+    {
+        throw std::runtime_error("cannot write " + options.input);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    Options options;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            size_t separator = arg.find('=');
+            std::string key = arg.substr(0, separator);
+            std::string value = separator == std::string::npos ? "" : arg.substr(separator + 1);
+
+            if (key == "--input") options.input = value;
+            else if (key == "--output") options.output = value;
+            else if (key == "--tmp-dir") options.tempDirectory = value;
+            else if (key == "--memory-mb") options.memoryMB = std::stoul(value);
+            else if (key == "--max-weight") options.maxWeight = std::stoi(value);
+            else if (key == "--seed") options.seed = std::stoul(value);
+            else if (key == "--generate")
+            {
+                size_t colon = value.find(':');
+                options.generateVertices = std::stoull(value.substr(0, colon));
+                options.generateEdges = colon == std::string::npos ? 0 : std::stoull(value.substr(colon + 1));
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return key == "--help" ? 0 : 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool badGenerate = options.generateVertices > 0 &&
+                       (options.generateVertices > UINT32_MAX || options.generateEdges < options.generateVertices - 1 || options.generateVertices < 2);
+    if (options.input.empty() || options.memoryMB == 0 || options.maxWeight <= 0 || badGenerate)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    try
+    {
+        if (options.generateVertices > 0)
+        {
+            generate(options);
+            std::cout << "Generated " << options.generateVertices << " vertices, " << options.generateEdges << " edges in " << options.input << "\n";
+        }
+        ExternalKruskal::Result result = ExternalKruskal(options.memoryMB << 20, options.tempDirectory).computeMST(options.input);
+        std::cout << "MST: " << result.mstEdges.size() << " edges, total weight " << result.totalWeight << "\n"
+                  << result.statistics.summary() << "\n";
+        if (!options.output.empty())
+        {
+            std::ofstream file(options.output, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(result.mstEdges.data()), result.mstEdges.size() * sizeof(ExternalKruskal::Edge));
+            if (!file.flush())
+            {
+                throw std::runtime_error("cannot write " + options.output);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << "\n";
+        return 1;
+    }
+    return 0;
+}
@@ -1,29 +1,122 @@
 #include "Graph.hpp"
+#include "Tracer.hpp"
+#include "MSTPathIndex.hpp"
+#include "CancellationToken.hpp"
+#include <algorithm>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
 
 #define NO_MST_DATA_CALCULATION -1
 #define PROGRESS_MST_DATA_CALCULATION 0
 #define FINISH_MST_DATA_CALCULATION 1
 #define INIT_INTEGER 0
 #define INIT_DOUBLE 0.0
+#define ARENA_ROW_SLACK 16 // Alignment padding per row
 
+// Arena size for the adjacency matrix and the MST matrix, so both fit in one upstream allocation
+template <typename Weight>
+static size_t graphArenaBytes(int vertices)
+{
+    size_t numVertices = vertices > 0 ? static_cast<size_t>(vertices) : 1;
+    size_t matrixBytes = numVertices * (numVertices * sizeof(Weight) + ARENA_ROW_SLACK + sizeof(std::pmr::vector<Weight>));
+    return 2 * matrixBytes;
+}
+
+// Hash of one edge - mixed so that the sum over the edge set does not cancel out
+template <typename Weight>
+static uint64_t edgeHash(int u, int v, Weight weight)
+{
+    uint64_t weightBits = 0;
+    if constexpr (std::is_floating_point_v<Weight>)
+    {
+        std::memcpy(&weightBits, &weight, sizeof(Weight));
+    }
+    else
+    {
+        weightBits = static_cast<uint64_t>(weight);
+    }
+    uint64_t key = (static_cast<uint64_t>(std::min(u, v)) << 32 | static_cast<uint32_t>(std::max(u, v))) ^ (weightBits * 0x9e3779b97f4a7c15ULL);
+    // splitmix64 finalizer
+    key = (key ^ (key >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    key = (key ^ (key >> 27)) * 0x94d049bb133111ebULL;
+    return key ^ (key >> 31);
+}
+
+// Shared by the graphs of every weight type, so ids stay unique
+static std::atomic<int> localGraphIDs{1};                    // Ids of created graphs
+static std::atomic<int> *nextGraphID = &localGraphIDs;       // Replaced by the shared store counter in worker processes
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::useGraphIDCounter(std::atomic<int> *counter)
+{
+    nextGraphID = counter;
+}
+
+template <typename Weight, typename NoEdge>
+BasicGraph<Weight, NoEdge>::BasicGraph(int vertices) : BasicGraph(vertices, (*nextGraphID)++)
+{
+}
 
+template <typename Weight, typename NoEdge>
+BasicGraph<Weight, NoEdge>::BasicGraph(int vertices, int id)
+    : homeNode(NumaTopology::getInstance().currentNode()),
+      graphArena(graphArenaBytes<Weight>(vertices), NumaTopology::getInstance().nodeResource(homeNode)), graphMatrix(&graphArena),
+      mstMatrix(nullptr), numVertices(vertices), numEdges(INIT_INTEGER), contentHash(INIT_INTEGER),
+      mstDataStatus(NO_MST_DATA_CALCULATION), mstTotalWeight(INIT_INTEGER), mstLongestDistance(INIT_INTEGER),
+      mstShortestDistance(std::numeric_limits<Sum>::max()), mstAvgEdgeWeight(INIT_DOUBLE), mstMetrics(0),
+      mstStrategy(nullptr), graphID(id), ownerID(-1),
+      residencyPins(0), spilled(false), spilledWithMST(false), memoryBudget(nullptr)
+{
+    // Rows are constructed in place so they are allocated contiguously from the graph arena
+    this->graphMatrix.reserve(vertices);
+    for (int i = 0; i < vertices; ++i)
+    {
+        this->graphMatrix.emplace_back(vertices, NoEdge::noEdge);
+    }
+}
 
-Graph::Graph(int vertices)
-    : numVertices(vertices), numEdges(INIT_INTEGER),
-      mstTotalWeight(INIT_INTEGER), mstLongestDistance(INIT_INTEGER), mstShortestDistance(INT_MAX),
-      mstAvgEdgeWeight(INIT_DOUBLE), mstDataStatus(NO_MST_DATA_CALCULATION),
-      mstStrategy(nullptr), mstMatrix(nullptr),
-      graphMatrix(vertices, std::vector<int>(vertices, INIT_INTEGER)) {}
+template <typename Weight, typename NoEdge>
+BasicGraph<Weight, NoEdge>::~BasicGraph()
+{
+    if (this->memoryBudget != nullptr)
+    {
+        this->memoryBudget->remove(*this);
+    }
+    if (!this->spillPath.empty())
+    {
+        std::remove(this->spillPath.c_str());
+    }
+}
 
 // Add edge to graph
-void Graph::addEdge(int u, int v, int weight)
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::addEdge(int u, int v, Weight weight)
 {
     if (u < 0 || u >= numVertices || v < 0 || v >= numVertices)
     {
         throw std::out_of_range("Vertex index out of bounds");
     }
+    if constexpr (std::is_signed_v<Weight>)
+    {
+        // The distance metrics run Floyd-Warshall on the symmetric MST matrix - a negative edge would be a negative cycle
+        if (weight < Weight(0))
+        {
+            throw std::invalid_argument("Negative edge weight");
+        }
+    }
+
+    // The content hash is updated as the edges arrive - a replaced edge takes its old hash out
+    if (NoEdge::isEdge(this->graphMatrix[u][v]))
+    {
+        this->contentHash -= edgeHash(u, v, this->graphMatrix[u][v]);
+    }
+    if (NoEdge::isEdge(weight))
+    {
+        this->contentHash += edgeHash(u, v, weight);
+    }
 
-    else if (this->graphMatrix[u][v] != 0 || this->graphMatrix[v][u] != 0)
+    if (NoEdge::isEdge(this->graphMatrix[u][v]) || NoEdge::isEdge(this->graphMatrix[v][u]))
     {
         this->graphMatrix[u][v] = weight;
         this->graphMatrix[v][u] = weight; // Assuming undirected graph
@@ -37,67 +130,360 @@ void Graph::addEdge(int u, int v, int weight)
     }
 }
 
-void Graph::activateMSTStrategy()
+// Write an edge without bounds checks or edge counting (parallel generators - the caller owns the pair)
+// Returns true if the pair had no edge before
+template <typename Weight, typename NoEdge>
+bool BasicGraph<Weight, NoEdge>::setEdgeUnchecked(int u, int v, Weight weight)
+{
+    bool newEdge = !NoEdge::isEdge(this->graphMatrix[u][v]);
+    this->graphMatrix[u][v] = weight;
+    this->graphMatrix[v][u] = weight; // Assuming undirected graph
+    return newEdge;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::addEdgeCount(int edges)
+{
+    this->numEdges += edges;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::rehashContent()
+{
+    ResidencyPin pin(*this);
+    uint64_t hash = 0;
+    for (int i = 0; i < this->numVertices; ++i)
+    {
+        for (int j = i + 1; j < this->numVertices; ++j)
+        {
+            if (NoEdge::isEdge(this->graphMatrix[i][j]))
+            {
+                hash += edgeHash(i, j, this->graphMatrix[i][j]);
+            }
+        }
+    }
+    this->contentHash = hash;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::activateMSTStrategy()
 {
+    TraceSpan span("activateMSTStrategy", "mst", this->graphID);
+    ResidencyPin pin(*this);
     if (this->mstStrategy != nullptr)
     {
         try 
         {
-            this->mstMatrix = std::move(this->mstStrategy->computeMST(this->graphMatrix));
+            this->mstMatrix = std::move(this->mstStrategy->computeMST(this->graphMatrix, &this->graphArena));
         } 
+        catch (const JobCancelled &)
+        {
+            throw; // Not an error - the job that asked for the MST dropped it
+        }
         catch (const std::exception& e) 
         {
-            std::cerr << "Error computing MST: " << e.what() << std::endl;
+            LOG_ERROR("Error computing MST: " << e.what());
         }
     }
     else
     {
-        std::cerr << "MST Strategy is not set" << std::endl;
+        LOG_ERROR("MST Strategy is not set");
+    }
+}
+
+// Copy a matrix into a row-major flat buffer of distances - a missing edge becomes noPath
+template <typename NoEdge, typename Weight, typename Sum>
+static void copyMatrixToFlat(const BasicAdjacencyMatrix<Weight> &matrix, std::pmr::vector<Sum> &flat, Sum noPath)
+{
+    size_t numVertices = matrix.size();
+    flat.resize(numVertices * numVertices);
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        std::transform(matrix[i].begin(), matrix[i].end(), flat.begin() + i * numVertices,
+                       [noPath](Weight weight) { return NoEdge::isEdge(weight) ? static_cast<Sum>(weight) : noPath; });
     }
 }
 
 /*  Getters */
 
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getGraphID() const
+{
+    return this->graphID;
+}
+
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getHomeNode() const
+{
+    return this->homeNode;
+}
+
+template <typename Weight, typename NoEdge>
+uint64_t BasicGraph<Weight, NoEdge>::getContentHash() const
+{
+    return this->contentHash ^ edgeHash(this->numVertices, this->numVertices, Weight(0)); // Isolated vertices count too
+}
+
+// The hash only selects candidates - the matrices decide
+template <typename Weight, typename NoEdge>
+bool BasicGraph<Weight, NoEdge>::hasSameContent(const BasicGraph &other) const
+{
+    ResidencyPin pin(*this);
+    ResidencyPin otherPin(other);
+    if (this->numVertices != other.numVertices || this->numEdges != other.numEdges || this->contentHash != other.contentHash)
+    {
+        return false;
+    }
+    if (this->vertexOrder == other.vertexOrder)
+    {
+        return this->graphMatrix == other.graphMatrix;
+    }
+    // Relabeled differently - compare in original vertex ids
+    auto index = [](const BasicGraph &graph, int vertex) { return graph.vertexRank.empty() ? vertex : graph.vertexRank[vertex]; };
+    for (int i = 0; i < this->numVertices; ++i)
+    {
+        for (int j = 0; j < this->numVertices; ++j)
+        {
+            if (this->graphMatrix[index(*this, i)][index(*this, j)] != other.graphMatrix[index(other, i)][index(other, j)])
+            {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setOwnerID(int id)
+{
+    this->ownerID = id;
+}
+
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getOwnerID() const
+{
+    return this->ownerID;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::markStored()
+{
+    this->storedTime = std::chrono::steady_clock::now();
+}
+
+template <typename Weight, typename NoEdge>
+std::chrono::steady_clock::time_point BasicGraph<Weight, NoEdge>::getStoredTime() const
+{
+    return this->storedTime;
+}
+
 // Get adjacency matrix represent the graph
-const std::vector<std::vector<int>> &Graph::getGraph() const
+template <typename Weight, typename NoEdge>
+const BasicAdjacencyMatrix<Weight> &BasicGraph<Weight, NoEdge>::getGraph() const
 {
     return this->graphMatrix;
 }
 
 // Get number of vertices
-int Graph::getSizeVertices() const
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getSizeVertices() const
 {
     return this->numVertices;
 }
 
-int Graph::getMSTTotalWeight() const
+// Get number of edges
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getSizeEdges() const
+{
+    return this->numEdges;
+}
+
+template <typename Weight, typename NoEdge>
+typename WeightTraits<Weight>::Sum BasicGraph<Weight, NoEdge>::getMSTTotalWeight() const
 {
     return this->mstTotalWeight;
 }
 
-int Graph::getMSTLongestDistance() const
+template <typename Weight, typename NoEdge>
+typename WeightTraits<Weight>::Sum BasicGraph<Weight, NoEdge>::getMSTLongestDistance() const
 {
     return this->mstLongestDistance;
 }
 
-int Graph::getMSTShortestDistance() const
+template <typename Weight, typename NoEdge>
+typename WeightTraits<Weight>::Sum BasicGraph<Weight, NoEdge>::getMSTShortestDistance() const
 {
     return this->mstShortestDistance;
 }
 
-int Graph::getMSTDataStatusCalculation() const
+template <typename Weight, typename NoEdge>
+int BasicGraph<Weight, NoEdge>::getMSTDataStatusCalculation() const
 {
     return this->mstDataStatus;
 }
 
-double Graph::getMSTAvgEdgeWeight() const
+template <typename Weight, typename NoEdge>
+double BasicGraph<Weight, NoEdge>::getMSTAvgEdgeWeight() const
 {
     return this->mstAvgEdgeWeight;
 }
 
-bool Graph::getValidationMSTExist() const
+template <typename Weight, typename NoEdge>
+bool BasicGraph<Weight, NoEdge>::hasMSTMetric(MSTMetric metric) const
 {
-    return this->mstMatrix != nullptr;
+    return (this->mstMetrics.load(std::memory_order_acquire) & metric) != 0;
+}
+
+template <typename Weight, typename NoEdge>
+uint32_t BasicGraph<Weight, NoEdge>::getComputedMetrics() const
+{
+    return this->mstMetrics.load(std::memory_order_acquire);
+}
+
+template <typename Weight, typename NoEdge>
+bool BasicGraph<Weight, NoEdge>::getValidationMSTExist() const
+{
+    std::lock_guard<std::mutex> lock(this->residencyMutex); // The MST matrix is freed while spilled
+    return this->spilled ? this->spilledWithMST : this->mstMatrix != nullptr;
+}
+
+/*  Residency under a memory budget */
+
+template <typename Weight, typename NoEdge>
+BasicGraph<Weight, NoEdge>::ResidencyPin::ResidencyPin(const BasicGraph &graph) : graph(graph)
+{
+    bool pagedIn = false;
+    {
+        std::lock_guard<std::mutex> lock(graph.residencyMutex);
+        graph.residencyPins++;
+        if (graph.spilled)
+        {
+            try
+            {
+                graph.pageIn();
+            }
+            catch (...)
+            {
+                graph.residencyPins--; // The destructor of a pin that failed does not run
+                throw;
+            }
+            pagedIn = true;
+        }
+    }
+    if (graph.memoryBudget != nullptr)
+    {
+        graph.memoryBudget->touch(graph, pagedIn); // Without residencyMutex - the budget may spill other graphs
+    }
+}
+
+template <typename Weight, typename NoEdge>
+BasicGraph<Weight, NoEdge>::ResidencyPin::~ResidencyPin()
+{
+    std::lock_guard<std::mutex> lock(this->graph.residencyMutex);
+    this->graph.residencyPins--;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMemoryBudget(GraphMemoryBudget *budget)
+{
+    size_t bytes;
+    {
+        std::lock_guard<std::mutex> lock(this->residencyMutex);
+        if (this->memoryBudget != nullptr)
+        {
+            return; // Stored again as a shared copy
+        }
+        this->memoryBudget = budget;
+        bytes = residentBytesLocked();
+    }
+    budget->add(*this, this->graphID, this->numVertices, bytes); // Without residencyMutex - the budget may spill other graphs
+}
+
+template <typename Weight, typename NoEdge>
+size_t BasicGraph<Weight, NoEdge>::getResidentBytes() const
+{
+    std::lock_guard<std::mutex> lock(this->residencyMutex); // pageIn and trySpill change the MST matrix
+    return residentBytesLocked();
+}
+
+template <typename Weight, typename NoEdge>
+size_t BasicGraph<Weight, NoEdge>::residentBytesLocked() const
+{
+    size_t matrixBytes = static_cast<size_t>(this->numVertices) * this->numVertices * sizeof(Weight);
+    return this->mstMatrix != nullptr || this->spilledWithMST ? 2 * matrixBytes : matrixBytes;
+}
+
+// The matrices do not change once the graph is stored, so a spill file written once serves every later spill
+template <typename Weight, typename NoEdge>
+bool BasicGraph<Weight, NoEdge>::trySpill()
+{
+    std::unique_lock<std::mutex> lock(this->residencyMutex, std::try_to_lock);
+    if (!lock.owns_lock() || this->residencyPins > 0 || this->spilled || this->memoryBudget == nullptr)
+    {
+        return false;
+    }
+    if (this->spillPath.empty())
+    {
+        std::string path = this->memoryBudget->spillPath(this->graphID);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        for (const auto &row : this->graphMatrix)
+        {
+            file.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(Weight));
+        }
+        if (this->mstMatrix != nullptr)
+        {
+            for (const auto &row : *this->mstMatrix)
+            {
+                file.write(reinterpret_cast<const char *>(row.data()), row.size() * sizeof(Weight));
+            }
+        }
+        if (!file.flush())
+        {
+            LOG_WARN("Graph " << this->graphID << ": cannot write spill file " << path);
+            file.close();
+            std::remove(path.c_str());
+            return false;
+        }
+        this->spillPath = path;
+    }
+
+    // The rows live in the graph arena - release it as a whole
+    this->spilledWithMST = this->mstMatrix != nullptr;
+    this->mstMatrix.reset();
+    this->graphMatrix = Matrix(&this->graphArena);
+    this->graphArena.release();
+    this->spilled = true;
+    return true;
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::pageIn() const
+{
+    TraceSpan span("pageIn", "memory", this->graphID);
+    std::ifstream file(this->spillPath, std::ios::binary);
+    auto readMatrix = [this, &file](Matrix &matrix)
+    {
+        matrix.reserve(this->numVertices);
+        for (int i = 0; i < this->numVertices; ++i)
+        {
+            matrix.emplace_back(this->numVertices, NoEdge::noEdge);
+            file.read(reinterpret_cast<char *>(matrix.back().data()), this->numVertices * sizeof(Weight));
+        }
+    };
+    readMatrix(this->graphMatrix);
+    if (this->spilledWithMST)
+    {
+        this->mstMatrix = std::make_unique<Matrix>(&this->graphArena);
+        readMatrix(*this->mstMatrix);
+    }
+    if (!file)
+    {
+        this->mstMatrix.reset();
+        this->graphMatrix = Matrix(&this->graphArena);
+        this->graphArena.release();
+        throw std::runtime_error("Graph " + std::to_string(this->graphID) + ": cannot read spill file " + this->spillPath);
+    }
+    this->spilled = false;
 }
 
 
@@ -106,7 +492,8 @@ bool Graph::getValidationMSTExist() const
 /*  Setters */
 
 // Set the next status of the MST data calculation
-void Graph::setMSTDataCalculationNextStatus()
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTDataCalculationNextStatus()
 {
     if (this->mstDataStatus == NO_MST_DATA_CALCULATION)
     {
@@ -118,51 +505,95 @@ void Graph::setMSTDataCalculationNextStatus()
     }else return;
 }
 
+// Forget partially computed MST data, so the graph is processed again by the next request
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::resetMSTDataCalculation()
+{
+    this->mstDataStatus = NO_MST_DATA_CALCULATION;
+    this->mstTotalWeight = INIT_INTEGER;
+    this->mstLongestDistance = INIT_INTEGER;
+    this->mstShortestDistance = std::numeric_limits<Sum>::max();
+    this->mstAvgEdgeWeight = INIT_DOUBLE;
+    this->mstMetrics.store(0, std::memory_order_release);
+}
+
+// A later request needs metrics the finished graph does not have - it is queued again, the computed ones stay
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::reopenMSTDataCalculation()
+{
+    if (this->mstDataStatus == FINISH_MST_DATA_CALCULATION)
+    {
+        this->mstDataStatus = NO_MST_DATA_CALCULATION;
+    }
+}
+
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::markMetricsComputed(uint32_t metrics)
+{
+    this->mstMetrics.fetch_or(metrics, std::memory_order_release);
+}
+
 // Calculate and return the total weight of MST
-void Graph::setMSTTotalWeight()
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTTotalWeight()
 {
+    TraceSpan span("setMSTTotalWeight", "metric", this->graphID);
+    ResidencyPin pin(*this);
     if(mstMatrix == nullptr)
     {
         return;
     }
-    int totalWeight = INIT_INTEGER;
+    Sum totalWeight = INIT_INTEGER;
     for (int i = 0; i < this->numVertices; ++i)
     {
         for (int j = i + 1; j < this->numVertices; ++j)
         {
-            totalWeight += (*this->mstMatrix)[i][j];
+            if (NoEdge::isEdge((*this->mstMatrix)[i][j]))
+            {
+                totalWeight += (*this->mstMatrix)[i][j];
+            }
         }
     }
     this->mstTotalWeight = totalWeight;
+    this->mstMetrics.fetch_or(MST_TOTAL_WEIGHT, std::memory_order_release);
 }
 
 // Return the highest weighted distance in the MST
-void Graph::setMSTLongestDistance()
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTLongestDistance()
 {
+    TraceSpan span("setMSTLongestDistance (Floyd-Warshall)", "metric", this->graphID);
+    ResidencyPin pin(*this);
     if(mstMatrix == nullptr)
     {
         return;
     }
-    int longestDistance = INIT_INTEGER;
+    Sum longestDistance = INIT_INTEGER;
     int numVertices = this->numVertices;
+    const Sum noPath = std::numeric_limits<Sum>::max();
 
     // Use Floyd-Warshall algorithm to find the longest path in the MST
-    std::vector<std::vector<int>> dist = *this->mstMatrix;
+    // Distances live in a flat buffer of the thread scratch arena instead of a deep copy of the MST matrix
+    ScratchArena::Scope scratch;
+    std::pmr::vector<Sum> distBuffer(scratch.resource());
+    copyMatrixToFlat<NoEdge>(*this->mstMatrix, distBuffer, noPath);
+    Sum *dist = distBuffer.data();
 
     for (int k = 0; k < numVertices; ++k)
     {
+        CancellationToken::checkpoint(); // Once per V^2 pass
         for (int i = 0; i < numVertices; ++i)
         {
             for (int j = 0; j < numVertices; ++j)
             {
-                if (dist[i][k] != 0 && dist[k][j] != 0)
+                if (dist[i * numVertices + k] != noPath && dist[k * numVertices + j] != noPath)
                 {
-                    int newDist = dist[i][k] + dist[k][j]; // new potential distance
-                    // check if the current distaance from i to j is either zero or greater than the new potential distance
+                    Sum newDist = dist[i * numVertices + k] + dist[k * numVertices + j]; // new potential distance
+                    // check if the current distaance from i to j is either no path or greater than the new potential distance
                     // if either condition is true it updates the distance from i to j to the new larger distance
-                    if (dist[i][j] == 0 || newDist < dist[i][j])
+                    if (newDist < dist[i * numVertices + j])
                     {
-                        dist[i][j] = newDist;
+                        dist[i * numVertices + j] = newDist;
                     }
                 }
             }
@@ -173,18 +604,22 @@ void Graph::setMSTLongestDistance()
     {
         for (int j = i + 1; j < numVertices; ++j)
         {
-            if (dist[i][j] > longestDistance)
+            if (dist[i * numVertices + j] != noPath && dist[i * numVertices + j] > longestDistance)
             {
-                longestDistance = dist[i][j];
+                longestDistance = dist[i * numVertices + j];
             }
         }
     }
     this->mstLongestDistance = longestDistance;
+    this->mstMetrics.fetch_or(MST_LONGEST_DISTANCE, std::memory_order_release);
 }
 
 // Return the average edge weight in the MST
-void Graph::setMSTAvgEdgeWeight()
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTAvgEdgeWeight()
 {
+    TraceSpan span("setMSTAvgEdgeWeight", "metric", this->graphID);
+    ResidencyPin pin(*this);
     if(mstMatrix == nullptr)
     {
         return;
@@ -197,7 +632,7 @@ void Graph::setMSTAvgEdgeWeight()
     {
         for (int j = i + 1; j < numVertices; ++j)
         {
-            if ((*this->mstMatrix)[i][j] != 0)
+            if (NoEdge::isEdge((*this->mstMatrix)[i][j]))
             {
                 totalWeight += (*this->mstMatrix)[i][j];
                 ++edgeCount;
@@ -211,35 +646,45 @@ void Graph::setMSTAvgEdgeWeight()
         this->mstAvgEdgeWeight = 0.0;
     }
     this->mstAvgEdgeWeight = (totalWeight / edgeCount);
+    this->mstMetrics.fetch_or(MST_AVERAGE_WEIGHT, std::memory_order_release);
 }
 
 
 
-void Graph::setMSTShortestDistance()
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTShortestDistance()
 {
+    TraceSpan span("setMSTShortestDistance (Floyd-Warshall)", "metric", this->graphID);
+    ResidencyPin pin(*this);
     if(mstMatrix == nullptr)
     {
         return;
     }
-    int shortestDistance = INT_MAX;
+    const Sum noPath = std::numeric_limits<Sum>::max();
+    Sum shortestDistance = noPath;
     int numVertices = this->numVertices;
 
-    std::vector<std::vector<int>> dist = *this->mstMatrix; // Use Floyd-Warshall algorithm to find the shortest path in the MST
+    // Use Floyd-Warshall algorithm to find the shortest path in the MST (flat buffer of the thread scratch arena)
+    ScratchArena::Scope scratch;
+    std::pmr::vector<Sum> distBuffer(scratch.resource());
+    copyMatrixToFlat<NoEdge>(*this->mstMatrix, distBuffer, noPath);
+    Sum *dist = distBuffer.data();
 
     for (int k = 0; k < numVertices; ++k)
     {
+        CancellationToken::checkpoint(); // Once per V^2 pass
         for (int i = 0; i < numVertices; ++i)
         {
             for (int j = 0; j < numVertices; ++j)
             {
-                if (dist[i][k] != 0 && dist[k][j] != 0)
+                if (dist[i * numVertices + k] != noPath && dist[k * numVertices + j] != noPath)
                 {
-                    int newDist = dist[i][k] + dist[k][j]; // new potential distance
-                    // Check if the current distance from i to j is either zero or greater than the new potential distance
+                    Sum newDist = dist[i * numVertices + k] + dist[k * numVertices + j]; // new potential distance
+                    // Check if the current distance from i to j is either no path or greater than the new potential distance
                     // if either condition is true it updates the distance from i to j to the new smaller distance
-                    if (dist[i][j] == 0 || newDist < dist[i][j])
+                    if (newDist < dist[i * numVertices + j])
                     {
-                        dist[i][j] = newDist;
+                        dist[i * numVertices + j] = newDist;
                     }
                 }
             }
@@ -251,37 +696,197 @@ void Graph::setMSTShortestDistance()
     {
         for (int j = i + 1; j < numVertices; ++j)
         {
-            if (dist[i][j] != 0 && dist[i][j] < shortestDistance)
+            if (dist[i * numVertices + j] < shortestDistance)
             {
-                shortestDistance = dist[i][j];
+                shortestDistance = dist[i * numVertices + j];
             }
         }
     }
-    this->mstShortestDistance = (shortestDistance == INT_MAX) ? 0 : shortestDistance;
+    this->mstShortestDistance = (shortestDistance == noPath) ? 0 : shortestDistance;
+    this->mstMetrics.fetch_or(MST_SHORTEST_DISTANCE, std::memory_order_release);
 }
 
-void Graph::setMSTStrategy(std::unique_ptr<MSTStrategy> strategy)
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::setMSTStrategy(std::unique_ptr<Strategy> strategy)
 {
     this->mstStrategy = std::move(strategy);
 }
 
-// Get String to print of adjacency matrix represent the MST
-std::string Graph::printMST() const
+// Load an MST computed by another process - the edges must form the MST of this graph (original vertex ids)
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::loadMST(const std::vector<Edge> &edges)
 {
-    if(mstMatrix == nullptr)
+    this->mstMatrix = std::make_unique<Matrix>(
+        this->numVertices, std::pmr::vector<Weight>(this->numVertices, NoEdge::noEdge), &this->graphArena);
+    for (const Edge &edge : edges)
     {
-        return "No MST";
+        int u = this->vertexRank.empty() ? edge.u : this->vertexRank[edge.u];
+        int v = this->vertexRank.empty() ? edge.v : this->vertexRank[edge.v];
+        (*this->mstMatrix)[u][v] = edge.weight;
+        (*this->mstMatrix)[v][u] = edge.weight;
     }
-    std::stringstream mstString;
+}
+
+// Permute the rows and columns of a matrix - order[new index] = old index
+template <typename Weight>
+static void permuteMatrix(BasicAdjacencyMatrix<Weight> &matrix, const std::vector<int> &order)
+{
+    size_t numVertices = matrix.size();
+    ScratchArena::Scope scratch;
+    std::pmr::vector<Weight> copy(numVertices * numVertices, scratch.resource());
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        std::copy(matrix[i].begin(), matrix[i].end(), copy.begin() + i * numVertices);
+    }
+    for (size_t i = 0; i < numVertices; ++i)
+    {
+        const Weight *source = copy.data() + static_cast<size_t>(order[i]) * numVertices;
+        for (size_t j = 0; j < numVertices; ++j)
+        {
+            matrix[i][j] = source[order[j]];
+        }
+    }
+}
+
+// The matrices are relabeled in place (through a scratch copy), so the graph arena does not grow
+template <typename Weight, typename NoEdge>
+void BasicGraph<Weight, NoEdge>::reorderVertices(VertexOrdering::Method method)
+{
+    if (method == VertexOrdering::Identity || this->numVertices < 2)
+    {
+        return;
+    }
+    TraceSpan span(method == VertexOrdering::ReverseCuthillMcKee ? "reorderVertices (RCM)" : "reorderVertices (BFS)", "mst", this->graphID);
+    ResidencyPin pin(*this);
+
+    std::vector<int> offsets(this->numVertices + 1, 0);
+    std::vector<int> neighbors;
     for (int i = 0; i < this->numVertices; ++i)
     {
-        for (int j = i + 1; j < this->numVertices; ++j)
+        for (int j = 0; j < this->numVertices; ++j)
         {
-            if ((*this->mstMatrix)[i][j] != 0)
+            if (i != j && NoEdge::isEdge(this->graphMatrix[i][j]))
             {
-                mstString << "Edge: " << i << " - " << j << " | Weight: " << (*mstMatrix)[i][j] << "\n";
+                neighbors.push_back(j);
             }
         }
+        offsets[i + 1] = neighbors.size();
+    }
+    std::vector<int> order = VertexOrdering::compute(method, offsets, neighbors);
+
+    permuteMatrix(this->graphMatrix, order);
+    if (this->mstMatrix != nullptr)
+    {
+        permuteMatrix(*this->mstMatrix, order);
+    }
+    // Compose with an earlier relabeling - the maps always lead back to the input ids
+    if (!this->vertexOrder.empty())
+    {
+        for (int &vertex : order)
+        {
+            vertex = this->vertexOrder[vertex];
+        }
+    }
+    this->vertexOrder = std::move(order);
+    this->vertexRank.assign(this->numVertices, 0);
+    for (int i = 0; i < this->numVertices; ++i)
+    {
+        this->vertexRank[this->vertexOrder[i]] = i;
+    }
+}
+
+template <typename Weight, typename NoEdge>
+std::vector<BasicWeightedEdge<Weight>> BasicGraph<Weight, NoEdge>::toOriginalIds(std::vector<Edge> edges) const
+{
+    if (this->vertexOrder.empty())
+    {
+        return edges;
+    }
+    for (Edge &edge : edges)
+    {
+        int u = this->vertexOrder[edge.u];
+        int v = this->vertexOrder[edge.v];
+        edge.u = std::min(u, v);
+        edge.v = std::max(u, v);
+    }
+    // Same order as the edges of a graph that was not relabeled
+    std::sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) { return a.u != b.u ? a.u < b.u : a.v < b.v; });
+    return edges;
+}
+
+// Upper triangle of a matrix as an edge list
+template <typename NoEdge, typename Weight>
+static std::vector<BasicWeightedEdge<Weight>> matrixEdges(const BasicAdjacencyMatrix<Weight> &matrix)
+{
+    std::vector<BasicWeightedEdge<Weight>> edges;
+    int numVertices = matrix.size();
+    for (int i = 0; i < numVertices; ++i)
+    {
+        for (int j = i + 1; j < numVertices; ++j)
+        {
+            if (NoEdge::isEdge(matrix[i][j]))
+            {
+                edges.push_back({i, j, matrix[i][j]});
+            }
+        }
+    }
+    return edges;
+}
+
+template <typename Weight, typename NoEdge>
+std::vector<BasicWeightedEdge<Weight>> BasicGraph<Weight, NoEdge>::getEdges() const
+{
+    ResidencyPin pin(*this);
+    return toOriginalIds(matrixEdges<NoEdge>(this->graphMatrix));
+}
+
+template <typename Weight, typename NoEdge>
+std::vector<BasicWeightedEdge<Weight>> BasicGraph<Weight, NoEdge>::getMSTEdges() const
+{
+    ResidencyPin pin(*this);
+    return this->mstMatrix != nullptr ? toOriginalIds(matrixEdges<NoEdge>(*this->mstMatrix)) : std::vector<Edge>();
+}
+
+template <typename Weight, typename NoEdge>
+std::shared_ptr<const BasicMSTPathIndex<Weight>> BasicGraph<Weight, NoEdge>::getMSTPathIndex() const
+{
+    std::call_once(this->pathIndexBuilt, [this]()
+    {
+        this->pathIndex = std::make_shared<const PathIndex>(this->numVertices, getMSTEdges());
+        GraphMemoryBudget *budget;
+        {
+            std::lock_guard<std::mutex> lock(this->residencyMutex);
+            budget = this->memoryBudget;
+        }
+        if (budget != nullptr)
+        {
+            budget->addIndexBytes(*this, this->pathIndex->getMemoryBytes()); // The index is not spilled with the matrices
+        }
+    });
+    return this->pathIndex;
+}
+
+// Get String to print of adjacency matrix represent the MST
+template <typename Weight, typename NoEdge>
+std::string BasicGraph<Weight, NoEdge>::printMST() const
+{
+    ResidencyPin pin(*this);
+    if(mstMatrix == nullptr)
+    {
+        return "No MST";
+    }
+    return formatMSTEdges(getMSTEdges());
+}
+
+template <typename Weight, typename NoEdge>
+std::string BasicGraph<Weight, NoEdge>::formatMSTEdges(const std::vector<Edge> &edges)
+{
+    std::stringstream mstString;
+    for (const Edge &edge : edges)
+    {
+        mstString << "Edge: " << edge.u << " - " << edge.v << " | Weight: " << +edge.weight << "\n"; // + prints uint8_t as a number
     }
     return mstString.str();
-}
\ No newline at end of file
+}
+
+INSTANTIATE_WEIGHT_POLICIES(BasicGraph)
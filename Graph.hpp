@@ -6,47 +6,161 @@
 #include <stdexcept>
 #include <climits>
 #include <memory>
+#include <memory_resource>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <cstdint>
 #include "MSTStrategy.hpp"
+#include "MemoryArena.hpp"
+#include "WeightTraits.hpp"
+#include "GraphMemoryBudget.hpp"
+#include "VertexOrdering.hpp"
+#include "NumaTopology.hpp"
 
-class Graph
+// Edge of an edge list (u < v)
+template <typename Weight>
+struct BasicWeightedEdge
 {
+    int u;
+    int v;
+    Weight weight;
+};
+
+using WeightedEdge = BasicWeightedEdge<int>;
+
+template <typename Weight>
+class BasicMSTPathIndex;
+
+// MST metrics of a graph - bits of its computed metrics (bit i is MetricRegistry metric i, the built-ins come first)
+enum MSTMetric : uint32_t
+{
+    MST_TOTAL_WEIGHT = 1u << 0,
+    MST_LONGEST_DISTANCE = 1u << 1,
+    MST_SHORTEST_DISTANCE = 1u << 2,
+    MST_AVERAGE_WEIGHT = 1u << 3
+};
+
+/*
+    Graph on a dense adjacency matrix, templated on the weight type and on the value marking
+    a missing edge (WeightTraits.hpp). The MST metrics are sums of weights and are kept in the
+    wider Sum type. Defined in Graph.cpp for the weight types instantiated there.
+    A stored graph under a memory budget may have its matrices spilled to a file. Every method
+    that reads the matrices pins the graph first (ResidencyPin), which pages them back in and
+    keeps them in memory until the method returns.
+*/
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicGraph : public SpillableGraph
+{
+public:
+    using Edge = BasicWeightedEdge<Weight>;
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+    using Strategy = BasicMSTStrategy<Weight, NoEdge>;
+    using PathIndex = BasicMSTPathIndex<Weight>;
+    using Sum = typename WeightTraits<Weight>::Sum;
+
 private:
-    std::vector<std::vector<int>> graphMatrix;                // Adjacency matrix - graph representations
-    std::unique_ptr<std::vector<std::vector<int>>> mstMatrix; // Smart pointer to the mst matrix
+    // Keeps the matrices in memory while alive - pages them in if the graph was spilled
+    class ResidencyPin
+    {
+    private:
+        const BasicGraph &graph;
+
+    public:
+        ResidencyPin(const BasicGraph &graph);
+        ~ResidencyPin();
+        ResidencyPin(const ResidencyPin &) = delete;
+        ResidencyPin &operator=(const ResidencyPin &) = delete;
+    };
+
+    int homeNode;                                             // NUMA node of the thread that created the graph - holds its matrices
+    // The matrices are mutable - const readers page a spilled graph back in
+    mutable std::pmr::monotonic_buffer_resource graphArena;   // Arena of the graph - holds the adjacency and MST matrices
+    mutable Matrix graphMatrix;                               // Adjacency matrix - graph representations
+    mutable std::unique_ptr<Matrix> mstMatrix;                // Smart pointer to the mst matrix
     int numVertices;                                          // Number of vertices in graph
     int numEdges;                                             // Number of edges in graph
+    uint64_t contentHash;                                     // Order independent hash of the edge set (sum of the edge hashes)
     int mstDataStatus;                                        // Flag to check if MST data has been computed
-    int mstTotalWeight;                                       // Total weight of MST
-    int mstLongestDistance;                                   // Longest distance in MST
-    int mstShortestDistance;                                  // Shortest distance in MST
+    Sum mstTotalWeight;                                       // Total weight of MST
+    Sum mstLongestDistance;                                   // Longest distance in MST
+    Sum mstShortestDistance;                                  // Shortest distance in MST
     double mstAvgEdgeWeight;                                  // Average edge weight in MST
-    std::unique_ptr<MSTStrategy> mstStrategy;                                 // Pointer to the MST strategy
+    std::atomic<uint32_t> mstMetrics;                         // MetricRegistry bits of the metrics computed (parallel pipeline branches set theirs)
+    std::unique_ptr<Strategy> mstStrategy;                    // Pointer to the MST strategy
+    int graphID;                                              // Unique id of the graph (trace / log key)
+    int ownerID;                                              // Client that created the graph (-1 if unknown)
+    std::chrono::steady_clock::time_point storedTime;         // When the graph was stored as unprocessed
+    mutable std::once_flag pathIndexBuilt;                    // The path index is built by the first query
+    mutable std::shared_ptr<const PathIndex> pathIndex;       // Path queries on the MST
+    std::vector<int> vertexOrder;                             // [matrix index] - original vertex id (empty - input order)
+    std::vector<int> vertexRank;                              // [original vertex id] - matrix index
+    mutable std::mutex residencyMutex;                        // Guards the residency fields, and the matrices while spilling / paging in
+    mutable int residencyPins;                                // Methods reading the matrices - a pinned graph is not spilled
+    mutable bool spilled;                                     // The matrices are only in the spill file
+    bool spilledWithMST;                                      // The spill file holds the MST matrix too
+    std::string spillPath;                                    // Spill file (empty until the first spill - kept for the next one)
+    GraphMemoryBudget *memoryBudget;                          // Budget accounting the stored graph (nullptr - not accounted)
+
+    void pageIn() const;                                      // Read the spilled matrices back - caller holds residencyMutex
+    size_t residentBytesLocked() const;                       // Bytes of the matrices - caller holds residencyMutex
+    std::vector<Edge> toOriginalIds(std::vector<Edge> edges) const; // Edges of the matrix in original vertex ids
 
 public:
-    Graph(int vertices);
-    ~Graph() = default; // RAII - Destructor
+    BasicGraph(int vertices);
+    BasicGraph(int vertices, int id);                      // Graph with a known id (imported from another process)
+    static void useGraphIDCounter(std::atomic<int> *counter); // Take the ids of new graphs (of every weight type) from a shared counter
+    ~BasicGraph(); // RAII - Destructor - leaves the memory budget and removes the spill file
 
     // Origin Graph Functions
-    void addEdge(int u, int v, int weight);                // Add edge to graph
+    void addEdge(int u, int v, Weight weight);             // Add edge to graph - throws std::invalid_argument for a negative weight
+    bool setEdgeUnchecked(int u, int v, Weight weight);    // Bulk writers - no bounds check, edge count and content hash not updated
+    void addEdgeCount(int edges);                          // Bulk writers - account the edges written unchecked
+    void rehashContent();                                  // Bulk writers - recompute the content hash from the matrix
     int getSizeVertices() const;                           // Get number of vertices
-    const std::vector<std::vector<int>> &getGraph() const; // Get adjacency matrix
+    int getSizeEdges() const;                              // Get number of edges
+    const Matrix &getGraph() const;                        // Get adjacency matrix (rows in matrix order after reorderVertices)
+    int getGraphID() const;                                // Get unique id of the graph
+    int getHomeNode() const;                               // NUMA node of the matrices
+    uint64_t getContentHash() const;                       // Equal for graphs with the same vertices and edges
+    bool hasSameContent(const BasicGraph &other) const;    // Same vertices, edges and weights (not the MST)
+    void setOwnerID(int id);                               // Set the client that created the graph
+    int getOwnerID() const;                                // Get the client that created the graph
+    void markStored();                                     // Record the time the graph was stored
+    std::chrono::steady_clock::time_point getStoredTime() const;
+    void reorderVertices(VertexOrdering::Method method);   // Relabel the matrix rows for locality - call after the edges are added
+    void setMemoryBudget(GraphMemoryBudget *budget);       // Account the stored graph - it may be spilled from now on
+    size_t getResidentBytes() const override;              // Bytes of the adjacency and MST matrices
+    bool trySpill() override;                              // Write the matrices to the spill file and free them (false if pinned)
 
     // Setter methods for MST
     void activateMSTStrategy();
     void setMSTDataCalculationNextStatus();
+    void resetMSTDataCalculation();                        // Back to no MST data - the metrics job was cancelled midway
+    void reopenMSTDataCalculation();                       // Finished -> no MST data, keeping the computed metrics (a request needs more)
+    void markMetricsComputed(uint32_t metrics);            // MetricRegistry bits computed by a pipeline stage
     void setMSTTotalWeight();
     void setMSTLongestDistance();
     void setMSTShortestDistance();
     void setMSTAvgEdgeWeight();
-    void setMSTStrategy(std::unique_ptr<MSTStrategy> strategy);
+    void setMSTStrategy(std::unique_ptr<Strategy> strategy);
+    void loadMST(const std::vector<Edge> &edges);          // Set an MST computed elsewhere
 
     bool getValidationMSTExist() const;
     int getMSTDataStatusCalculation() const;
-    int getMSTTotalWeight() const;
-    int getMSTLongestDistance() const;
-    int getMSTShortestDistance() const;
+    Sum getMSTTotalWeight() const;
+    Sum getMSTLongestDistance() const;
+    Sum getMSTShortestDistance() const;
     double getMSTAvgEdgeWeight() const;
+    bool hasMSTMetric(MSTMetric metric) const;             // The metric was computed (a client may request only some)
+    uint32_t getComputedMetrics() const;                   // MetricRegistry bits of the computed metrics
+    std::vector<Edge> getEdges() const;                    // Edge list of the graph (original vertex ids)
+    std::vector<Edge> getMSTEdges() const;                 // Edge list of the MST (original vertex ids, empty if none)
+    std::shared_ptr<const PathIndex> getMSTPathIndex() const; // Built once on the first call - query only a computed MST
     std::string printMST() const;
+    static std::string formatMSTEdges(const std::vector<Edge> &edges); // Text of printMST
 };
 
+using Graph = BasicGraph<int>;
+
 #endif
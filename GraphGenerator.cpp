@@ -0,0 +1,413 @@
+#include "GraphGenerator.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#define GENERATOR_MAX_VERTICES 8192      // Adjacency matrix of 256 MiB
+#define GENERATOR_ROWS_PER_THREAD 256    // Smaller graphs use fewer threads
+#define RMAT_BATCH_SIZE 65536            // Samples per R-MAT random stream
+#define RMAT_A 0.57                      // R-MAT quadrant probabilities (Graph500 values)
+#define RMAT_B 0.19
+#define RMAT_C 0.19
+#define POSITION_STREAM_OFFSET 0x9E3779B97F4A7C15ULL // Keeps point streams apart from row streams
+
+namespace
+{
+    uint64_t splitMix64(uint64_t &state)
+    {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // xoshiro256** - small and fast, one independent stream per (seed, stream id)
+    class RandomStream
+    {
+    private:
+        uint64_t state[4];
+
+        static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+
+    public:
+        using result_type = uint64_t;
+
+        RandomStream(uint64_t seed, uint64_t streamID)
+        {
+            uint64_t mix = seed ^ (streamID * 0xD1B54A32D192ED03ULL);
+            for (auto &word : this->state)
+            {
+                word = splitMix64(mix);
+            }
+        }
+
+        static constexpr result_type min() { return 0; }
+        static constexpr result_type max() { return UINT64_MAX; }
+
+        result_type operator()()
+        {
+            uint64_t result = rotl(this->state[1] * 5, 7) * 9;
+            uint64_t t = this->state[1] << 17;
+            this->state[2] ^= this->state[0];
+            this->state[3] ^= this->state[1];
+            this->state[1] ^= this->state[2];
+            this->state[0] ^= this->state[3];
+            this->state[2] ^= t;
+            this->state[3] = rotl(this->state[3], 45);
+            return result;
+        }
+
+        double nextDouble() { return ((*this)() >> 11) * 0x1.0p-53; } // [0, 1)
+    };
+
+    // Draws edge weights of the requested distribution, always in [minWeight, maxWeight]
+    class WeightSampler
+    {
+    private:
+        const GraphGenerator::Parameters &parameters;
+        std::uniform_int_distribution<int> uniform;
+        std::exponential_distribution<double> exponential;
+        std::normal_distribution<double> normal;
+
+    public:
+        WeightSampler(const GraphGenerator::Parameters &parameters)
+            : parameters(parameters), uniform(parameters.minWeight, parameters.maxWeight),
+              exponential(4.0 / std::max(1, parameters.maxWeight - parameters.minWeight)),
+              normal((parameters.minWeight + parameters.maxWeight) / 2.0, std::max(1, parameters.maxWeight - parameters.minWeight) / 6.0) {}
+
+        int operator()(RandomStream &random)
+        {
+            double weight;
+            switch (this->parameters.weights)
+            {
+                case GraphGenerator::Exponential:
+                    weight = this->parameters.minWeight + std::floor(this->exponential(random));
+                    break;
+                case GraphGenerator::Normal:
+                    weight = std::round(this->normal(random));
+                    break;
+                default:
+                    return this->uniform(random);
+            }
+            return static_cast<int>(std::clamp(weight, static_cast<double>(this->parameters.minWeight), static_cast<double>(this->parameters.maxWeight)));
+        }
+    };
+
+    struct Point
+    {
+        double x;
+        double y;
+    };
+
+    struct SampledEdge
+    {
+        int u;
+        int v;
+        int weight;
+    };
+
+    // Run rowTask(row, random) for every row; row u is owned by thread u % numThreads and draws from stream u
+    // Returns the number of new edges reported by the tasks
+    template <typename RowTask>
+    int forEachRow(int numThreads, int numVertices, uint64_t seed, RowTask rowTask)
+    {
+        std::vector<int> newEdges(numThreads, 0);
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                int count = 0;
+                for (int u = t; u < numVertices; u += numThreads)
+                {
+                    RandomStream random(seed, static_cast<uint64_t>(u));
+                    count += rowTask(u, random);
+                }
+                newEdges[t] = count;
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        int total = 0;
+        for (int count : newEdges)
+        {
+            total += count;
+        }
+        return total;
+    }
+
+    void validate(const GraphGenerator::Parameters &parameters)
+    {
+        if (parameters.type < GraphGenerator::ErdosRenyi || parameters.type > GraphGenerator::RMAT)
+        {
+            throw std::invalid_argument("Unknown generator type");
+        }
+        if (parameters.numVertices < 2 || parameters.numVertices > GENERATOR_MAX_VERTICES)
+        {
+            throw std::invalid_argument("Number of vertices must be between 2 and " + std::to_string(GENERATOR_MAX_VERTICES));
+        }
+        if (!(parameters.density > 0.0 && parameters.density <= 1.0))
+        {
+            throw std::invalid_argument("Density must be in (0, 1]");
+        }
+        if (parameters.weights < GraphGenerator::Uniform || parameters.weights > GraphGenerator::Normal)
+        {
+            throw std::invalid_argument("Unknown weight distribution");
+        }
+        if (parameters.minWeight < 1 || parameters.maxWeight < parameters.minWeight)
+        {
+            throw std::invalid_argument("Weights must satisfy 1 <= min <= max");
+        }
+    }
+
+    int erdosRenyi(Graph &graph, const GraphGenerator::Parameters &parameters, int numThreads)
+    {
+        int numVertices = parameters.numVertices;
+        double logSkip = parameters.density < 1.0 ? std::log1p(-parameters.density) : 0.0;
+        return forEachRow(numThreads, numVertices, parameters.seed, [&](int u, RandomStream &random)
+        {
+            WeightSampler weight(parameters);
+            int count = 0;
+            // Geometric skipping - the gap to the next edge of the row is drawn directly
+            for (int v = u + 1; v < numVertices; ++v)
+            {
+                if (parameters.density < 1.0)
+                {
+                    double skip = std::floor(std::log(1.0 - random.nextDouble()) / logSkip);
+                    if (skip >= numVertices - v)
+                    {
+                        break;
+                    }
+                    v += static_cast<int>(skip);
+                }
+                count += graph.setEdgeUnchecked(u, v, weight(random));
+            }
+            return count;
+        });
+    }
+
+    int grid2D(Graph &graph, const GraphGenerator::Parameters &parameters, int numThreads)
+    {
+        int numVertices = parameters.numVertices;
+        int columns = static_cast<int>(std::ceil(std::sqrt(static_cast<double>(numVertices))));
+        return forEachRow(numThreads, numVertices, parameters.seed, [&](int u, RandomStream &random)
+        {
+            WeightSampler weight(parameters);
+            int count = 0;
+            int right = u + 1;
+            int down = u + columns;
+            if (right < numVertices && right % columns != 0 && random.nextDouble() < parameters.density)
+            {
+                count += graph.setEdgeUnchecked(u, right, weight(random));
+            }
+            if (down < numVertices && random.nextDouble() < parameters.density)
+            {
+                count += graph.setEdgeUnchecked(u, down, weight(random));
+            }
+            return count;
+        });
+    }
+
+    int complete(Graph &graph, const GraphGenerator::Parameters &parameters, int numThreads)
+    {
+        int numVertices = parameters.numVertices;
+        return forEachRow(numThreads, numVertices, parameters.seed, [&](int u, RandomStream &random)
+        {
+            WeightSampler weight(parameters);
+            int count = 0;
+            for (int v = u + 1; v < numVertices; ++v)
+            {
+                count += graph.setEdgeUnchecked(u, v, weight(random));
+            }
+            return count;
+        });
+    }
+
+    // Weights grow linearly with the distance between the points (minWeight up to maxWeight at the radius)
+    int randomGeometric(Graph &graph, const GraphGenerator::Parameters &parameters, int numThreads)
+    {
+        int numVertices = parameters.numVertices;
+        std::vector<Point> points(numVertices);
+        forEachRow(numThreads, numVertices, parameters.seed ^ POSITION_STREAM_OFFSET, [&](int u, RandomStream &random)
+        {
+            points[u] = Point{random.nextDouble(), random.nextDouble()};
+            return 0;
+        });
+
+        // Expected fraction of pairs closer than the radius is about pi * radius^2 (ignoring the border)
+        double radius = std::min(std::sqrt(parameters.density / M_PI), std::sqrt(2.0));
+        double radiusSquared = radius * radius;
+        int weightRange = parameters.maxWeight - parameters.minWeight;
+        return forEachRow(numThreads, numVertices, parameters.seed, [&](int u, RandomStream &)
+        {
+            int count = 0;
+            for (int v = u + 1; v < numVertices; ++v)
+            {
+                double dx = points[u].x - points[v].x;
+                double dy = points[u].y - points[v].y;
+                double distanceSquared = dx * dx + dy * dy;
+                if (distanceSquared <= radiusSquared)
+                {
+                    int weight = parameters.minWeight + static_cast<int>(std::lround(weightRange * std::sqrt(distanceSquared) / radius));
+                    count += graph.setEdgeUnchecked(u, v, weight);
+                }
+            }
+            return count;
+        });
+    }
+
+    /*
+        R-MAT: edges are sampled in batches, each batch from its own stream. Samplers bucket every edge
+        by the thread owning its smaller endpoint, then every owner writes its buckets - so no cell is
+        written by two threads. A pair sampled twice keeps the smaller weight, which does not depend on
+        the order the buckets are applied in.
+    */
+    int rmat(Graph &graph, const GraphGenerator::Parameters &parameters, int numThreads)
+    {
+        int numVertices = parameters.numVertices;
+        int64_t numPairs = static_cast<int64_t>(numVertices) * (numVertices - 1) / 2;
+        int64_t numSamples = std::max<int64_t>(1, std::llround(parameters.density * numPairs));
+        int64_t numBatches = (numSamples + RMAT_BATCH_SIZE - 1) / RMAT_BATCH_SIZE;
+        int scale = 0;
+        while ((1 << scale) < numVertices)
+        {
+            ++scale;
+        }
+
+        // buckets[sampler][owner]
+        std::vector<std::vector<std::vector<SampledEdge>>> buckets(numThreads, std::vector<std::vector<SampledEdge>>(numThreads));
+        std::vector<std::thread> threads;
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                WeightSampler weight(parameters);
+                for (int64_t batch = t; batch < numBatches; batch += numThreads)
+                {
+                    RandomStream random(parameters.seed, static_cast<uint64_t>(batch));
+                    int64_t batchEnd = std::min(numSamples, (batch + 1) * RMAT_BATCH_SIZE);
+                    for (int64_t sample = batch * RMAT_BATCH_SIZE; sample < batchEnd; ++sample)
+                    {
+                        int u = 0, v = 0;
+                        for (int level = 0; level < scale; ++level)
+                        {
+                            double r = random.nextDouble();
+                            int row = r >= RMAT_A + RMAT_B ? 1 : 0;
+                            int column = (r >= RMAT_A && r < RMAT_A + RMAT_B) || r >= RMAT_A + RMAT_B + RMAT_C ? 1 : 0;
+                            u = (u << 1) | row;
+                            v = (v << 1) | column;
+                        }
+                        int w = weight(random);
+                        if (u == v || u >= numVertices || v >= numVertices)
+                        {
+                            continue; // Self loops and vertices beyond the power of two are dropped
+                        }
+                        if (u > v)
+                        {
+                            std::swap(u, v);
+                        }
+                        buckets[t][u % numThreads].push_back(SampledEdge{u, v, w});
+                    }
+                }
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        threads.clear();
+
+        const AdjacencyMatrix &matrix = graph.getGraph();
+        std::vector<int> newEdges(numThreads, 0);
+        for (int t = 0; t < numThreads; ++t)
+        {
+            threads.emplace_back([&, t]()
+            {
+                int count = 0;
+                for (int sampler = 0; sampler < numThreads; ++sampler)
+                {
+                    for (const SampledEdge &edge : buckets[sampler][t])
+                    {
+                        int current = matrix[edge.u][edge.v];
+                        if (current == 0 || edge.weight < current)
+                        {
+                            count += graph.setEdgeUnchecked(edge.u, edge.v, edge.weight);
+                        }
+                    }
+                }
+                newEdges[t] = count;
+            });
+        }
+        for (auto &thread : threads)
+        {
+            thread.join();
+        }
+        int total = 0;
+        for (int count : newEdges)
+        {
+            total += count;
+        }
+        return total;
+    }
+}
+
+std::shared_ptr<Graph> GraphGenerator::generate(const Parameters &parameters)
+{
+    validate(parameters);
+    auto graph = std::make_shared<Graph>(parameters.numVertices);
+    TraceSpan span("GraphGenerator::generate", "generator", graph->getGraphID());
+
+    int numThreads = parameters.numThreads > 0 ? parameters.numThreads : static_cast<int>(std::thread::hardware_concurrency());
+    numThreads = std::clamp(numThreads, 1, std::max(1, parameters.numVertices / GENERATOR_ROWS_PER_THREAD));
+
+    int numEdges = 0;
+    switch (parameters.type)
+    {
+        case ErdosRenyi:
+            numEdges = erdosRenyi(*graph, parameters, numThreads);
+            break;
+        case Grid2D:
+            numEdges = grid2D(*graph, parameters, numThreads);
+            break;
+        case Complete:
+            numEdges = complete(*graph, parameters, numThreads);
+            break;
+        case RandomGeometric:
+            numEdges = randomGeometric(*graph, parameters, numThreads);
+            break;
+        case RMAT:
+            numEdges = rmat(*graph, parameters, numThreads);
+            break;
+    }
+    graph->addEdgeCount(numEdges);
+    graph->rehashContent();
+
+    LOG_DEBUG("GraphGenerator: " << typeName(parameters.type) << " graph " << graph->getGraphID() << " with "
+              << parameters.numVertices << " vertices and " << numEdges << " edges (" << numThreads << " threads)");
+    return graph;
+}
+
+std::string GraphGenerator::typeName(GeneratorType type)
+{
+    switch (type)
+    {
+        case ErdosRenyi:
+            return "Erdos-Renyi";
+        case Grid2D:
+            return "2D Grid";
+        case Complete:
+            return "Complete";
+        case RandomGeometric:
+            return "Random Geometric";
+        case RMAT:
+            return "R-MAT";
+    }
+    return "Unknown";
+}
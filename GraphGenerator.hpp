@@ -0,0 +1,51 @@
+#ifndef GRAPHGENERATOR_HPP
+#define GRAPHGENERATOR_HPP
+
+#include <memory>
+#include <cstdint>
+#include <string>
+#include "Graph.hpp"
+
+/*
+    Synthetic graph generators for load and scale testing.
+    Graphs are written directly into the adjacency matrix by several threads. Every vertex pair
+    (u, v) with u < v is owned by exactly one thread (the owner of row u), so threads never write
+    the same cell. Random numbers come from a separate stream per row (or per R-MAT batch)
+    derived from the seed, so the same parameters always produce the same graph.
+*/
+class GraphGenerator
+{
+public:
+    enum GeneratorType
+    {
+        ErdosRenyi = 1,      // Every pair is an edge with probability density
+        Grid2D,              // 2D lattice, every lattice edge kept with probability density
+        Complete,            // Every pair is an edge
+        RandomGeometric,     // Random points in the unit square, edge when closer than the radius for density
+        RMAT                 // Recursive matrix (power-law degrees), density * pairs edges sampled
+    };
+
+    enum WeightDistribution
+    {
+        Uniform = 1,         // Uniform in [minWeight, maxWeight]
+        Exponential,         // Skewed towards minWeight
+        Normal               // Centered between minWeight and maxWeight
+    };
+
+    struct Parameters
+    {
+        GeneratorType type = ErdosRenyi;
+        int numVertices = 0;
+        double density = 0.1;                 // Fraction in (0, 1]
+        uint64_t seed = 1;
+        WeightDistribution weights = Uniform;
+        int minWeight = 1;                    // Weights are at least 1 (0 means no edge)
+        int maxWeight = 100;
+        int numThreads = 0;                   // 0 - hardware concurrency
+    };
+
+    static std::shared_ptr<Graph> generate(const Parameters &parameters); // Throws std::invalid_argument
+    static std::string typeName(GeneratorType type);
+};
+
+#endif
@@ -0,0 +1,157 @@
+#include "GraphHandoff.hpp"
+#include "Tracer.hpp"
+#include <stdexcept>
+#include <string>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define HANDOFF_SEALS (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL)
+
+// Unmaps a memfd mapping when the scope ends
+struct Mapping
+{
+    void *address;
+    size_t size;
+
+    ~Mapping()
+    {
+        if (this->address != MAP_FAILED)
+        {
+            munmap(this->address, this->size);
+        }
+    }
+};
+
+// New memfd of the size, filled by the writer and sealed read-only
+template <typename Writer>
+static int writeSealedMemfd(const char *name, size_t size, Writer writer)
+{
+    int fd = memfd_create(name, MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0)
+    {
+        throw std::runtime_error("memfd_create failed: " + std::string(strerror(errno)));
+    }
+    if (ftruncate(fd, size) < 0)
+    {
+        std::string error = strerror(errno);
+        close(fd);
+        throw std::runtime_error("memfd ftruncate failed: " + error);
+    }
+    {
+        Mapping mapping{mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0), size};
+        if (mapping.address == MAP_FAILED)
+        {
+            std::string error = strerror(errno);
+            close(fd);
+            throw std::runtime_error("memfd mmap failed: " + error);
+        }
+        writer(static_cast<char *>(mapping.address));
+    } // The write seal needs the writable mapping gone
+    fcntl(fd, F_ADD_SEALS, HANDOFF_SEALS);
+    return fd;
+}
+
+std::shared_ptr<Graph> GraphHandoff::readGraph(int memfd)
+{
+    TraceSpan span("readGraph (memfd)", "handoff");
+    // The client must not be able to shrink the memfd under the mapping (SIGBUS)
+    int seals = fcntl(memfd, F_GET_SEALS);
+    struct stat status;
+    if (seals < 0 || !(seals & F_SEAL_SHRINK) || fstat(memfd, &status) < 0)
+    {
+        throw std::invalid_argument("Graph memfd must be a memfd sealed against shrinking");
+    }
+    size_t size = status.st_size;
+    if (size < sizeof(GraphHeader))
+    {
+        throw std::invalid_argument("Graph memfd is smaller than its header");
+    }
+    Mapping mapping{mmap(nullptr, size, PROT_READ, MAP_SHARED | MAP_POPULATE, memfd, 0), size};
+    if (mapping.address == MAP_FAILED)
+    {
+        throw std::invalid_argument("Graph memfd cannot be mapped: " + std::string(strerror(errno)));
+    }
+
+    // Fields are copied before they are checked - the client may still write an unsealed memfd
+    GraphHeader header;
+    memcpy(&header, mapping.address, sizeof(header));
+    if (header.magic != HANDOFF_GRAPH_MAGIC || header.version != HANDOFF_VERSION)
+    {
+        throw std::invalid_argument("Graph memfd has no graph header of version " + std::to_string(HANDOFF_VERSION));
+    }
+    if (header.numVertices == 0 || header.numVertices > HANDOFF_MAX_VERTICES)
+    {
+        throw std::invalid_argument("Number of vertices must be between 1 and " + std::to_string(HANDOFF_MAX_VERTICES));
+    }
+    if (header.numEdges > (size - sizeof(GraphHeader)) / sizeof(Edge))
+    {
+        throw std::invalid_argument("Graph memfd is smaller than its edges");
+    }
+
+    auto graph = std::make_shared<Graph>(header.numVertices);
+    span.setGraphID(graph->getGraphID());
+    const Edge *edges = reinterpret_cast<const Edge *>(static_cast<const char *>(mapping.address) + sizeof(GraphHeader));
+    int newEdges = 0;
+    for (uint64_t i = 0; i < header.numEdges; ++i)
+    {
+        Edge edge = edges[i];
+        if (edge.u >= header.numVertices || edge.v >= header.numVertices || edge.u == edge.v || edge.weight <= 0)
+        {
+            throw std::invalid_argument("Invalid edge " + std::to_string(i) + " (vertices in range, no loops, positive weight)");
+        }
+        if (graph->setEdgeUnchecked(edge.u, edge.v, edge.weight))
+        {
+            newEdges++;
+        }
+    }
+    graph->addEdgeCount(newEdges);
+    graph->rehashContent();
+    return graph;
+}
+
+int GraphHandoff::writeResult(const Graph &graph)
+{
+    std::vector<WeightedEdge> mstEdges = graph.getMSTEdges();
+    size_t size = sizeof(ResultHeader) + mstEdges.size() * sizeof(Edge);
+    return writeSealedMemfd("mst-result", size, [&graph, &mstEdges](char *memory)
+    {
+        ResultHeader header{};
+        header.magic = HANDOFF_RESULT_MAGIC;
+        header.version = HANDOFF_VERSION;
+        header.graphID = graph.getGraphID();
+        header.numMSTEdges = mstEdges.size();
+        header.mstTotalWeight = graph.getMSTTotalWeight();
+        header.mstLongestDistance = graph.getMSTLongestDistance();
+        header.mstShortestDistance = graph.getMSTShortestDistance();
+        header.mstAvgEdgeWeight = graph.getMSTAvgEdgeWeight();
+        memcpy(memory, &header, sizeof(header));
+        Edge *edges = reinterpret_cast<Edge *>(memory + sizeof(ResultHeader));
+        for (size_t i = 0; i < mstEdges.size(); ++i)
+        {
+            edges[i] = {static_cast<uint32_t>(mstEdges[i].u), static_cast<uint32_t>(mstEdges[i].v), mstEdges[i].weight};
+        }
+    });
+}
+
+int GraphHandoff::writeGraph(int numVertices, const std::vector<WeightedEdge> &edgeList)
+{
+    size_t size = sizeof(GraphHeader) + edgeList.size() * sizeof(Edge);
+    return writeSealedMemfd("mst-graph", size, [numVertices, &edgeList](char *memory)
+    {
+        GraphHeader header{};
+        header.magic = HANDOFF_GRAPH_MAGIC;
+        header.version = HANDOFF_VERSION;
+        header.numVertices = numVertices;
+        header.numEdges = edgeList.size();
+        memcpy(memory, &header, sizeof(header));
+        Edge *edges = reinterpret_cast<Edge *>(memory + sizeof(GraphHeader));
+        for (size_t i = 0; i < edgeList.size(); ++i)
+        {
+            edges[i] = {static_cast<uint32_t>(edgeList[i].u), static_cast<uint32_t>(edgeList[i].v), edgeList[i].weight};
+        }
+    });
+}
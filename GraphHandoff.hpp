@@ -0,0 +1,90 @@
+#ifndef GRAPHHANDOFF_HPP
+#define GRAPHHANDOFF_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "Graph.hpp"
+
+#define HANDOFF_GRAPH_MAGIC 0x4753544d    // "MSTG" - graph memfd
+#define HANDOFF_RESULT_MAGIC 0x5253544d   // "MSTR" - result memfd
+#define HANDOFF_REQUEST_MAGIC 0x5153544d  // "MSTQ" - request / response messages
+#define HANDOFF_VERSION 2
+#define HANDOFF_MAX_VERTICES 8192         // The adjacency matrix of the graph is V x V
+
+/*
+    Binary graph handoff for local clients over the AF_UNIX listener.
+    The client writes a graph into a memfd (GraphHeader followed by the edges), sends a Request
+    with the memfd attached (SCM_RIGHTS) and receives a Response with a sealed result memfd
+    attached (ResultHeader followed by the MST edges). No edge crosses the socket and nothing is
+    parsed from text; the server reads the graph straight from the mapping of the memfd.
+    All fields are host byte order - the client runs on the same machine.
+*/
+class GraphHandoff
+{
+public:
+    struct GraphHeader
+    {
+        uint32_t magic;        // HANDOFF_GRAPH_MAGIC
+        uint32_t version;      // HANDOFF_VERSION
+        uint32_t numVertices;
+        uint32_t reserved;
+        uint64_t numEdges;     // Edges following the header
+    };
+
+    struct Edge
+    {
+        uint32_t u;
+        uint32_t v;
+        int32_t weight;        // Positive
+    };
+
+    struct ResultHeader
+    {
+        uint32_t magic;        // HANDOFF_RESULT_MAGIC
+        uint32_t version;
+        int32_t graphID;
+        uint32_t numMSTEdges;  // Edges following the header
+        int64_t mstTotalWeight;  // Sums of int32 weights - 64 bits like Graph::Sum
+        int64_t mstLongestDistance;
+        int64_t mstShortestDistance;
+        double mstAvgEdgeWeight;
+    };
+
+    enum Algorithm : uint32_t
+    {
+        Prim = 1,
+        Kruskal = 2,
+        Auto = 3          // Chosen by the server's cost model
+    };
+
+    enum Status : int32_t
+    {
+        Ok = 0,
+        InvalidRequest,   // Bad message, missing or malformed memfd
+        ServerBusy,       // The MST executor shed the request
+        NoMST             // The graph is not connected
+    };
+
+    struct Request
+    {
+        uint32_t magic;        // HANDOFF_REQUEST_MAGIC
+        uint32_t version;
+        uint32_t algorithm;    // Algorithm
+        uint32_t reserved;
+    };
+
+    struct Response
+    {
+        uint32_t magic;        // HANDOFF_REQUEST_MAGIC
+        int32_t status;        // Status - a result memfd is attached only if Ok
+        int32_t graphID;
+        uint32_t reserved;
+    };
+
+    static std::shared_ptr<Graph> readGraph(int memfd);                 // Throws std::invalid_argument
+    static int writeResult(const Graph &graph);                         // Sealed memfd with the MST and its data, throws std::runtime_error
+    static int writeGraph(int numVertices, const std::vector<WeightedEdge> &edges); // Client side - memfd in the graph layout
+};
+
+#endif
@@ -0,0 +1,128 @@
+#include "GraphMemoryBudget.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+
+#define BYTES_PER_MB (1024.0 * 1024.0)
+
+GraphMemoryBudget::GraphMemoryBudget(size_t budgetBytes, const std::string &spillDirectory)
+    : budgetBytes(budgetBytes), spillDirectory(spillDirectory), residentBytes(0), peakResidentBytes(0), spills(0), pageIns(0)
+{
+    LOG_INFO("Graph memory budget " << budgetBytes / BYTES_PER_MB << " MB, spilling to " << spillDirectory);
+}
+
+void GraphMemoryBudget::add(SpillableGraph &graph, int graphID, int numVertices, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    if (this->entries.count(&graph) != 0)
+    {
+        return; // Stored again as a shared copy
+    }
+    this->lru.push_front({&graph, graphID, numVertices, bytes, 0, true});
+    this->entries[&graph] = this->lru.begin();
+    this->residentBytes += this->lru.front().bytes;
+    this->peakResidentBytes = std::max(this->peakResidentBytes, this->residentBytes);
+    evict(&graph);
+}
+
+void GraphMemoryBudget::remove(const SpillableGraph &graph)
+{
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    auto entry = this->entries.find(&graph);
+    if (entry == this->entries.end())
+    {
+        return;
+    }
+    if (entry->second->resident)
+    {
+        this->residentBytes -= entry->second->bytes;
+    }
+    this->residentBytes -= entry->second->indexBytes;
+    this->lru.erase(entry->second);
+    this->entries.erase(entry);
+}
+
+void GraphMemoryBudget::touch(const SpillableGraph &graph, bool pagedIn)
+{
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    auto entry = this->entries.find(&graph);
+    if (entry == this->entries.end())
+    {
+        return; // Not stored yet
+    }
+    this->lru.splice(this->lru.begin(), this->lru, entry->second);
+    if (pagedIn && !entry->second->resident)
+    {
+        entry->second->resident = true;
+        this->residentBytes += entry->second->bytes;
+        this->peakResidentBytes = std::max(this->peakResidentBytes, this->residentBytes);
+        this->pageIns++;
+        evict(&graph);
+    }
+}
+
+void GraphMemoryBudget::addIndexBytes(const SpillableGraph &graph, size_t bytes)
+{
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    auto entry = this->entries.find(&graph);
+    if (entry == this->entries.end())
+    {
+        return; // Not stored (or already removed)
+    }
+    entry->second->indexBytes += bytes;
+    this->residentBytes += bytes;
+    this->peakResidentBytes = std::max(this->peakResidentBytes, this->residentBytes);
+    evict(&graph);
+}
+
+// Least recently used first - a graph in use is skipped, so the budget may be exceeded while all graphs are busy
+void GraphMemoryBudget::evict(const SpillableGraph *keep)
+{
+    if (this->budgetBytes == 0)
+    {
+        return;
+    }
+    for (auto entry = this->lru.rbegin(); entry != this->lru.rend() && this->residentBytes > this->budgetBytes; ++entry)
+    {
+        if (!entry->resident || entry->graph == keep)
+        {
+            continue;
+        }
+        if (entry->graph->trySpill())
+        {
+            entry->resident = false;
+            this->residentBytes -= entry->bytes;
+            this->spills++;
+            LOG_DEBUG("Graph " << entry->graphID << " spilled (" << entry->bytes << " bytes)");
+        }
+    }
+}
+
+std::string GraphMemoryBudget::spillPath(int graphID) const
+{
+    return this->spillDirectory + "/mst-graph-" + std::to_string(getpid()) + "-" + std::to_string(graphID) + ".spill";
+}
+
+std::string GraphMemoryBudget::getStatistics() const
+{
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    std::ostringstream report;
+    report << "Graph Memory: " << this->residentBytes / BYTES_PER_MB << " MB resident of " << this->budgetBytes / BYTES_PER_MB
+           << " MB budget | Peak " << this->peakResidentBytes / BYTES_PER_MB << " MB | Graphs " << this->lru.size()
+           << " | Spills " << this->spills << " | Page-ins " << this->pageIns << "\n";
+    return report.str();
+}
+
+std::string GraphMemoryBudget::memoryReport() const
+{
+    std::string report = getStatistics();
+    std::lock_guard<std::mutex> lock(this->mtx_budget);
+    for (const Entry &entry : this->lru) // Most recently used first
+    {
+        report += "Graph " + std::to_string(entry.graphID) + " | V " + std::to_string(entry.numVertices) + " | " +
+                  std::to_string(entry.bytes) + " bytes | " + (entry.resident ? "resident" : "spilled") +
+                  (entry.indexBytes > 0 ? " | path index " + std::to_string(entry.indexBytes) + " bytes" : "") + "\n";
+    }
+    return report;
+}
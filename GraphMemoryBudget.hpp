@@ -0,0 +1,69 @@
+#ifndef GRAPHMEMORYBUDGET_HPP
+#define GRAPHMEMORYBUDGET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+// A stored graph whose matrices can be written to a spill file and dropped from memory
+class SpillableGraph
+{
+public:
+    virtual ~SpillableGraph() = default;
+    virtual size_t getResidentBytes() const = 0; // Bytes of the matrices while they are in memory (takes the graph's lock)
+    virtual bool trySpill() = 0;                 // False if the graph is in use (pinned) or the file cannot be written
+};
+
+/*
+    Memory budget of the stored graphs.
+    Every stored graph is kept in a least recently used list with its matrix bytes. When the
+    resident bytes exceed the budget the least recently used graphs that are not in use are
+    spilled to a file in the spill directory. A spilled graph is read back by the first access
+    (the graph pins itself and calls touch()), which may spill other graphs in turn.
+    Graphs are only try-locked while the budget mutex is held, so a graph paging itself in
+    never waits for the budget and the budget never waits for a busy graph - a graph reads its
+    own byte count under its lock and passes it in.
+    The MST path index of a graph is built on the first path query, stays in memory while the
+    matrices are spilled and is counted as resident bytes that cannot be spilled.
+*/
+class GraphMemoryBudget
+{
+private:
+    struct Entry
+    {
+        SpillableGraph *graph;
+        int graphID;
+        int numVertices;
+        size_t bytes;          // Matrix bytes when resident
+        size_t indexBytes;     // Path index bytes - resident even while the matrices are spilled
+        bool resident;
+    };
+
+    size_t budgetBytes;                                            // Resident bytes allowed (0 - unlimited)
+    std::string spillDirectory;                                    // Directory of the spill files
+    mutable std::mutex mtx_budget;                                 // Guards all the fields below
+    std::list<Entry> lru;                                          // Most recently used first
+    std::unordered_map<const SpillableGraph *, std::list<Entry>::iterator> entries;
+    size_t residentBytes;                                          // Sum of the bytes of the resident graphs
+    size_t peakResidentBytes;                                      // Highest resident bytes seen
+    uint64_t spills;                                               // Graphs written out
+    uint64_t pageIns;                                              // Graphs read back
+
+    void evict(const SpillableGraph *keep); // Spill from the back until within the budget - caller holds mtx_budget
+
+public:
+    GraphMemoryBudget(size_t budgetBytes, const std::string &spillDirectory);
+
+    void add(SpillableGraph &graph, int graphID, int numVertices, size_t bytes); // A graph was stored - bytes of its resident matrices
+    void addIndexBytes(const SpillableGraph &graph, size_t bytes);  // The path index of the graph was built
+    void remove(const SpillableGraph &graph);                      // The graph is destroyed
+    void touch(const SpillableGraph &graph, bool pagedIn);         // The graph was accessed - pagedIn if it was read back
+    std::string spillPath(int graphID) const;                      // Spill file of a graph
+    std::string getStatistics() const;                             // Summary line of the budget
+    std::string memoryReport() const;                              // Memory of every stored graph
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef GRAPHTASK_HPP
+#define GRAPHTASK_HPP
+
+#include <memory>
+#include <chrono>
+#include <atomic>
+#include <cstdint>
+#include "Graph.hpp"
+#include "CancellationToken.hpp"
+
+// Join of the parallel branches of a pipeline task - the last branch to arrive continues
+struct BranchJoin
+{
+    std::atomic<int> pending;          // Branches not at the join yet
+    std::atomic<bool> dropped{false};  // A branch was cancelled or failed - the task ends at the join
+
+    explicit BranchJoin(int branches) : pending(branches) {}
+};
+
+// Entry of the Active-Object and Leader-Follower task queues
+struct GraphTask
+{
+    std::weak_ptr<Graph> graph;                           // Graph to process
+    std::chrono::steady_clock::time_point enqueueTime;    // When the task entered the queue
+    int graphID = -1;                                     // Id of the graph (trace key)
+    double cost = 0.0;                                    // Estimated work (scheduling)
+    int clientID = -1;                                    // Owner of the graph (fair scheduling)
+    int numaNode = -1;                                    // Node holding the graph's matrices (-1 if unknown)
+    std::shared_ptr<const CancellationToken> cancellation; // Drops the task when cancelled (nullptr - never)
+    uint32_t metrics = ~0u;                               // Pipeline metrics requested (bit i - MetricRegistry id i)
+    std::shared_ptr<BranchJoin> join;                     // Pipeline branches of the task (nullptr - not forked)
+
+    GraphTask() = default;
+    GraphTask(std::weak_ptr<Graph> wptr_graph, int id)
+        : graph(std::move(wptr_graph)), enqueueTime(std::chrono::steady_clock::now()), graphID(id) {}
+};
+
+#endif
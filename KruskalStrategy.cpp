@@ -1,13 +1,16 @@
 #include "KruskalStrategy.hpp"
+#include "CancellationToken.hpp"
+#include "EdgeArrays.hpp"
 
 // Helper function to perform DFS to check for cycles
-bool KruskalStrategy::hasCycle(int current, int parent, const std::vector<std::vector<int>> &adj, std::vector<bool> &visited)
+template <typename Weight, typename NoEdge>
+bool BasicKruskalStrategy<Weight, NoEdge>::hasCycle(int current, int parent, const Matrix &adj, std::pmr::vector<bool> &visited)
 {
     visited[current] = true;
     int numVer = adj.size(); // Number of vertices in the graph
     for (int neighbor = 0; neighbor < numVer; ++neighbor)
     {
-        if (adj[current][neighbor] != 0)
+        if (NoEdge::isEdge(adj[current][neighbor]))
         {
             if (!visited[neighbor])
             {
@@ -23,49 +26,51 @@ bool KruskalStrategy::hasCycle(int current, int parent, const std::vector<std::v
     return false;
 }
 
-std::unique_ptr<std::vector<std::vector<int>>> KruskalStrategy::computeMST(const std::vector<std::vector<int>> &graphAdjacencyMatrix)
+template <typename Weight, typename NoEdge>
+std::unique_ptr<BasicAdjacencyMatrix<Weight>> BasicKruskalStrategy<Weight, NoEdge>::computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource)
 {
-    {
-        std::lock_guard<std::mutex> cout_lock(cout_mtx);
-        std::cout << "Strategy Activated - Start Compute MST using Kruskal" << std::endl;
-    }
+    LOG_DEBUG("Strategy Activated - Start Compute MST using Kruskal");
     int numVertices = graphAdjacencyMatrix.size();
-    std::vector<std::tuple<int, int, int>> edges; // (weight, src, dest) To keep track of included edges for sorting and processing
+    ScratchArena::Scope scratch; // Working buffers are reused by this thread across requests
+    BasicEdgeArrays<Weight> edges(scratch.resource()); // Weights, sources and destinations of the candidate edges
 
     // Collect all edges from the adjacency matrix
     for (int i = 0; i < numVertices; i++)
     {
+        CancellationToken::checkpoint();
         for (int j = i + 1; j < numVertices; j++)
         {
-            if (graphAdjacencyMatrix[i][j] > 0)
+            if (NoEdge::isEdge(graphAdjacencyMatrix[i][j]))
             {
-                edges.emplace_back(graphAdjacencyMatrix[i][j], i, j);
+                edges.push(graphAdjacencyMatrix[i][j], i, j);
             }
         }
     }
 
-    auto mstMatrix = std::make_unique<std::vector<std::vector<int>>>(
-        numVertices, std::vector<int>(numVertices, 0));
+    auto mstMatrix = std::make_unique<Matrix>(
+        numVertices, std::pmr::vector<Weight>(numVertices, NoEdge::noEdge), resultResource);
+    std::pmr::vector<bool> visited(numVertices, false, scratch.resource()); // One DFS buffer for all edges
 
-    std::sort(edges.begin(), edges.end()); // Sort edges by their weights
+    edges.sortByWeight(); // Stable radix sort - ties stay in (src, dest) order, as with the tuple sort
     int edgesAdded = 0;
 
     // Kruskal's algorithm - Adding edges to the MST, checking for cycles
-    for (const auto &eg : edges)
+    for (size_t e = 0; e < edges.size(); ++e)
     {
-        int weight = std::get<0>(eg);
-        int u = std::get<1>(eg);
-        int v = std::get<2>(eg);
+        CancellationToken::checkpoint(); // Every edge costs a matrix DFS
+        Weight weight = edges.weights[e];
+        int u = edges.sources[e];
+        int v = edges.destinations[e];
         (*mstMatrix)[v][u] = weight;
         (*mstMatrix)[u][v] = weight;
 
         // Check for a cycle using DFS
-        std::vector<bool> visited(numVertices, false);
+        std::fill(visited.begin(), visited.end(), false);
         if (hasCycle(u, -1, *mstMatrix, visited))
         {
             // If adding this edge creates a cycle, remove it
-            (*mstMatrix)[u][v] = 0;
-            (*mstMatrix)[v][u] = 0;
+            (*mstMatrix)[u][v] = NoEdge::noEdge;
+            (*mstMatrix)[v][u] = NoEdge::noEdge;
         }
         else
         {
@@ -75,10 +80,9 @@ std::unique_ptr<std::vector<std::vector<int>>> KruskalStrategy::computeMST(const
                 break; // Stop when enough edges have been added
         }
     }
-    {
-        std::lock_guard<std::mutex> cout_lock(cout_mtx);
-        std::cout << "Finish Compute MST using Kruskal" << std::endl;
-    }
+    LOG_DEBUG("Finish Compute MST using Kruskal");
     // Reference of the MST adjacency matrix
     return mstMatrix;
 }
+
+INSTANTIATE_WEIGHT_POLICIES(BasicKruskalStrategy)
@@ -7,12 +7,18 @@
 #include <algorithm>
 #include <memory>
 
-class KruskalStrategy : public MSTStrategy
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicKruskalStrategy : public BasicMSTStrategy<Weight, NoEdge>
 {
 public:
-    std::unique_ptr<std::vector<std::vector<int>>> computeMST(const std::vector<std::vector<int>> &graphAdjacencyMatrix) override;
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+
+    std::unique_ptr<Matrix> computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource) override;
 
 private:
-    bool hasCycle(int current, int parent, const std::vector<std::vector<int>> &adj, std::vector<bool> &visited);
+    bool hasCycle(int current, int parent, const Matrix &adj, std::pmr::vector<bool> &visited);
 };
+
+using KruskalStrategy = BasicKruskalStrategy<int>;
+
 #endif
@@ -0,0 +1,232 @@
+#include "LatencyHistogram.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+
+#define MIN_SIGNIFICANT_DIGITS 1
+#define MAX_SIGNIFICANT_DIGITS 5
+
+LatencyHistogram::LatencyHistogram(int64_t highestTrackable, int significantDigits)
+    : highestTrackableValue(highestTrackable), minValue(INT64_MAX)
+{
+    if (highestTrackable < 2 || significantDigits < MIN_SIGNIFICANT_DIGITS || significantDigits > MAX_SIGNIFICANT_DIGITS)
+    {
+        throw std::invalid_argument("Invalid histogram range or precision");
+    }
+
+    // Smallest power of two that keeps single unit resolution for the requested significant digits
+    int64_t largestValueWithSingleUnitResolution = 2 * static_cast<int64_t>(std::pow(10, significantDigits));
+    int subBucketCountMagnitude = static_cast<int>(std::ceil(std::log2(static_cast<double>(largestValueWithSingleUnitResolution))));
+    this->subBucketHalfCountMagnitude = subBucketCountMagnitude - 1;
+    this->subBucketHalfCount = int64_t(1) << this->subBucketHalfCountMagnitude;
+    this->subBucketMask = (int64_t(1) << subBucketCountMagnitude) - 1;
+
+    // Number of log buckets needed to cover the highest trackable value
+    int64_t smallestUntrackableValue = int64_t(1) << subBucketCountMagnitude;
+    this->bucketCount = 1;
+    while (smallestUntrackableValue <= highestTrackable)
+    {
+        if (smallestUntrackableValue > (INT64_MAX >> 1))
+        {
+            this->bucketCount++;
+            break;
+        }
+        smallestUntrackableValue <<= 1;
+        this->bucketCount++;
+    }
+
+    this->countsLength = static_cast<int>((this->bucketCount + 1) * this->subBucketHalfCount);
+    this->counts.reset(new std::atomic<uint64_t>[this->countsLength]()); // Value initialized (zero)
+}
+
+int LatencyHistogram::countsIndexFor(int64_t value) const
+{
+    int leadingZeroCountBase = 64 - this->subBucketHalfCountMagnitude - 1;
+    int bucketIndex = leadingZeroCountBase - __builtin_clzll(static_cast<uint64_t>(value | this->subBucketMask));
+    int64_t subBucketIndex = value >> bucketIndex;
+    return static_cast<int>(((bucketIndex + 1) << this->subBucketHalfCountMagnitude) + (subBucketIndex - this->subBucketHalfCount));
+}
+
+int64_t LatencyHistogram::valueFromIndex(int index) const
+{
+    int bucketIndex = (index >> this->subBucketHalfCountMagnitude) - 1;
+    int64_t subBucketIndex = (index & (this->subBucketHalfCount - 1)) + this->subBucketHalfCount;
+    if (bucketIndex < 0)
+    {
+        subBucketIndex -= this->subBucketHalfCount;
+        bucketIndex = 0;
+    }
+    return subBucketIndex << bucketIndex;
+}
+
+int64_t LatencyHistogram::highestEquivalentValue(int index) const
+{
+    int bucketIndex = (index >> this->subBucketHalfCountMagnitude) - 1;
+    if (bucketIndex < 0)
+    {
+        bucketIndex = 0;
+    }
+    return this->valueFromIndex(index) + (int64_t(1) << bucketIndex) - 1;
+}
+
+// Record a value - only the owner thread may record, readers may run concurrently
+void LatencyHistogram::recordValue(int64_t value)
+{
+    if (value < 0)
+    {
+        value = 0;
+    }
+    else if (value > this->highestTrackableValue)
+    {
+        value = this->highestTrackableValue;
+    }
+
+    std::atomic<uint64_t> &counter = this->counts[this->countsIndexFor(value)];
+    counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    this->sumValues.store(this->sumValues.load(std::memory_order_relaxed) + static_cast<double>(value), std::memory_order_relaxed);
+    if (value < this->minValue.load(std::memory_order_relaxed))
+    {
+        this->minValue.store(value, std::memory_order_relaxed);
+    }
+    if (value > this->maxValue.load(std::memory_order_relaxed))
+    {
+        this->maxValue.store(value, std::memory_order_relaxed);
+    }
+    this->totalCount.store(this->totalCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+// Merge another histogram into this one
+void LatencyHistogram::add(const LatencyHistogram &other)
+{
+    if (other.countsLength != this->countsLength || other.subBucketHalfCountMagnitude != this->subBucketHalfCountMagnitude)
+    {
+        throw std::invalid_argument("Histogram layouts do not match");
+    }
+
+    for (int i = 0; i < this->countsLength; ++i)
+    {
+        uint64_t otherCount = other.counts[i].load(std::memory_order_relaxed);
+        if (otherCount != 0)
+        {
+            this->counts[i].store(this->counts[i].load(std::memory_order_relaxed) + otherCount, std::memory_order_relaxed);
+        }
+    }
+    this->sumValues.store(this->sumValues.load(std::memory_order_relaxed) + other.sumValues.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    if (other.getTotalCount() > 0)
+    {
+        this->minValue.store(std::min(this->minValue.load(std::memory_order_relaxed), other.minValue.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+        this->maxValue.store(std::max(this->maxValue.load(std::memory_order_relaxed), other.maxValue.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+    }
+    this->totalCount.store(this->totalCount.load(std::memory_order_relaxed) + other.getTotalCount(), std::memory_order_release);
+}
+
+void LatencyHistogram::reset()
+{
+    for (int i = 0; i < this->countsLength; ++i)
+    {
+        this->counts[i].store(0, std::memory_order_relaxed);
+    }
+    this->sumValues.store(0.0, std::memory_order_relaxed);
+    this->minValue.store(INT64_MAX, std::memory_order_relaxed);
+    this->maxValue.store(0, std::memory_order_relaxed);
+    this->totalCount.store(0, std::memory_order_release);
+}
+
+/*  Getters */
+
+uint64_t LatencyHistogram::getTotalCount() const
+{
+    return this->totalCount.load(std::memory_order_acquire);
+}
+
+int64_t LatencyHistogram::getMin() const
+{
+    return this->getTotalCount() == 0 ? 0 : this->minValue.load(std::memory_order_relaxed);
+}
+
+int64_t LatencyHistogram::getMax() const
+{
+    return this->maxValue.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::getMean() const
+{
+    uint64_t total = this->getTotalCount();
+    return total == 0 ? 0.0 : this->sumValues.load(std::memory_order_relaxed) / static_cast<double>(total);
+}
+
+int64_t LatencyHistogram::getValueAtPercentile(double percentile) const
+{
+    // Sum the counters on the fly so a concurrent writer never yields an out of range target
+    uint64_t total = 0;
+    for (int i = 0; i < this->countsLength; ++i)
+    {
+        total += this->counts[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0)
+    {
+        return 0;
+    }
+
+    percentile = std::min(std::max(percentile, 0.0), 100.0);
+    uint64_t countAtPercentile = static_cast<uint64_t>(std::ceil((percentile / 100.0) * static_cast<double>(total)));
+    countAtPercentile = std::max<uint64_t>(countAtPercentile, 1);
+
+    uint64_t runningCount = 0;
+    for (int i = 0; i < this->countsLength; ++i)
+    {
+        runningCount += this->counts[i].load(std::memory_order_relaxed);
+        if (runningCount >= countAtPercentile)
+        {
+            return std::min(this->highestEquivalentValue(i), this->getMax());
+        }
+    }
+    return this->getMax();
+}
+
+void LatencyHistogram::outputPercentileDistribution(std::ostream &out, double scale, int ticksPerHalfDistance) const
+{
+    uint64_t total = this->getTotalCount();
+    out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " "
+        << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+    out << std::fixed;
+
+    double percentile = 0.0;
+    while (total > 0)
+    {
+        int64_t value = this->getValueAtPercentile(percentile);
+
+        // Count of all values equivalent to or lower than the reported value
+        uint64_t countAtValue = 0;
+        for (int i = 0; i < this->countsLength && this->valueFromIndex(i) <= value; ++i)
+        {
+            countAtValue += this->counts[i].load(std::memory_order_relaxed);
+        }
+
+        if (countAtValue >= total || percentile >= 100.0)
+        {
+            break;
+        }
+        out << std::setprecision(3) << std::setw(12) << value / scale << " "
+            << std::setprecision(12) << std::setw(14) << percentile / 100.0 << " "
+            << std::setw(10) << countAtValue << " "
+            << std::setprecision(2) << std::setw(14) << 1.0 / (1.0 - percentile / 100.0) << "\n";
+
+        // Halve the remaining distance to 100% every ticksPerHalfDistance steps
+        double halfDistance = std::pow(2.0, std::floor(std::log2(100.0 / (100.0 - percentile))) + 1.0);
+        percentile += 100.0 / (ticksPerHalfDistance * halfDistance);
+    }
+    out << std::setprecision(3) << std::setw(12) << this->getMax() / scale << " "
+        << std::setprecision(12) << std::setw(14) << 1.0 << " "
+        << std::setw(10) << total << "\n";
+
+    out << std::setprecision(3)
+        << "#[Mean    = " << std::setw(12) << this->getMean() / scale
+        << ", Max            = " << std::setw(12) << this->getMax() / scale << "]\n"
+        << "#[Min     = " << std::setw(12) << this->getMin() / scale
+        << ", Total count    = " << std::setw(12) << total << "]\n"
+        << "#[Buckets = " << std::setw(12) << this->bucketCount
+        << ", SubBuckets     = " << std::setw(12) << (this->subBucketHalfCount << 1) << "]\n";
+    out.unsetf(std::ios_base::floatfield);
+}
@@ -0,0 +1,55 @@
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+/*
+    HDR (High Dynamic Range) style histogram with a fixed number of significant digits.
+    Values are bucketed log-linearly, so the relative error of every recorded value is bounded
+    (0.1% for 3 significant digits) from 1 unit up to the highest trackable value.
+
+    Counters are atomics written by a single thread (the owner) with relaxed load/store,
+    so other threads can read a snapshot at any time without locking the writer.
+*/
+class LatencyHistogram
+{
+private:
+    int64_t highestTrackableValue;                 // Values above are clamped to this value
+    int subBucketHalfCountMagnitude;               // log2 of half the sub bucket count
+    int64_t subBucketHalfCount;                    // Half the number of linear sub buckets in a bucket
+    int64_t subBucketMask;                         // Mask of the values that fit in the first bucket
+    int bucketCount;                               // Number of log buckets
+    int countsLength;                              // Number of counters
+    std::unique_ptr<std::atomic<uint64_t>[]> counts; // Counters array
+    std::atomic<uint64_t> totalCount{0};           // Number of recorded values
+    std::atomic<int64_t> minValue;                 // Lowest recorded value
+    std::atomic<int64_t> maxValue{0};              // Highest recorded value
+    std::atomic<double> sumValues{0.0};            // Sum of recorded values (for the mean)
+
+    int countsIndexFor(int64_t value) const;       // Index of the counter of a value
+    int64_t valueFromIndex(int index) const;       // Lowest value that maps to a counter
+    int64_t highestEquivalentValue(int index) const; // Highest value that maps to a counter
+
+public:
+    LatencyHistogram(int64_t highestTrackable, int significantDigits = 3);
+    LatencyHistogram(const LatencyHistogram &) = delete;
+    LatencyHistogram &operator=(const LatencyHistogram &) = delete;
+
+    void recordValue(int64_t value);                     // Record a value (single writer)
+    void add(const LatencyHistogram &other);             // Merge a histogram with the same layout (single writer)
+    void reset();                                        // Clear all counters (single writer)
+
+    uint64_t getTotalCount() const;                      // Number of recorded values
+    int64_t getMin() const;                              // Lowest recorded value (0 if empty)
+    int64_t getMax() const;                              // Highest recorded value
+    double getMean() const;                              // Mean of recorded values
+    int64_t getValueAtPercentile(double percentile) const; // Value at a percentile (0 - 100)
+
+    // Percentile distribution in the HdrHistogram text (.hgrm) format, values divided by scale
+    void outputPercentileDistribution(std::ostream &out, double scale, int ticksPerHalfDistance = 5) const;
+};
+
+#endif
@@ -5,38 +5,35 @@
 #define FINISH_PROCESS 1
 
 // Constructor
-LeaderFollower::LeaderFollower() : stop(false)
+LeaderFollower::LeaderFollower(TaskScheduler::Policy policy, double sjfSlowdown)
+    : queue_taskData(policy, sjfSlowdown), stop(false), queueStatistics("Leader-Follower Queue (" + TaskScheduler::policyName(policy) + ")")
 {
 
     std::lock_guard<std::mutex> lock(this->mtx_lf);
-    std::cout << "Starting Leader Follower Design Pattern" << std::endl;
+    LOG_INFO("Starting Leader Follower Design Pattern (" << TaskScheduler::policyName(policy) << " scheduling)");
     for (int i = 0; i < this->numThreads.load(); i++)
     {
-        this->threadsPool.push(std::make_unique<std::thread>(&LeaderFollower::work, this));
+        this->workerStatistics.push_back(std::make_unique<StageStatistics>("Leader-Follower Worker " + std::to_string(i)));
     }
-    std::cout << "Leader-Follower: Threads Created and Added to Pool." << std::endl;
+    for (int i = 0; i < this->numThreads.load(); i++)
+    {
+        this->threadsPool.push(std::make_unique<std::thread>(&LeaderFollower::work, this, i));
+    }
+    LOG_DEBUG("Leader-Follower: Threads Created and Added to Pool.");
 }
 
 
 // Destructor
 LeaderFollower::~LeaderFollower()
 {
+    LOG_INFO("********* START Leader-Follower Stop Process *********");
     {
         std::lock_guard<std::mutex> lock(this->mtx_lf);
-        std::cout << "\n********* START Leader-Follower Stop Process *********" << std::endl;
         this->stop = true;
+        this->queue_taskData.clear();
     }
 
-    while (!this->queue_taskData.empty())
-    {
-        std::lock_guard<std::mutex> lock(this->mtx_lf);
-        this->queue_taskData.pop();
-    }
-
-    {
-        std::lock_guard<std::mutex> lock(this->mtx_lf);
-        std::cout << "\nLeader-Follower: Task Queue is Empty" << std::endl;
-    }
+    LOG_DEBUG("Leader-Follower: Task Queue is Empty");
     this->cv_lf.notify_all(); // Notify all threads to exit
 
     while (!this->threadsPool.empty())
@@ -48,28 +45,39 @@ LeaderFollower::~LeaderFollower()
         }
         this->threadsPool.pop();
     }
-    std::lock_guard<std::mutex> lock(this->mtx_lf);
-    std::cout << "\nLeader-Follower: Threads Pool is Clean and Threads Joined" << std::endl;
-    std::cout << "\n********* FINISH Leader-Follower Stop Process *********" << std::endl;
+    LOG_DEBUG("Leader-Follower: Threads Pool is Clean and Threads Joined");
+    LOG_INFO("********* FINISH Leader-Follower Stop Process *********");
 }
 
 // Function that Recive data from the server to process
-void LeaderFollower::processGraphs(std::vector<std::weak_ptr<Graph>>& graphs)
+void LeaderFollower::processGraphs(std::vector<std::weak_ptr<Graph>>& graphs, std::shared_ptr<const CancellationToken> cancellation)
 {
     {
         std::lock_guard<std::mutex> lock(this->mtx_lf);
         for (const auto& graph : graphs)
         {
-            this->queue_taskData.push(graph);
+            auto sharedGraph = graph.lock();
+            GraphTask task(graph, sharedGraph ? sharedGraph->getGraphID() : TRACE_NO_GRAPH);
+            task.cancellation = cancellation;
+            if (sharedGraph)
+            {
+                task.cost = TaskScheduler::estimateCost(*sharedGraph);
+                task.clientID = sharedGraph->getOwnerID();
+                task.numaNode = sharedGraph->getHomeNode();
+            }
+            this->queue_taskData.push(std::move(task));
+            this->queueStatistics.recordEnqueue(this->queue_taskData.size());
         }
-        std::cout << "Leader-Follower: Graphs Added to Task Queue." << std::endl;
     }
+    LOG_DEBUG("Leader-Follower: Graphs Added to Task Queue.");
     promoteFollower();
 }
 
 // Start the conversation with the client
-void LeaderFollower::work() 
+void LeaderFollower::work(int workerIndex) 
 {
+    Tracer::setThreadName("Leader-Follower Worker " + std::to_string(workerIndex));
+    int workerNode = NumaTopology::getInstance().pinCurrentThread(workerIndex);
     while (!this->stop) 
     {
         {
@@ -83,44 +91,80 @@ void LeaderFollower::work()
         } 
         else 
         {
-            executeTask();
+            executeTask(workerIndex, workerNode);
             promoteFollower();
         }
     }
 }
 
-void LeaderFollower::executeTask() 
+void LeaderFollower::executeTask(int workerIndex, int workerNode) 
 {
+    StageStatistics &statistics = *this->workerStatistics[workerIndex];
     std::shared_ptr<Graph> currentGraph;
+    int graphID = TRACE_NO_GRAPH;
+    std::chrono::steady_clock::time_point enqueueTime;
+    std::shared_ptr<const CancellationToken> cancellation;
     {
         std::lock_guard<std::mutex> lock(this->mtx_lf);
         if (this->queue_taskData.empty()) return;
         /* 
+            Take the next task of the scheduling policy
             If the graph is valid  (return value of lock is not NULL) 
                 Do:
-                Set currenGraph, pop and continue to execute 
+                Set currenGraph and continue to execute 
                 Else:
-                just pop from the queue and return
+                just return
         */
-        if (auto graph = this->queue_taskData.front().lock()) 
+        GraphTask task = this->queue_taskData.pop(workerNode);
+        this->queueStatistics.recordDequeue(this->queue_taskData.size());
+        if (workerNode >= 0)
+        {
+            (task.numaNode == workerNode ? this->nodeLocalTasks : this->nodeRemoteTasks).fetch_add(1, std::memory_order_relaxed);
+        }
+        if (auto graph = task.graph.lock()) 
         {
             currentGraph = graph;
-            this->queue_taskData.pop();
+            graphID = task.graphID;
+            enqueueTime = task.enqueueTime;
+            cancellation = std::move(task.cancellation);
+            statistics.recordWait(enqueueTime);
         } 
         else 
         {
-            this->queue_taskData.pop();
             return;
         }
     }
 
     // Process the graph
-    currentGraph->setMSTDataCalculationNextStatus();
-    currentGraph->setMSTTotalWeight();
-    currentGraph->setMSTLongestDistance();
-    currentGraph->setMSTShortestDistance();
-    currentGraph->setMSTAvgEdgeWeight();
-    currentGraph->setMSTDataCalculationNextStatus();
+    auto executionStart = std::chrono::steady_clock::now();
+    Tracer::getInstance().recordAsync("Leader-Follower queue wait", "queue", graphID, enqueueTime, executionStart);
+    TraceSpan span("executeTask", "leader-follower", graphID);
+    try
+    {
+        if (cancellation != nullptr && cancellation->isCancelled())
+        {
+            throw JobCancelled(cancellation->reason());
+        }
+        CancellationToken::Scope cancellationScope(cancellation.get());
+        currentGraph->setMSTDataCalculationNextStatus();
+        currentGraph->setMSTTotalWeight();
+        currentGraph->setMSTLongestDistance();
+        currentGraph->setMSTShortestDistance();
+        currentGraph->setMSTAvgEdgeWeight();
+        currentGraph->setMSTDataCalculationNextStatus();
+        statistics.recordExecution(std::chrono::steady_clock::now() - executionStart, true);
+    }
+    catch (const JobCancelled &e)
+    {
+        statistics.recordCancelled();
+        currentGraph->resetMSTDataCalculation(); // Processed again by the next request
+        LOG_DEBUG("Leader-Follower: graph " << graphID << " dropped - " << e.what());
+    }
+    catch (const std::exception &e)
+    {
+        statistics.recordExecution(std::chrono::steady_clock::now() - executionStart, false);
+        LOG_ERROR("Leader-Follower: Error - Execute task: " << e.what());
+    }
 }
 
 void LeaderFollower::promoteFollower() 
@@ -155,4 +199,18 @@ void LeaderFollower::setLeader(std::thread::id id)
 {
     std::lock_guard<std::mutex> lock(this->mtx_lf);
     currentLeader.store(id);
-}
\ No newline at end of file
+}
+std::string LeaderFollower::getStatistics() const
+{
+    std::string report = this->queueStatistics.report();
+    if (NumaTopology::getInstance().getPlacement() != NumaTopology::Off)
+    {
+        report += "Leader-Follower NUMA: " + std::to_string(this->nodeLocalTasks.load(std::memory_order_relaxed)) + " node-local | " +
+                  std::to_string(this->nodeRemoteTasks.load(std::memory_order_relaxed)) + " remote graphs\n";
+    }
+    for (const auto &statistics : this->workerStatistics)
+    {
+        report += statistics->report();
+    }
+    return report;
+}
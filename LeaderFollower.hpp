@@ -10,31 +10,44 @@
 #include <condition_variable>
 #include <atomic>
 #include <map>
+#include <string>
 #include "Graph.hpp"
+#include "Logger.hpp"
+#include "GraphTask.hpp"
+#include "TaskScheduler.hpp"
+#include "StageStatistics.hpp"
+#include "Tracer.hpp"
+#include "NumaTopology.hpp"
 
 class LeaderFollower
 {
 private:
-    std::queue<std::weak_ptr<Graph>> queue_taskData;       // Task queue for the active object
+    TaskScheduler queue_taskData;                          // Task queue - ordered by the scheduling policy
     std::queue<std::unique_ptr<std::thread>> threadsPool;  // Queue to manage thread pool and order of promotion to leader
     std::mutex mtx_lf;                                     // Mutex for the threads
     std::condition_variable cv_lf;                         // Condition variable for the threads
     std::atomic<int> const numThreads{4};                  // Number of threads
     std::atomic<bool> stop{false};                         // Flag to stop the threads
     std::atomic<std::thread::id> currentLeader{};  // Track current leader thread
+    StageStatistics queueStatistics;                                  // Statistics of the shared task queue
+    std::vector<std::unique_ptr<StageStatistics>> workerStatistics;   // Statistics of each worker thread
+    std::atomic<uint64_t> nodeLocalTasks{0};                          // Graphs processed on the node holding them (pinned workers)
+    std::atomic<uint64_t> nodeRemoteTasks{0};                         // Graphs processed from another node (pinned workers)
     
     // Private methods
-    void work();            // Enqueues tasks
-    void executeTask();     // Executes tasks
+    void work(int workerIndex);        // Enqueues tasks
+    void executeTask(int workerIndex, int workerNode); // Executes tasks - prefers graphs of the worker's NUMA node
     void promoteFollower(); // Promotes a follower to leader
 
 public:
-    LeaderFollower();
+    LeaderFollower(TaskScheduler::Policy policy = TaskScheduler::FIFO, double sjfSlowdown = 10.0);
     ~LeaderFollower();
 
-    void processGraphs(std::vector<std::weak_ptr<Graph>> &graphs); // Process the graphs that sended from the server
+    // Process the graphs that sended from the server - a cancelled token drops them before or during their metrics
+    void processGraphs(std::vector<std::weak_ptr<Graph>> &graphs, std::shared_ptr<const CancellationToken> cancellation = nullptr);
     void setLeader(std::thread::id id); // Set the leader thread
     bool isLeader(); // Check if the current thread is the leader
+    std::string getStatistics() const; // Statistics summary of the queue and the workers
 };
 
 #endif
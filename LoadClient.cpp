@@ -0,0 +1,361 @@
+#include "LoadClient.hpp"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <sstream>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+#define INVALID -1
+#define MENU_PROMPT "0. Exit\n\nChoice: "
+#define HISTOGRAM_MAX_MICROS 600000000LL // 10 minutes
+#define RECEIVE_TIMEOUT_SECONDS 60
+#define CONNECT_RETRIES 50
+#define MICROS_PER_MILLI 1000.0
+
+LoadClient::LoadClient(const Config &config) : config(config)
+{
+    for (int i = 0; i < this->config.connections; ++i)
+    {
+        auto result = std::make_unique<ConnectionResult>();
+        for (auto &histogram : result->histograms)
+        {
+            histogram = std::make_unique<LatencyHistogram>(HISTOGRAM_MAX_MICROS);
+        }
+        this->results.push_back(std::move(result));
+    }
+}
+
+const char *LoadClient::operationName(int op)
+{
+    switch (op)
+    {
+    case CreateGraph:
+        return "create";
+    case SubmitPipeline:
+        return "pipeline";
+    case SubmitLeaderFollower:
+        return "leader-follower";
+    case QueryResults:
+        return "query";
+    default:
+        return "unknown";
+    }
+}
+
+// Start all connections, wait for the run to end and print the report
+void LoadClient::run()
+{
+    std::cout << "Load Client: " << this->config.connections << " connections, "
+              << this->config.ratePerConnection << " ops/s per connection, "
+              << this->config.durationSeconds << " s" << std::endl;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < this->config.connections; ++i)
+    {
+        threads.emplace_back(&LoadClient::runConnection, this, i);
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    report(std::chrono::steady_clock::now() - start);
+}
+
+int LoadClient::connectToServer()
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(this->config.port);
+    if (inet_pton(AF_INET, this->config.host.c_str(), &address.sin_addr) <= 0)
+    {
+        std::cerr << "Load Client: Invalid address " << this->config.host << std::endl;
+        return INVALID;
+    }
+
+    // The server listens with a short backlog - retry while it catches up with the burst
+    for (int attempt = 0; attempt < CONNECT_RETRIES; ++attempt)
+    {
+        int fd = socket(AF_INET, SOCK_STREAM, 0);
+        if (fd < 0)
+        {
+            perror("socket failed");
+            return INVALID;
+        }
+        if (connect(fd, (struct sockaddr *)&address, sizeof(address)) == 0)
+        {
+            struct timeval timeout;
+            timeout.tv_sec = RECEIVE_TIMEOUT_SECONDS;
+            timeout.tv_usec = 0;
+            setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+            return fd;
+        }
+        close(fd);
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    return INVALID;
+}
+
+// Read from the server until the token shows up (the prompt of the next input)
+bool LoadClient::waitFor(int fd, const std::string &token)
+{
+    std::string window; // Tail of the received data, long enough to hold the token
+    char buffer[4096];
+    while (true)
+    {
+        ssize_t bytes = read(fd, buffer, sizeof(buffer));
+        if (bytes <= 0)
+        {
+            return false;
+        }
+        window.append(buffer, bytes);
+        if (window.find(token) != std::string::npos)
+        {
+            return true;
+        }
+        if (window.size() > token.size())
+        {
+            window.erase(0, window.size() - token.size());
+        }
+    }
+}
+
+bool LoadClient::sendLine(int fd, const std::string &line)
+{
+    std::string message = line + "\n";
+    return send(fd, message.c_str(), message.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(message.size());
+}
+
+// Menu option 1 - a random connected graph: a random spanning tree plus random extra edges
+bool LoadClient::createGraph(int fd, std::mt19937 &rng)
+{
+    int numVertices = this->config.vertices;
+    long long maxEdges = static_cast<long long>(numVertices) * (numVertices - 1) / 2; // Simple graph
+    int numEdges = static_cast<int>(std::min<long long>(std::max(this->config.edges, numVertices - 1), maxEdges));
+    std::uniform_int_distribution<int> weightDist(1, this->config.maxWeight);
+    std::uniform_int_distribution<int> vertexDist(0, numVertices - 1);
+
+    if (!sendLine(fd, "1") || !waitFor(fd, "vertices: ") || !sendLine(fd, std::to_string(numVertices)) ||
+        !waitFor(fd, "edges: ") || !sendLine(fd, std::to_string(numEdges)))
+    {
+        return false;
+    }
+
+    std::set<std::pair<int, int>> usedEdges; // (smaller, larger) - no self-loops or repeated edges reach the server
+    for (int i = 0; i < numEdges; ++i)
+    {
+        int src, dest;
+        if (i < numVertices - 1)
+        {
+            src = i + 1;
+            dest = std::uniform_int_distribution<int>(0, i)(rng);
+        }
+        else
+        {
+            do
+            {
+                src = vertexDist(rng);
+                dest = vertexDist(rng);
+            } while (src == dest || usedEdges.count({std::min(src, dest), std::max(src, dest)}));
+        }
+        usedEdges.insert({std::min(src, dest), std::max(src, dest)});
+        if (!waitFor(fd, "From: ") || !sendLine(fd, std::to_string(src)) ||
+            !waitFor(fd, "To: ") || !sendLine(fd, std::to_string(dest)) ||
+            !waitFor(fd, "Weight: ") || !sendLine(fd, std::to_string(weightDist(rng))))
+        {
+            return false;
+        }
+    }
+
+    int algorithm = std::uniform_int_distribution<int>(1, 2)(rng); // 1 - Prim, 2 - Kruskal
+    return waitFor(fd, "Choice: ") && sendLine(fd, std::to_string(algorithm)) && waitFor(fd, MENU_PROMPT);
+}
+
+bool LoadClient::executeOperation(int fd, Operation op, std::mt19937 &rng)
+{
+    switch (op)
+    {
+    case CreateGraph:
+        return createGraph(fd, rng);
+    case SubmitPipeline:
+        return sendLine(fd, "2") && waitFor(fd, MENU_PROMPT);
+    case SubmitLeaderFollower:
+        return sendLine(fd, "3") && waitFor(fd, MENU_PROMPT);
+    case QueryResults:
+        return sendLine(fd, "4") && waitFor(fd, MENU_PROMPT);
+    default:
+        return false;
+    }
+}
+
+// Connection thread - open loop schedule, operations are issued at Poisson arrival times
+void LoadClient::runConnection(int index)
+{
+    ConnectionResult &result = *this->results[index];
+    std::mt19937 rng(this->config.seed + index);
+    std::discrete_distribution<int> opDist(this->config.mix.begin(), this->config.mix.end());
+    std::exponential_distribution<double> interArrival(this->config.ratePerConnection > 0 ? this->config.ratePerConnection : 1.0);
+
+    int fd = connectToServer();
+    if (fd < 0 || !waitFor(fd, MENU_PROMPT))
+    {
+        this->failedConnections++;
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        return;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto end = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(this->config.durationSeconds));
+    auto intendedStart = start;
+
+    while (intendedStart < end)
+    {
+        std::this_thread::sleep_until(intendedStart);
+        Operation op = static_cast<Operation>(opDist(rng));
+        bool success = executeOperation(fd, op, rng);
+        auto finish = std::chrono::steady_clock::now();
+
+        if (!success)
+        {
+            result.errors[op]++;
+            break; // The dialog state is unknown after a failure
+        }
+        result.histograms[op]->recordValue(std::chrono::duration_cast<std::chrono::microseconds>(finish - intendedStart).count());
+
+        if (this->config.ratePerConnection > 0)
+        {
+            intendedStart += std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interArrival(rng)));
+        }
+        else
+        {
+            intendedStart = finish; // Closed loop
+        }
+    }
+
+    sendLine(fd, "0"); // Exit the menu
+    close(fd);
+}
+
+void LoadClient::report(std::chrono::duration<double> elapsed)
+{
+    std::cout << "\n********* Load Client Report *********" << std::endl;
+    std::cout << "Elapsed: " << std::fixed << std::setprecision(2) << elapsed.count() << " s";
+    if (this->failedConnections > 0)
+    {
+        std::cout << " | Failed connections: " << this->failedConnections;
+    }
+    std::cout << "\n\n";
+    std::cout << std::left << std::setw(16) << "Operation" << std::right
+              << std::setw(10) << "Count" << std::setw(8) << "Errors" << std::setw(12) << "Ops/s"
+              << std::setw(12) << "Mean(ms)" << std::setw(12) << "p50(ms)" << std::setw(12) << "p99(ms)"
+              << std::setw(12) << "p999(ms)" << std::setw(12) << "Max(ms)" << std::endl;
+
+    for (int op = 0; op < NUM_OPERATIONS; ++op)
+    {
+        LatencyHistogram merged(HISTOGRAM_MAX_MICROS);
+        uint64_t errors = 0;
+        for (const auto &result : this->results)
+        {
+            merged.add(*result->histograms[op]);
+            errors += result->errors[op];
+        }
+
+        std::cout << std::left << std::setw(16) << operationName(op) << std::right
+                  << std::setw(10) << merged.getTotalCount() << std::setw(8) << errors
+                  << std::setw(12) << merged.getTotalCount() / elapsed.count()
+                  << std::setw(12) << merged.getMean() / MICROS_PER_MILLI
+                  << std::setw(12) << merged.getValueAtPercentile(50.0) / MICROS_PER_MILLI
+                  << std::setw(12) << merged.getValueAtPercentile(99.0) / MICROS_PER_MILLI
+                  << std::setw(12) << merged.getValueAtPercentile(99.9) / MICROS_PER_MILLI
+                  << std::setw(12) << merged.getMax() / MICROS_PER_MILLI << std::endl;
+
+        if (!this->config.hgrmPrefix.empty() && merged.getTotalCount() > 0)
+        {
+            std::ofstream file(this->config.hgrmPrefix + "_" + operationName(op) + ".hgrm");
+            merged.outputPercentileDistribution(file, MICROS_PER_MILLI);
+        }
+    }
+}
+
+static void printUsage(const char *program)
+{
+    std::cout << "Usage: " << program << " [options]\n"
+              << "  --host=ADDR          Server address (default 127.0.0.1)\n"
+              << "  --port=N             Server port (default 4040)\n"
+              << "  --connections=N      Concurrent connections (default 4)\n"
+              << "  --rate=R             Arrivals per second per connection, 0 = closed loop (default 10)\n"
+              << "  --duration=S         Run length in seconds (default 10)\n"
+              << "  --mix=C:P:L:Q        Weights of create:pipeline:leader-follower:query (default 4:1:1:2)\n"
+              << "  --vertices=N         Vertices per created graph (default 20)\n"
+              << "  --edges=N            Edges per created graph (default 40)\n"
+              << "  --max-weight=N       Maximum edge weight (default 100)\n"
+              << "  --seed=N             Base random seed (default 1)\n"
+              << "  --hgrm=PREFIX        Write HDR percentile distributions to PREFIX_<operation>.hgrm\n";
+}
+
+int main(int argc, char *argv[])
+{
+    LoadClient::Config config;
+    try
+    {
+        for (int i = 1; i < argc; ++i)
+        {
+            std::string arg = argv[i];
+            size_t separator = arg.find('=');
+            std::string key = arg.substr(0, separator);
+            std::string value = separator == std::string::npos ? "" : arg.substr(separator + 1);
+
+            if (key == "--host") config.host = value;
+            else if (key == "--port") config.port = std::stoi(value);
+            else if (key == "--connections") config.connections = std::stoi(value);
+            else if (key == "--rate") config.ratePerConnection = std::stod(value);
+            else if (key == "--duration") config.durationSeconds = std::stod(value);
+            else if (key == "--vertices") config.vertices = std::stoi(value);
+            else if (key == "--edges") config.edges = std::stoi(value);
+            else if (key == "--max-weight") config.maxWeight = std::stoi(value);
+            else if (key == "--seed") config.seed = std::stoul(value);
+            else if (key == "--hgrm") config.hgrmPrefix = value;
+            else if (key == "--mix")
+            {
+                std::stringstream mix(value);
+                std::string weight;
+                for (int op = 0; op < NUM_OPERATIONS && std::getline(mix, weight, ':'); ++op)
+                {
+                    config.mix[op] = std::stoi(weight);
+                }
+            }
+            else
+            {
+                printUsage(argv[0]);
+                return key == "--help" ? 0 : 1;
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    bool badMix = std::all_of(config.mix.begin(), config.mix.end(), [](int weight) { return weight == 0; }) ||
+                  std::any_of(config.mix.begin(), config.mix.end(), [](int weight) { return weight < 0; });
+    if (config.connections <= 0 || config.vertices <= 1 || config.maxWeight <= 0 || config.durationSeconds <= 0 || badMix)
+    {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    LoadClient client(config);
+    client.run();
+    return 0;
+}
@@ -0,0 +1,77 @@
+#ifndef LOADCLIENT_HPP
+#define LOADCLIENT_HPP
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <array>
+#include <thread>
+#include <atomic>
+#include <memory>
+#include <random>
+#include <chrono>
+#include "LatencyHistogram.hpp"
+
+#define NUM_OPERATIONS 4
+
+/*
+    Load generator for the graph server.
+    Opens N concurrent connections and drives the text menu protocol with an open-loop
+    (Poisson) arrival schedule per connection. Latency is measured from the intended start
+    time of each operation, so time spent waiting behind a slow operation is not hidden
+    (no coordinated omission).
+*/
+class LoadClient
+{
+public:
+    enum Operation
+    {
+        CreateGraph,
+        SubmitPipeline,
+        SubmitLeaderFollower,
+        QueryResults
+    };
+
+    struct Config
+    {
+        std::string host = "127.0.0.1";                  // Server address
+        int port = 4040;                                 // Server port
+        int connections = 4;                             // Number of concurrent connections
+        double ratePerConnection = 10.0;                 // Arrivals per second per connection (0 = closed loop)
+        double durationSeconds = 10.0;                   // Length of the run
+        std::array<int, NUM_OPERATIONS> mix{{4, 1, 1, 2}}; // Relative weights: create:pipeline:lf:query
+        int vertices = 20;                               // Vertices per created graph
+        int edges = 40;                                  // Edges per created graph
+        int maxWeight = 100;                             // Edge weights are drawn from [1, maxWeight]
+        unsigned int seed = 1;                           // Base seed, connection i uses seed + i
+        std::string hgrmPrefix;                          // Write <prefix>_<operation>.hgrm files if set
+    };
+
+private:
+    // Per connection results - each connection thread is the single writer of its histograms
+    struct ConnectionResult
+    {
+        std::array<std::unique_ptr<LatencyHistogram>, NUM_OPERATIONS> histograms;
+        std::array<uint64_t, NUM_OPERATIONS> errors{};
+    };
+
+    Config config;
+    std::vector<std::unique_ptr<ConnectionResult>> results; // One result set per connection
+    std::atomic<int> failedConnections{0};                  // Connections that could not be established
+
+    void runConnection(int index);  // Connection thread body
+    int connectToServer();          // Open a socket to the server (-1 on failure)
+    bool waitFor(int fd, const std::string &token);          // Read until the token arrives
+    bool sendLine(int fd, const std::string &line);          // Send one input line
+    bool executeOperation(int fd, Operation op, std::mt19937 &rng); // Run one menu operation
+    bool createGraph(int fd, std::mt19937 &rng);             // Menu option 1 dialog
+    void report(std::chrono::duration<double> elapsed);     // Merge and print the results
+
+public:
+    LoadClient(const Config &config);
+    void run(); // Run the load and print the report
+
+    static const char *operationName(int op);
+};
+
+#endif
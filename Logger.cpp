@@ -0,0 +1,383 @@
+#include "Logger.hpp"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <strings.h>
+#include <functional>
+#include <unistd.h>
+
+#define WRITER_POLL_INTERVAL_MS 2
+#define RING_MASK (LOG_RING_CAPACITY - 1)
+#define RECORD_HEADER_SIZE offsetof(Logger::LogRecord, text)
+
+static_assert((LOG_RING_CAPACITY & RING_MASK) == 0, "LOG_RING_CAPACITY must be a power of two");
+
+// Format a record as one output line
+static void formatRecord(const Logger::LogRecord &record, std::string &out)
+{
+    time_t seconds = static_cast<time_t>(record.timestampNs / 1000000000LL);
+    long micros = static_cast<long>((record.timestampNs % 1000000000LL) / 1000);
+    struct tm timeInfo;
+    localtime_r(&seconds, &timeInfo);
+
+    char prefix[64];
+    int prefixLength = snprintf(prefix, sizeof(prefix), "[%02d:%02d:%02d.%06ld] [%-5s] [T%llu] ",
+                                timeInfo.tm_hour, timeInfo.tm_min, timeInfo.tm_sec, micros,
+                                Logger::levelName(record.level), static_cast<unsigned long long>(record.threadTag));
+    out.append(prefix, prefixLength);
+    out.append(record.text, record.length);
+    out.push_back('\n');
+}
+
+static int64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+static void writeAll(int fd, const std::string &data)
+{
+    size_t written = 0;
+    while (written < data.size())
+    {
+        ssize_t bytes = write(fd, data.data() + written, data.size() - written);
+        if (bytes <= 0)
+        {
+            return;
+        }
+        written += bytes;
+    }
+}
+
+Logger::Logger()
+{
+    this->running = true;
+    this->writerThread = std::make_unique<std::thread>(&Logger::work, this);
+}
+
+Logger::~Logger()
+{
+    shutdown();
+}
+
+Logger &Logger::getInstance()
+{
+    static Logger instance;
+    return instance;
+}
+
+const char *Logger::levelName(int level)
+{
+    switch (level)
+    {
+    case LOG_LEVEL_DEBUG:
+        return "DEBUG";
+    case LOG_LEVEL_INFO:
+        return "INFO";
+    case LOG_LEVEL_WARN:
+        return "WARN";
+    case LOG_LEVEL_ERROR:
+        return "ERROR";
+    default:
+        return "OFF";
+    }
+}
+
+int Logger::parseLevel(const std::string &name)
+{
+    for (int level = LOG_LEVEL_DEBUG; level <= LOG_LEVEL_OFF; ++level)
+    {
+        if (strcasecmp(name.c_str(), levelName(level)) == 0)
+        {
+            return level;
+        }
+    }
+    return -1;
+}
+
+bool Logger::isEnabled(int level) const
+{
+    return level >= this->runtimeLevel.load(std::memory_order_relaxed);
+}
+
+void Logger::setLevel(int level)
+{
+    this->runtimeLevel.store(level, std::memory_order_relaxed);
+}
+
+int Logger::getLevel() const
+{
+    return this->runtimeLevel.load(std::memory_order_relaxed);
+}
+
+// Ring of the calling thread - registered once per thread, the registry lock is not taken again
+Logger::ThreadBuffer &Logger::localBuffer()
+{
+    static std::atomic<uint64_t> nextThreadTag{0};
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadTag = nextThreadTag++;
+        std::lock_guard<std::mutex> lock(this->mtx_registry);
+        this->buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Logger::submit(LogRecord &record)
+{
+    // The count and the running check pair with shutdown(): either this record sees the writer gone,
+    // or shutdown() waits for the push and drains it
+    this->activeProducers.fetch_add(1, std::memory_order_seq_cst);
+    if (!this->running.load(std::memory_order_seq_cst))
+    {
+        this->activeProducers.fetch_sub(1, std::memory_order_release);
+        // Writer is gone (shutdown) - write synchronously
+        static std::mutex mtx_fallback;
+        std::string line;
+        record.threadTag = 0;
+        formatRecord(record, line);
+        std::lock_guard<std::mutex> lock(mtx_fallback);
+        writeAll(record.level >= LOG_LEVEL_WARN ? STDERR_FILENO : STDOUT_FILENO, line);
+        return;
+    }
+
+    ThreadBuffer &buffer = localBuffer();
+    record.threadTag = buffer.threadTag;
+    uint64_t head = buffer.head.load(std::memory_order_relaxed);
+    if (head - buffer.tail.load(std::memory_order_acquire) >= LOG_RING_CAPACITY)
+    {
+        buffer.dropped.fetch_add(1, std::memory_order_relaxed); // Never block the producer
+    }
+    else
+    {
+        memcpy(&buffer.records[head & RING_MASK], &record, RECORD_HEADER_SIZE + record.length);
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+    this->activeProducers.fetch_sub(1, std::memory_order_release);
+}
+
+// Drain every ring once, order by time and write - returns the number of records written
+size_t Logger::drain()
+{
+    std::vector<std::shared_ptr<ThreadBuffer>> snapshot;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_registry);
+        // Release the rings of threads that exited and were fully drained
+        this->buffers.erase(std::remove_if(this->buffers.begin(), this->buffers.end(), [](const std::shared_ptr<ThreadBuffer> &buffer)
+                                           { return buffer.use_count() == 1 && buffer->head.load(std::memory_order_acquire) == buffer->tail.load(std::memory_order_relaxed); }),
+                            this->buffers.end());
+        snapshot = this->buffers;
+    }
+
+    std::vector<LogRecord> records;
+    for (auto &buffer : snapshot)
+    {
+        uint64_t tail = buffer->tail.load(std::memory_order_relaxed);
+        uint64_t head = buffer->head.load(std::memory_order_acquire);
+        for (; tail < head; ++tail)
+        {
+            records.push_back(buffer->records[tail & RING_MASK]);
+        }
+        buffer->tail.store(tail, std::memory_order_release);
+
+        uint64_t dropped = buffer->dropped.exchange(0, std::memory_order_relaxed);
+        if (dropped > 0)
+        {
+            LogRecord notice;
+            notice.timestampNs = nowNs();
+            notice.threadTag = buffer->threadTag;
+            notice.level = LOG_LEVEL_WARN;
+            notice.length = snprintf(notice.text, sizeof(notice.text), "Logger: %llu records dropped (ring buffer full)",
+                                     static_cast<unsigned long long>(dropped));
+            records.push_back(notice);
+        }
+    }
+    if (records.empty())
+    {
+        return 0;
+    }
+
+    std::stable_sort(records.begin(), records.end(), [](const LogRecord &a, const LogRecord &b)
+                     { return a.timestampNs < b.timestampNs; });
+    std::string out;
+    std::string err;
+    for (const auto &record : records)
+    {
+        formatRecord(record, record.level >= LOG_LEVEL_WARN ? err : out);
+    }
+    writeAll(STDOUT_FILENO, out);
+    writeAll(STDERR_FILENO, err);
+    return records.size();
+}
+
+// Writer thread - drain, serve flush requests, sleep
+void Logger::work()
+{
+    while (true)
+    {
+        bool stopping = this->stop.load(std::memory_order_acquire);
+        uint64_t requests = this->flushRequests.load(std::memory_order_acquire);
+        drain();
+        if (requests != this->flushesDone.load(std::memory_order_relaxed))
+        {
+            std::lock_guard<std::mutex> lock(this->mtx_writer);
+            this->flushesDone.store(requests, std::memory_order_release);
+            this->cv_writer.notify_all();
+        }
+        if (stopping)
+        {
+            return;
+        }
+
+        std::unique_lock<std::mutex> lock(this->mtx_writer);
+        this->cv_writer.wait_for(lock, std::chrono::milliseconds(WRITER_POLL_INTERVAL_MS), [this]
+                                 { return this->stop.load() || this->flushRequests.load() != this->flushesDone.load(); });
+    }
+}
+
+void Logger::flush()
+{
+    if (!this->running.load(std::memory_order_acquire))
+    {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(this->mtx_writer);
+    uint64_t request = ++this->flushRequests;
+    this->cv_writer.notify_all();
+    this->cv_writer.wait(lock, [this, request]
+                         { return this->flushesDone.load() >= request || !this->running.load(); });
+}
+
+void Logger::shutdown()
+{
+    if (!this->running.exchange(false, std::memory_order_seq_cst))
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_writer);
+        this->stop = true;
+        this->cv_writer.notify_all();
+    }
+    if (this->writerThread && this->writerThread->joinable())
+    {
+        this->writerThread->join();
+    }
+    this->writerThread.reset();
+
+    // Producers that passed the running check before it was cleared may still be pushing
+    while (this->activeProducers.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+    drain();
+}
+
+/*  LogLine */
+
+LogLine::LogLine(int level)
+{
+    this->record.timestampNs = nowNs();
+    this->record.threadTag = 0;
+    this->record.level = static_cast<uint8_t>(level);
+    this->record.length = 0;
+}
+
+LogLine::~LogLine()
+{
+    Logger::getInstance().submit(this->record);
+}
+
+void LogLine::append(const char *text, size_t length)
+{
+    size_t space = LOG_MESSAGE_CAPACITY - this->record.length;
+    length = std::min(length, space);
+    memcpy(this->record.text + this->record.length, text, length);
+    this->record.length += length;
+}
+
+LogLine &LogLine::operator<<(const char *text)
+{
+    append(text, strlen(text));
+    return *this;
+}
+
+LogLine &LogLine::operator<<(const std::string &text)
+{
+    append(text.data(), text.size());
+    return *this;
+}
+
+LogLine &LogLine::operator<<(char value)
+{
+    append(&value, 1);
+    return *this;
+}
+
+LogLine &LogLine::operator<<(bool value)
+{
+    return *this << (value ? '1' : '0');
+}
+
+LogLine &LogLine::operator<<(signed char value)
+{
+    return *this << static_cast<long long>(value);
+}
+
+LogLine &LogLine::operator<<(unsigned char value)
+{
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine &LogLine::operator<<(int value)
+{
+    return *this << static_cast<long long>(value);
+}
+
+LogLine &LogLine::operator<<(long value)
+{
+    return *this << static_cast<long long>(value);
+}
+
+LogLine &LogLine::operator<<(long long value)
+{
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(digits, result.ptr - digits);
+    return *this;
+}
+
+LogLine &LogLine::operator<<(unsigned int value)
+{
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine &LogLine::operator<<(unsigned long value)
+{
+    return *this << static_cast<unsigned long long>(value);
+}
+
+LogLine &LogLine::operator<<(unsigned long long value)
+{
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(digits, result.ptr - digits);
+    return *this;
+}
+
+LogLine &LogLine::operator<<(double value)
+{
+    char digits[32];
+    int length = snprintf(digits, sizeof(digits), "%g", value);
+    append(digits, std::min<size_t>(length, sizeof(digits) - 1));
+    return *this;
+}
+
+LogLine &LogLine::operator<<(std::thread::id id)
+{
+    return *this << static_cast<unsigned long long>(std::hash<std::thread::id>{}(id));
+}
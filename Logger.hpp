@@ -0,0 +1,149 @@
+#ifndef LOGGER_HPP
+#define LOGGER_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <string>
+#include <thread>
+#include <vector>
+#include <cstdint>
+
+#define LOG_LEVEL_DEBUG 0
+#define LOG_LEVEL_INFO 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_ERROR 3
+#define LOG_LEVEL_OFF 4
+
+// Lowest level compiled into the binary - build with -DLOG_COMPILE_LEVEL=1 to strip the debug logs
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL LOG_LEVEL_DEBUG
+#endif
+
+#define LOG_MESSAGE_CAPACITY 232 // Longer messages are truncated
+#define LOG_RING_CAPACITY 256    // Records per thread ring buffer (power of two)
+
+/*
+    Asynchronous logger.
+    Every producing thread owns a single-producer / single-consumer ring buffer of fixed size
+    records, so logging on the hot path is a level check, a formatting into the record and one
+    release store - no mutex, no allocation and no syscall. A background writer thread drains
+    all rings, orders the records by time and writes them with one write per batch.
+    When a ring is full the record is dropped and counted instead of blocking the producer.
+*/
+class Logger
+{
+public:
+    struct LogRecord
+    {
+        int64_t timestampNs;              // Wall clock time in nanoseconds
+        uint64_t threadTag;               // Producer thread
+        uint16_t length;                  // Length of the text
+        uint8_t level;                    // Log level
+        char text[LOG_MESSAGE_CAPACITY];  // Message text (not terminated)
+    };
+
+    // Ring buffer of one producer thread
+    struct ThreadBuffer
+    {
+        LogRecord records[LOG_RING_CAPACITY];
+        std::atomic<uint64_t> head{0};    // Next record to write (producer)
+        std::atomic<uint64_t> tail{0};    // Next record to read (writer thread)
+        std::atomic<uint64_t> dropped{0}; // Records dropped because the ring was full
+        uint64_t threadTag = 0;           // Short id of the producer thread
+    };
+
+private:
+    std::atomic<int> runtimeLevel{LOG_LEVEL_INFO};             // Records below this level are skipped
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;        // Registered rings (writer thread ownership)
+    std::mutex mtx_registry;                                   // Guards buffers - taken on thread registration only
+    std::mutex mtx_writer;                                     // Guards the writer wake up
+    std::condition_variable cv_writer;                         // Wakes the writer on flush / shutdown
+    std::unique_ptr<std::thread> writerThread;                 // Background writer
+    std::atomic<bool> stop{false};                             // Flag to stop the writer
+    std::atomic<bool> running{false};                          // Writer is draining the rings
+    std::atomic<int> activeProducers{0};                       // Producers between the running check and their push
+    std::atomic<uint64_t> flushRequests{0};                    // Flush requests issued
+    std::atomic<uint64_t> flushesDone{0};                      // Flush requests served
+
+    Logger();
+    void work();                                               // Writer thread loop
+    size_t drain();                                            // Drain all rings once (writer thread)
+    ThreadBuffer &localBuffer();                               // Ring of the calling thread
+
+public:
+    ~Logger();
+    Logger(const Logger &) = delete;
+    Logger &operator=(const Logger &) = delete;
+
+    static Logger &getInstance();
+    static const char *levelName(int level);
+    static int parseLevel(const std::string &name);            // -1 when the name is unknown
+
+    bool isEnabled(int level) const;                           // Runtime level check
+    void setLevel(int level);
+    int getLevel() const;
+    void submit(LogRecord &record);                            // Copy the record into the calling thread ring
+    void flush();                                              // Wait until everything logged so far is written
+    void shutdown();                                           // Drain and stop the writer (later logs are written synchronously)
+};
+
+// Builds a record on the stack with stream syntax, submitted to the logger when destroyed
+class LogLine
+{
+private:
+    Logger::LogRecord record;
+
+    void append(const char *text, size_t length);
+
+public:
+    LogLine(int level);
+    ~LogLine();
+
+    LogLine &operator<<(const char *text);
+    LogLine &operator<<(const std::string &text);
+    LogLine &operator<<(char value);
+    LogLine &operator<<(bool value);
+    LogLine &operator<<(signed char value);                    // int8_t / uint8_t are numbers, not characters
+    LogLine &operator<<(unsigned char value);
+    LogLine &operator<<(int value);
+    LogLine &operator<<(long value);
+    LogLine &operator<<(long long value);
+    LogLine &operator<<(unsigned int value);
+    LogLine &operator<<(unsigned long value);
+    LogLine &operator<<(unsigned long long value);
+    LogLine &operator<<(double value);
+    LogLine &operator<<(std::thread::id id);
+};
+
+#define LOG_AT_LEVEL(level, message)                     \
+    do                                                   \
+    {                                                    \
+        if (Logger::getInstance().isEnabled(level))      \
+        {                                                \
+            LogLine(level) << message;                   \
+        }                                                \
+    } while (0)
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(message) LOG_AT_LEVEL(LOG_LEVEL_DEBUG, message)
+#else
+#define LOG_DEBUG(message) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_INFO
+#define LOG_INFO(message) LOG_AT_LEVEL(LOG_LEVEL_INFO, message)
+#else
+#define LOG_INFO(message) do {} while (0)
+#endif
+
+#if LOG_COMPILE_LEVEL <= LOG_LEVEL_WARN
+#define LOG_WARN(message) LOG_AT_LEVEL(LOG_LEVEL_WARN, message)
+#else
+#define LOG_WARN(message) do {} while (0)
+#endif
+
+#define LOG_ERROR(message) LOG_AT_LEVEL(LOG_LEVEL_ERROR, message)
+
+#endif
@@ -0,0 +1,173 @@
+#include "MSTCostModel.hpp"
+#include "PrimStrategy.hpp"
+#include "KruskalStrategy.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory_resource>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#define CALIBRATION_SEED 0x5eed
+#define CALIBRATION_RUNS 3           // Best of - hides a cold cache or a preemption
+#define DEFAULT_NS_PER_OPERATION 1.0 // Used until calibrate() runs
+
+MSTCostModel::MSTCostModel()
+    : primNsPerOperation(DEFAULT_NS_PER_OPERATION), kruskalNsPerOperation(DEFAULT_NS_PER_OPERATION),
+      calibrated(false), lastChoice(Prim)
+{
+}
+
+MSTCostModel &MSTCostModel::getInstance()
+{
+    static MSTCostModel instance;
+    return instance;
+}
+
+double MSTCostModel::primOperations(const GraphFeatures &features)
+{
+    double vertices = features.numVertices;
+    double edges = static_cast<double>(features.numEdges);
+    return vertices * vertices + edges * std::log2(vertices + 1);
+}
+
+double MSTCostModel::kruskalOperations(const GraphFeatures &features)
+{
+    double vertices = features.numVertices;
+    double edges = static_cast<double>(features.numEdges);
+    // Edges taken in weight order until the forest spans the graph - every one runs a DFS over the matrix
+    double examinedEdges = std::min(edges, vertices / 2 * std::log(vertices + 1) + vertices);
+    // The radix sort of the edges is linear - a few passes over E (see EdgeArrays.hpp)
+    return vertices * vertices / 2 + edges * 4 + examinedEdges * vertices * vertices / 4;
+}
+
+// Connected random graph - a random spanning path plus random edges up to the density
+static AdjacencyMatrix calibrationGraph(int vertices, double density, std::mt19937 &rng, std::pmr::memory_resource *resource)
+{
+    AdjacencyMatrix matrix(vertices, std::pmr::vector<int>(vertices, 0), resource);
+    std::uniform_int_distribution<int> weight(1, 1000);
+    std::vector<int> order(vertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::shuffle(order.begin(), order.end(), rng);
+    for (int i = 1; i < vertices; ++i)
+    {
+        int w = weight(rng);
+        matrix[order[i - 1]][order[i]] = w;
+        matrix[order[i]][order[i - 1]] = w;
+    }
+    std::bernoulli_distribution extraEdge(density);
+    for (int u = 0; u < vertices; ++u)
+    {
+        for (int v = u + 1; v < vertices; ++v)
+        {
+            if (matrix[u][v] == 0 && extraEdge(rng))
+            {
+                int w = weight(rng);
+                matrix[u][v] = w;
+                matrix[v][u] = w;
+            }
+        }
+    }
+    return matrix;
+}
+
+// Best time of a few runs of the strategy, in nanoseconds
+static double timeStrategy(MSTStrategy &strategy, const AdjacencyMatrix &matrix)
+{
+    double best = 0;
+    for (int run = 0; run < CALIBRATION_RUNS; ++run)
+    {
+        std::pmr::monotonic_buffer_resource result;
+        auto start = std::chrono::steady_clock::now();
+        auto mst = strategy.computeMST(matrix, &result);
+        double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        best = (run == 0) ? elapsed : std::min(best, elapsed);
+    }
+    return best;
+}
+
+// Each strategy gets the median nanoseconds per operation over graphs of different sizes and densities
+void MSTCostModel::calibrate()
+{
+    struct Shape
+    {
+        int vertices;
+        double density;
+    };
+    const Shape shapes[] = {{64, 0.03}, {64, 1.0}, {128, 0.03}, {128, 0.25}, {128, 1.0}};
+
+    std::mt19937 rng(CALIBRATION_SEED);
+    PrimStrategy prim;
+    KruskalStrategy kruskal;
+    std::vector<double> primRates, kruskalRates;
+    for (const Shape &shape : shapes)
+    {
+        std::pmr::monotonic_buffer_resource graphArena;
+        AdjacencyMatrix matrix = calibrationGraph(shape.vertices, shape.density, rng, &graphArena);
+        int64_t edges = 0;
+        for (int u = 0; u < shape.vertices; ++u)
+        {
+            edges += std::count_if(matrix[u].begin() + u + 1, matrix[u].end(), [](int w) { return w != 0; });
+        }
+        GraphFeatures features{shape.vertices, edges, 0, 0};
+        primRates.push_back(timeStrategy(prim, matrix) / primOperations(features));
+        kruskalRates.push_back(timeStrategy(kruskal, matrix) / kruskalOperations(features));
+    }
+    auto median = [](std::vector<double> &rates)
+    {
+        std::nth_element(rates.begin(), rates.begin() + rates.size() / 2, rates.end());
+        return rates[rates.size() / 2];
+    };
+    this->primNsPerOperation = median(primRates);
+    this->kruskalNsPerOperation = median(kruskalRates);
+    this->calibrated = true;
+    LOG_INFO("MST cost model calibrated: Prim " << this->primNsPerOperation << " ns/op, Kruskal "
+             << this->kruskalNsPerOperation << " ns/op");
+}
+
+double MSTCostModel::estimateNs(Algorithm algorithm, const GraphFeatures &features) const
+{
+    return algorithm == Prim ? this->primNsPerOperation * primOperations(features)
+                             : this->kruskalNsPerOperation * kruskalOperations(features);
+}
+
+MSTCostModel::Algorithm MSTCostModel::choose(const GraphFeatures &features)
+{
+    double primNs = estimateNs(Prim, features);
+    double kruskalNs = estimateNs(Kruskal, features);
+    Algorithm choice = kruskalNs < primNs ? Kruskal : Prim;
+    (choice == Prim ? this->primChoices : this->kruskalChoices).fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_lastChoice);
+        this->lastFeatures = features;
+        this->lastChoice = choice;
+    }
+    LOG_DEBUG("Auto MST selection: " << algorithmName(choice) << " (V " << features.numVertices << ", E " << features.numEdges
+              << ", estimated Prim " << primNs / 1000 << " us, Kruskal " << kruskalNs / 1000 << " us)");
+    return choice;
+}
+
+const char *MSTCostModel::algorithmName(Algorithm algorithm)
+{
+    return algorithm == Prim ? "Prim" : "Kruskal";
+}
+
+std::string MSTCostModel::getStatistics() const
+{
+    std::ostringstream report;
+    report << "Cost Model: " << (this->calibrated ? "calibrated" : "not calibrated")
+           << " | Prim " << this->primNsPerOperation << " ns/op | Kruskal " << this->kruskalNsPerOperation << " ns/op\n";
+    report << "Auto Selections: Prim " << this->primChoices.load(std::memory_order_relaxed)
+           << " | Kruskal " << this->kruskalChoices.load(std::memory_order_relaxed) << "\n";
+    std::lock_guard<std::mutex> lock(this->mtx_lastChoice);
+    if (this->primChoices.load(std::memory_order_relaxed) + this->kruskalChoices.load(std::memory_order_relaxed) > 0)
+    {
+        report << "Last Auto Selection: " << algorithmName(this->lastChoice) << " | V " << this->lastFeatures.numVertices
+               << " | E " << this->lastFeatures.numEdges << " | Density " << this->lastFeatures.density
+               << " | Weight Range " << this->lastFeatures.weightRange << "\n";
+    }
+    return report.str();
+}
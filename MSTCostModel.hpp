@@ -0,0 +1,61 @@
+#ifndef MSTCOSTMODEL_HPP
+#define MSTCOSTMODEL_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+
+/*
+    Cost model of the MST strategies, used by the automatic algorithm selection.
+    Each strategy has an operation count formula in the graph features (vertices, edges):
+        Prim    - V^2 row scans + E log V heap pushes
+        Kruskal - V^2 / 2 edge collection + linear radix sort of E + a matrix DFS of ~V^2 / 4 per edge
+                  examined until the tree is complete (~V/2 ln V edges on random weights)
+    calibrate() runs both strategies on a few built-in graphs and sets the nanoseconds per
+    operation of each, so the estimate is in real time on this machine. The coefficients are
+    written once at startup and only read afterwards; the choice counters are relaxed atomics.
+*/
+class MSTCostModel
+{
+public:
+    enum Algorithm
+    {
+        Prim,
+        Kruskal
+    };
+
+    struct GraphFeatures
+    {
+        int numVertices;
+        int64_t numEdges;
+        double density;        // Edges / possible edges
+        double weightRange;    // Heaviest minus lightest edge weight
+    };
+
+private:
+    double primNsPerOperation;                  // Calibrated cost of one Prim operation
+    double kruskalNsPerOperation;               // Calibrated cost of one Kruskal operation
+    bool calibrated;                            // False until calibrate() ran
+    std::atomic<uint64_t> primChoices{0};       // Auto selections of Prim
+    std::atomic<uint64_t> kruskalChoices{0};    // Auto selections of Kruskal
+    mutable std::mutex mtx_lastChoice;          // Guards the last choice (statistics only)
+    GraphFeatures lastFeatures{};               // Features of the last auto selection
+    Algorithm lastChoice;                       // Last auto selection
+
+    MSTCostModel();
+
+public:
+    static MSTCostModel &getInstance();
+
+    static double primOperations(const GraphFeatures &features);
+    static double kruskalOperations(const GraphFeatures &features);
+
+    void calibrate();                                       // Microbenchmark of both strategies - call once at startup
+    double estimateNs(Algorithm algorithm, const GraphFeatures &features) const;
+    Algorithm choose(const GraphFeatures &features);        // Cheapest strategy - the choice is counted in the statistics
+    static const char *algorithmName(Algorithm algorithm);
+    std::string getStatistics() const;
+};
+
+#endif
@@ -4,6 +4,8 @@
 #include "MSTStrategy.hpp"
 #include "KruskalStrategy.hpp"
 #include "PrimStrategy.hpp"
+#include "AutoStrategy.hpp"
+#include "ExternalKruskalStrategy.hpp"
 #include <memory>
 
 class MSTFactory
@@ -12,17 +14,24 @@ public:
     enum AlgorithmType
     {
         Prim,
-        Kruskal
+        Kruskal,
+        Auto,     // Chosen per graph by the calibrated cost model
+        ExternalKruskal // Kruskal with the edges sorted on disk (bounded memory)
     };
 
-    static std::unique_ptr<MSTStrategy> createMSTStrategy(AlgorithmType type)
+    template <typename Weight = int, typename NoEdge = ZeroNoEdge<Weight>>
+    static std::unique_ptr<BasicMSTStrategy<Weight, NoEdge>> createMSTStrategy(AlgorithmType type)
     {
         switch (type)
         {
         case AlgorithmType::Kruskal:
-            return std::make_unique<KruskalStrategy>();
+            return std::make_unique<BasicKruskalStrategy<Weight, NoEdge>>();
         case AlgorithmType::Prim:
-            return std::make_unique<PrimStrategy>();
+            return std::make_unique<BasicPrimStrategy<Weight, NoEdge>>();
+        case AlgorithmType::Auto:
+            return std::make_unique<BasicAutoStrategy<Weight, NoEdge>>();
+        case AlgorithmType::ExternalKruskal:
+            return std::make_unique<BasicExternalKruskalStrategy<Weight, NoEdge>>();
         default:
             throw std::invalid_argument("Unknown MST Algorithm Type");
         }
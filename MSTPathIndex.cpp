@@ -0,0 +1,221 @@
+#include "MSTPathIndex.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+template <typename Weight>
+BasicMSTPathIndex<Weight>::BasicMSTPathIndex(int vertices, const std::vector<BasicWeightedEdge<Weight>> &mstEdges)
+    : numVertices(vertices), numLevels(1), depth(vertices, 0), tree(vertices, -1), rootDistance(vertices, 0)
+{
+    TraceSpan span("MSTPathIndex build", "query");
+    while ((1 << (this->numLevels - 1)) < vertices)
+    {
+        this->numLevels++;
+    }
+    this->ancestor.assign(static_cast<size_t>(this->numLevels) * vertices, 0);
+    this->maxWeight.assign(static_cast<size_t>(this->numLevels) * vertices, Weight(0));
+
+    // Adjacency lists of the tree (compressed - offsets and neighbors)
+    std::vector<int> offsets(vertices + 1, 0);
+    for (const BasicWeightedEdge<Weight> &edge : mstEdges)
+    {
+        offsets[edge.u + 1]++;
+        offsets[edge.v + 1]++;
+    }
+    for (int v = 0; v < vertices; ++v)
+    {
+        offsets[v + 1] += offsets[v];
+    }
+    std::vector<std::pair<int, Weight>> neighbors(offsets[vertices]);
+    std::vector<int> fill(offsets.begin(), offsets.end() - 1);
+    for (const BasicWeightedEdge<Weight> &edge : mstEdges)
+    {
+        neighbors[fill[edge.u]++] = {edge.v, edge.weight};
+        neighbors[fill[edge.v]++] = {edge.u, edge.weight};
+    }
+
+    // Iterative DFS from every root fills the first level - a deep tree must not overflow the stack
+    std::vector<int> stack;
+    for (int root = 0; root < vertices; ++root)
+    {
+        if (this->tree[root] >= 0)
+        {
+            continue;
+        }
+        this->tree[root] = root;
+        this->ancestor[root] = root;
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            int v = stack.back();
+            stack.pop_back();
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i)
+            {
+                auto [next, weight] = neighbors[i];
+                if (this->tree[next] >= 0)
+                {
+                    continue;
+                }
+                this->tree[next] = root;
+                this->depth[next] = this->depth[v] + 1;
+                this->rootDistance[next] = this->rootDistance[v] + weight;
+                this->ancestor[next] = v;
+                this->maxWeight[next] = weight;
+                stack.push_back(next);
+            }
+        }
+    }
+
+    // Level k jumps twice as far as level k-1
+    for (int level = 1; level < this->numLevels; ++level)
+    {
+        const int *previousAncestor = &this->ancestor[static_cast<size_t>(level - 1) * vertices];
+        const Weight *previousMax = &this->maxWeight[static_cast<size_t>(level - 1) * vertices];
+        int *currentAncestor = &this->ancestor[static_cast<size_t>(level) * vertices];
+        Weight *currentMax = &this->maxWeight[static_cast<size_t>(level) * vertices];
+        for (int v = 0; v < vertices; ++v)
+        {
+            int middle = previousAncestor[v];
+            currentAncestor[v] = previousAncestor[middle];
+            currentMax[v] = std::max(previousMax[v], previousMax[middle]);
+        }
+    }
+}
+
+template <typename Weight>
+int BasicMSTPathIndex<Weight>::getSizeVertices() const
+{
+    return this->numVertices;
+}
+
+template <typename Weight>
+int BasicMSTPathIndex<Weight>::getParent(int v) const
+{
+    return this->ancestor[v];
+}
+
+template <typename Weight>
+Weight BasicMSTPathIndex<Weight>::getParentWeight(int v) const
+{
+    return this->maxWeight[v];
+}
+
+template <typename Weight>
+int BasicMSTPathIndex<Weight>::getDepth(int v) const
+{
+    return this->depth[v];
+}
+
+template <typename Weight>
+bool BasicMSTPathIndex<Weight>::isConnected(int u, int v) const
+{
+    return this->tree[u] == this->tree[v];
+}
+
+template <typename Weight>
+int BasicMSTPathIndex<Weight>::lowestCommonAncestor(int u, int v) const
+{
+    if (this->depth[u] < this->depth[v])
+    {
+        std::swap(u, v);
+    }
+    int climb = this->depth[u] - this->depth[v];
+    for (int level = 0; climb > 0; ++level, climb >>= 1)
+    {
+        if (climb & 1)
+        {
+            u = this->ancestor[static_cast<size_t>(level) * this->numVertices + u];
+        }
+    }
+    if (u == v)
+    {
+        return u;
+    }
+    for (int level = this->numLevels - 1; level >= 0; --level)
+    {
+        size_t atU = static_cast<size_t>(level) * this->numVertices + u;
+        size_t atV = static_cast<size_t>(level) * this->numVertices + v;
+        if (this->ancestor[atU] != this->ancestor[atV])
+        {
+            u = this->ancestor[atU];
+            v = this->ancestor[atV];
+        }
+    }
+    return this->ancestor[u];
+}
+
+template <typename Weight>
+typename BasicMSTPathIndex<Weight>::PathResult BasicMSTPathIndex<Weight>::query(int u, int v) const
+{
+    if (u < 0 || u >= this->numVertices || v < 0 || v >= this->numVertices)
+    {
+        throw std::out_of_range("Vertex out of range: " + std::to_string(u < 0 || u >= this->numVertices ? u : v));
+    }
+    if (this->tree[u] != this->tree[v])
+    {
+        return {false, 0, Weight(0)};
+    }
+    if (u == v)
+    {
+        return {true, 0, Weight(0)};
+    }
+    Sum distanceU = this->rootDistance[u];
+    Sum distanceV = this->rootDistance[v];
+    Weight bottleneck = std::numeric_limits<Weight>::lowest(); // Weights may be zero or negative
+    if (this->depth[u] < this->depth[v])
+    {
+        std::swap(u, v);
+    }
+    // Lift u to the depth of v
+    int climb = this->depth[u] - this->depth[v];
+    for (int level = 0; climb > 0; ++level, climb >>= 1)
+    {
+        if (climb & 1)
+        {
+            size_t at = static_cast<size_t>(level) * this->numVertices + u;
+            bottleneck = std::max(bottleneck, this->maxWeight[at]);
+            u = this->ancestor[at];
+        }
+    }
+    // Lift both to just below their lowest common ancestor
+    if (u != v)
+    {
+        for (int level = this->numLevels - 1; level >= 0; --level)
+        {
+            size_t atU = static_cast<size_t>(level) * this->numVertices + u;
+            size_t atV = static_cast<size_t>(level) * this->numVertices + v;
+            if (this->ancestor[atU] != this->ancestor[atV])
+            {
+                bottleneck = std::max({bottleneck, this->maxWeight[atU], this->maxWeight[atV]});
+                u = this->ancestor[atU];
+                v = this->ancestor[atV];
+            }
+        }
+        bottleneck = std::max({bottleneck, this->maxWeight[u], this->maxWeight[v]});
+        u = this->ancestor[u];
+    }
+    return {true, distanceU + distanceV - 2 * this->rootDistance[u], bottleneck};
+}
+
+template <typename Weight>
+std::vector<typename BasicMSTPathIndex<Weight>::PathResult> BasicMSTPathIndex<Weight>::query(const std::vector<std::pair<int, int>> &pairs) const
+{
+    std::vector<PathResult> results;
+    results.reserve(pairs.size());
+    for (const auto &[u, v] : pairs)
+    {
+        results.push_back(query(u, v));
+    }
+    return results;
+}
+
+template <typename Weight>
+size_t BasicMSTPathIndex<Weight>::getMemoryBytes() const
+{
+    return sizeof(*this) + (this->depth.capacity() + this->tree.capacity() + this->ancestor.capacity()) * sizeof(int) +
+           this->rootDistance.capacity() * sizeof(Sum) + this->maxWeight.capacity() * sizeof(Weight);
+}
+
+INSTANTIATE_WEIGHT_TYPES(BasicMSTPathIndex)
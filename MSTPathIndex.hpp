@@ -0,0 +1,55 @@
+#ifndef MSTPATHINDEX_HPP
+#define MSTPATHINDEX_HPP
+
+#include <vector>
+#include <cstdint>
+#include "Graph.hpp"
+
+/*
+    Path queries on a minimum spanning tree (or forest) by binary lifting.
+    Built once per MST in O(V log V): every vertex keeps its 2^k-th ancestor and the heaviest
+    edge on the way to it, plus its distance from the root of its tree. A query climbs both
+    vertices to their lowest common ancestor in O(log V) and returns the weight of the tree
+    path between them and its heaviest edge (the minimax / bottleneck weight of the graph).
+    Read-only after construction, so any number of threads may query one index.
+    Defined in MSTPathIndex.cpp for the weight types of the graph (WeightTraits.hpp).
+*/
+template <typename Weight>
+class BasicMSTPathIndex
+{
+public:
+    using Sum = typename WeightTraits<Weight>::Sum;
+
+    struct PathResult
+    {
+        bool connected;        // False if u and v are in different trees of the forest
+        Sum distance;          // Sum of the weights on the tree path
+        Weight bottleneck;     // Heaviest edge on the tree path (0 if u == v)
+    };
+
+private:
+    int numVertices;
+    int numLevels;                      // Levels of the lifting tables (2^(numLevels-1) >= V)
+    std::vector<int> depth;             // Depth of the vertex in its tree
+    std::vector<int> tree;              // Root of the tree of the vertex
+    std::vector<Sum> rootDistance;      // Weight of the path to the root of its tree
+    std::vector<int> ancestor;          // [level * V + v] - 2^level-th ancestor (the root stays at the root)
+    std::vector<Weight> maxWeight;      // [level * V + v] - heaviest edge on the way to that ancestor
+
+public:
+    BasicMSTPathIndex(int vertices, const std::vector<BasicWeightedEdge<Weight>> &mstEdges);
+
+    int getSizeVertices() const;
+    int getParent(int v) const;                                // A root is its own parent
+    Weight getParentWeight(int v) const;                         // Weight of the edge to the parent (0 for a root)
+    int getDepth(int v) const;
+    bool isConnected(int u, int v) const;                      // Same tree of the forest
+    int lowestCommonAncestor(int u, int v) const;              // u and v must be connected
+    PathResult query(int u, int v) const;                      // Throws std::out_of_range for an unknown vertex
+    std::vector<PathResult> query(const std::vector<std::pair<int, int>> &pairs) const; // Batch of queries
+    size_t getMemoryBytes() const;                             // Bytes of the index arrays
+};
+
+using MSTPathIndex = BasicMSTPathIndex<int>;
+
+#endif
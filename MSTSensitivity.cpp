@@ -0,0 +1,123 @@
+#include "MSTSensitivity.hpp"
+#include "Tracer.hpp"
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+
+// Tree edges are identified by their lower (child) vertex in the rooted tree of the index
+static bool isTreeEdge(const WeightedEdge &edge, const MSTPathIndex &index)
+{
+    return (index.getParent(edge.u) == edge.v && index.getDepth(edge.u) > 0) ||
+           (index.getParent(edge.v) == edge.u && index.getDepth(edge.v) > 0);
+}
+
+MSTSensitivity::Report MSTSensitivity::analyze(const std::vector<WeightedEdge> &edges, const std::vector<WeightedEdge> &mstEdges, const MSTPathIndex &index)
+{
+    TraceSpan span("MSTSensitivity analyze", "query");
+    int numVertices = index.getSizeVertices();
+    Report report{};
+    report.mstWeight = 0;
+    for (const WeightedEdge &edge : mstEdges)
+    {
+        report.mstWeight += edge.weight;
+    }
+
+    // Non-tree edges, lightest first
+    std::vector<int> nonTree;
+    for (int i = 0; i < static_cast<int>(edges.size()); ++i)
+    {
+        if (!isTreeEdge(edges[i], index))
+        {
+            nonTree.push_back(i);
+        }
+    }
+    std::sort(nonTree.begin(), nonTree.end(), [&edges](int a, int b) { return edges[a].weight < edges[b].weight; });
+
+    // replacement[v] - lightest non-tree edge covering the tree edge v - parent(v)
+    // skip[v] - nearest ancestor-or-self whose tree edge has no replacement yet (union-find with path halving)
+    std::vector<int> replacement(numVertices, -1);
+    std::vector<int> skip(numVertices);
+    std::iota(skip.begin(), skip.end(), 0);
+    auto findUnlabeled = [&skip](int v)
+    {
+        while (skip[v] != v)
+        {
+            skip[v] = skip[skip[v]];
+            v = skip[v];
+        }
+        return v;
+    };
+    int64_t bestIncrease = INT64_MAX;
+    for (int i : nonTree)
+    {
+        const WeightedEdge &edge = edges[i];
+        if (!index.isConnected(edge.u, edge.v))
+        {
+            continue; // Cannot happen for a spanning forest of the graph
+        }
+        int ancestor = index.lowestCommonAncestor(edge.u, edge.v);
+        for (int v : {edge.u, edge.v})
+        {
+            for (v = findUnlabeled(v); index.getDepth(v) > index.getDepth(ancestor); v = findUnlabeled(v))
+            {
+                replacement[v] = edge.weight;
+                skip[v] = index.getParent(v);
+            }
+        }
+        int increase = edge.weight - index.query(edge.u, edge.v).bottleneck;
+        if (increase < bestIncrease)
+        {
+            bestIncrease = increase;
+            report.secondBestAdded = edge;
+        }
+    }
+    report.hasSecondBest = bestIncrease != INT64_MAX;
+    report.secondBestWeight = report.hasSecondBest ? report.mstWeight + bestIncrease : report.mstWeight;
+
+    report.edges.reserve(edges.size());
+    for (const WeightedEdge &edge : edges)
+    {
+        if (isTreeEdge(edge, index))
+        {
+            int child = index.getParent(edge.u) == edge.v && index.getDepth(edge.u) > 0 ? edge.u : edge.v;
+            report.edges.push_back({edge, true, replacement[child] >= 0, replacement[child]});
+        }
+        else
+        {
+            report.edges.push_back({edge, false, true, index.query(edge.u, edge.v).bottleneck});
+        }
+    }
+    return report;
+}
+
+std::string MSTSensitivity::format(const Report &report)
+{
+    std::stringstream text;
+    text << "Weight of the MST: " << report.mstWeight << "\n";
+    if (report.hasSecondBest)
+    {
+        text << "Weight of the second-best spanning tree: " << report.secondBestWeight << " (adds edge " << report.secondBestAdded.u
+             << " - " << report.secondBestAdded.v << ")\n";
+    }
+    else
+    {
+        text << "No second-best spanning tree - every edge is in the MST.\n";
+    }
+    for (const EdgeSensitivity &sensitivity : report.edges)
+    {
+        text << "Edge: " << sensitivity.edge.u << " - " << sensitivity.edge.v << " | Weight: " << sensitivity.edge.weight << " | ";
+        if (sensitivity.inMST && !sensitivity.bounded)
+        {
+            text << "in MST, stays at any weight (bridge)\n";
+        }
+        else if (sensitivity.inMST)
+        {
+            text << "in MST, stays up to weight " << sensitivity.limit << " (+" << sensitivity.limit - sensitivity.edge.weight << ")\n";
+        }
+        else
+        {
+            text << "not in MST, enters below weight " << sensitivity.limit << " (drop of more than " << sensitivity.edge.weight - sensitivity.limit << ")\n";
+        }
+    }
+    return text.str();
+}
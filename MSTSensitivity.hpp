@@ -0,0 +1,44 @@
+#ifndef MSTSENSITIVITY_HPP
+#define MSTSENSITIVITY_HPP
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include "Graph.hpp"
+#include "MSTPathIndex.hpp"
+
+/*
+    Sensitivity analysis of an MST without recomputing it per edge.
+    A non-tree edge (u, v) enters the MST once its weight drops below the heaviest edge on the
+    tree path u - v (one path-max query of the index). A tree edge leaves the MST once its weight
+    grows above the lightest non-tree edge whose tree path covers it: the non-tree edges are
+    visited from the lightest, and each one labels the still unlabeled tree edges on its path,
+    skipping the labeled ones with a union-find - O(E log E) for the sort, near-linear after it.
+    The second-best spanning tree swaps in the non-tree edge with the smallest weight increase.
+*/
+class MSTSensitivity
+{
+public:
+    struct EdgeSensitivity
+    {
+        WeightedEdge edge;
+        bool inMST;
+        bool bounded;   // False for a tree edge without replacement (a bridge) - it never leaves the MST
+        int limit;      // Tree edge: highest weight keeping it in the MST. Non-tree edge: it enters below this weight
+    };
+
+    struct Report
+    {
+        std::vector<EdgeSensitivity> edges;    // Every edge of the graph
+        int64_t mstWeight;
+        bool hasSecondBest;                    // False if the graph has no non-tree edge
+        int64_t secondBestWeight;              // Weight of the second-best spanning tree (may equal the MST weight)
+        WeightedEdge secondBestAdded;          // Non-tree edge swapped in by it
+    };
+
+    // Edges of the graph and of its MST (u < v, as Graph::getEdges) and the path index of the MST
+    static Report analyze(const std::vector<WeightedEdge> &edges, const std::vector<WeightedEdge> &mstEdges, const MSTPathIndex &index);
+    static std::string format(const Report &report);
+};
+
+#endif
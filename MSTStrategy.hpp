@@ -3,15 +3,21 @@
 
 #include <memory>
 #include <vector>
-#include <mutex>
-#include <iostream>
+#include "Logger.hpp"
+#include "MemoryArena.hpp"
+#include "WeightTraits.hpp"
 
-class MSTStrategy
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicMSTStrategy
 {
 public:
-    std::mutex cout_mtx;
-    virtual ~MSTStrategy() = default;
-    virtual std::unique_ptr<std::vector<std::vector<int>>> computeMST(const std::vector<std::vector<int>> &graphAdjacencyMatrix) = 0;
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+
+    virtual ~BasicMSTStrategy() = default;
+    // The MST matrix is allocated from resultResource, temporaries come from the thread scratch arena
+    virtual std::unique_ptr<Matrix> computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource) = 0;
 };
 
+using MSTStrategy = BasicMSTStrategy<int>;
+
 #endif
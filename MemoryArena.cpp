@@ -0,0 +1,89 @@
+#include "MemoryArena.hpp"
+
+#define SCRATCH_INITIAL_BYTES (64 * 1024)
+
+/*  CountingResource */
+
+CountingResource::CountingResource(std::pmr::memory_resource *upstream) : upstream(upstream), allocatedBytes(0) {}
+
+void *CountingResource::do_allocate(size_t bytes, size_t alignment)
+{
+    void *pointer = this->upstream->allocate(bytes, alignment);
+    this->allocatedBytes += bytes;
+    return pointer;
+}
+
+void CountingResource::do_deallocate(void *pointer, size_t bytes, size_t alignment)
+{
+    this->upstream->deallocate(pointer, bytes, alignment);
+}
+
+bool CountingResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+size_t CountingResource::getAllocatedBytes() const
+{
+    return this->allocatedBytes;
+}
+
+void CountingResource::resetCount()
+{
+    this->allocatedBytes = 0;
+}
+
+/*  ScratchArena */
+
+ScratchArena::ScratchArena() : buffer(SCRATCH_INITIAL_BYTES), depth(0) {}
+
+ScratchArena &ScratchArena::local()
+{
+    thread_local ScratchArena arena;
+    return arena;
+}
+
+void ScratchArena::begin()
+{
+    if (this->depth++ == 0)
+    {
+        this->overflow.resetCount();
+        this->resource.emplace(this->buffer.data(), this->buffer.size(), &this->overflow);
+    }
+}
+
+void ScratchArena::end()
+{
+    if (--this->depth == 0)
+    {
+        this->resource.reset(); // Releases the overflow chunks
+        // Grow to the high-water mark so the next request of this thread fits in one buffer
+        size_t overflowBytes = this->overflow.getAllocatedBytes();
+        if (overflowBytes > 0)
+        {
+            this->buffer = std::vector<std::byte>(this->buffer.size() + overflowBytes);
+        }
+    }
+}
+
+size_t ScratchArena::getCapacity() const
+{
+    return this->buffer.size();
+}
+
+/*  ScratchArena::Scope */
+
+ScratchArena::Scope::Scope() : arena(ScratchArena::local())
+{
+    this->arena.begin();
+}
+
+ScratchArena::Scope::~Scope()
+{
+    this->arena.end();
+}
+
+std::pmr::memory_resource *ScratchArena::Scope::resource() const
+{
+    return &*this->arena.resource;
+}
@@ -0,0 +1,68 @@
+#ifndef MEMORYARENA_HPP
+#define MEMORYARENA_HPP
+
+#include <memory_resource>
+#include <vector>
+#include <optional>
+#include <cstddef>
+
+// Adjacency matrix whose rows are allocated from the same memory resource as the matrix itself
+template <typename Weight>
+using BasicAdjacencyMatrix = std::pmr::vector<std::pmr::vector<Weight>>;
+using AdjacencyMatrix = BasicAdjacencyMatrix<int>;
+
+// Upstream resource wrapper that counts the bytes it hands out
+class CountingResource : public std::pmr::memory_resource
+{
+private:
+    std::pmr::memory_resource *upstream; // Resource that really allocates
+    size_t allocatedBytes;               // Bytes allocated since the last reset
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+public:
+    CountingResource(std::pmr::memory_resource *upstream = std::pmr::new_delete_resource());
+    size_t getAllocatedBytes() const;
+    void resetCount();
+};
+
+/*
+    Per-thread scratch arena for temporary buffers of the MST strategies and metric computations.
+    Allocation is a pointer bump in a buffer owned by the thread, so worker threads never contend
+    on the global allocator. Memory is released all at once when the outermost Scope ends and the
+    buffer is kept (grown to the high-water mark) for the next request of the same thread.
+*/
+class ScratchArena
+{
+private:
+    std::vector<std::byte> buffer;                                  // Reused backing buffer of the thread
+    CountingResource overflow;                                      // Upstream used when the buffer is exhausted
+    std::optional<std::pmr::monotonic_buffer_resource> resource;    // Bump allocator over the buffer
+    int depth;                                                      // Number of open scopes
+
+    ScratchArena();
+    void begin();   // Open a scope
+    void end();     // Close a scope - release everything when it is the outermost one
+
+public:
+    // RAII scope - memory allocated from resource() is valid until the outermost scope ends
+    class Scope
+    {
+    private:
+        ScratchArena &arena;
+
+    public:
+        Scope();
+        ~Scope();
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+        std::pmr::memory_resource *resource() const;
+    };
+
+    static ScratchArena &local(); // Arena of the calling thread
+    size_t getCapacity() const;   // Size of the reusable buffer
+};
+
+#endif
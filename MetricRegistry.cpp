@@ -0,0 +1,135 @@
+#include "MetricRegistry.hpp"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+// The built-ins are registered in MSTMetric bit order - the bit a Graph setter marks is the bit of its metric id
+MetricRegistry::MetricRegistry()
+{
+    registerMetric("total-weight", "Total weight of the MST", [](Graph &graph) { graph.setMSTTotalWeight(); });
+    registerMetric("longest-distance", "Longest distance between two vertices (Floyd-Warshall, O(V^3))", [](Graph &graph) { graph.setMSTLongestDistance(); });
+    registerMetric("shortest-distance", "Shortest distance between two vertices (Floyd-Warshall, O(V^3))", [](Graph &graph) { graph.setMSTShortestDistance(); });
+    registerMetric("average-weight", "Average weight of the MST edges", [](Graph &graph) { graph.setMSTAvgEdgeWeight(); });
+    static_assert(MST_TOTAL_WEIGHT == 1u << 0 && MST_LONGEST_DISTANCE == 1u << 1 && MST_SHORTEST_DISTANCE == 1u << 2 && MST_AVERAGE_WEIGHT == 1u << 3,
+                  "MSTMetric bits must follow the registration order of the built-in metrics");
+}
+
+MetricRegistry &MetricRegistry::getInstance()
+{
+    static MetricRegistry instance;
+    return instance;
+}
+
+int MetricRegistry::registerMetric(const std::string &name, const std::string &description, Kernel kernel)
+{
+    if (name.empty() || name == "all" || find(name) >= 0)
+    {
+        throw std::invalid_argument("Metric name " + name + " is taken");
+    }
+    if (static_cast<int>(this->metrics.size()) == MAX_METRICS)
+    {
+        throw std::invalid_argument("No room for metric " + name);
+    }
+    this->metrics.push_back(Metric{name, description, std::move(kernel)});
+    return static_cast<int>(this->metrics.size()) - 1;
+}
+
+int MetricRegistry::find(const std::string &name) const
+{
+    auto metric = std::find_if(this->metrics.begin(), this->metrics.end(), [&name](const Metric &metric) { return metric.name == name; });
+    return metric == this->metrics.end() ? -1 : static_cast<int>(metric - this->metrics.begin());
+}
+
+const MetricRegistry::Metric &MetricRegistry::get(int id) const
+{
+    return this->metrics.at(id);
+}
+
+size_t MetricRegistry::size() const
+{
+    return this->metrics.size();
+}
+
+MetricRegistry::MetricSet MetricRegistry::allMetrics() const
+{
+    return this->metrics.size() == MAX_METRICS ? ~MetricSet(0) : (MetricSet(1) << this->metrics.size()) - 1;
+}
+
+MetricRegistry::MetricSet MetricRegistry::parseSelection(const std::string &names) const
+{
+    MetricSet selection = 0;
+    std::stringstream list(names);
+    std::string name;
+    while (std::getline(list, name, ','))
+    {
+        name.erase(0, name.find_first_not_of(" \t\r\n"));
+        name.erase(name.find_last_not_of(" \t\r\n") + 1);
+        if (name.empty())
+        {
+            continue;
+        }
+        if (name == "all")
+        {
+            return allMetrics();
+        }
+        int id = find(name);
+        if (id < 0)
+        {
+            throw std::invalid_argument("Unknown metric " + name + " (" + listNames() + " or all)");
+        }
+        selection |= MetricSet(1) << id;
+    }
+    if (selection == 0)
+    {
+        throw std::invalid_argument("No metric selected (" + listNames() + " or all)");
+    }
+    return selection;
+}
+
+std::vector<std::vector<int>> MetricRegistry::parseLayout(const std::string &layout) const
+{
+    std::vector<std::vector<int>> branches;
+    MetricSet used = 0;
+    std::stringstream branchList(layout);
+    std::string branchText;
+    while (std::getline(branchList, branchText, ';'))
+    {
+        std::vector<int> branch;
+        std::stringstream chain(branchText);
+        std::string name;
+        while (std::getline(chain, name, '>'))
+        {
+            int id = find(name);
+            if (id < 0)
+            {
+                throw std::invalid_argument("Unknown metric " + name + " in pipeline layout (" + listNames() + ")");
+            }
+            if (used & (MetricSet(1) << id))
+            {
+                throw std::invalid_argument("Metric " + name + " appears twice in pipeline layout");
+            }
+            used |= MetricSet(1) << id;
+            branch.push_back(id);
+        }
+        if (branch.empty())
+        {
+            throw std::invalid_argument("Empty branch in pipeline layout " + layout);
+        }
+        branches.push_back(std::move(branch));
+    }
+    if (branches.empty())
+    {
+        throw std::invalid_argument("Empty pipeline layout");
+    }
+    return branches;
+}
+
+std::string MetricRegistry::listNames() const
+{
+    std::string names;
+    for (const Metric &metric : this->metrics)
+    {
+        names += (names.empty() ? "" : ", ") + metric.name;
+    }
+    return names;
+}
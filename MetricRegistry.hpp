@@ -0,0 +1,58 @@
+#ifndef METRICREGISTRY_HPP
+#define METRICREGISTRY_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Graph.hpp"
+
+// The cheap O(V^2) metrics share a branch, each Floyd-Warshall metric has its own
+#define DEFAULT_PIPELINE_LAYOUT "total-weight>average-weight;longest-distance;shortest-distance"
+
+/*
+    Registry of the MST metric kernels the pipeline can run as stages.
+    A kernel computes one metric of a graph whose MST exists and stores it in the graph. Each
+    metric has an id (its registration index) so a set of metrics is a bit mask - a pipeline
+    task carries the mask of the metrics its client asked for, and the stages of the other
+    metrics pass it through without running.
+    The built-in metrics are registered by the constructor. Other kernels are registered at
+    startup, before the pipeline is built - the registry is only read afterwards.
+*/
+class MetricRegistry
+{
+public:
+    using Kernel = std::function<void(Graph &)>;
+    using MetricSet = uint32_t; // Bit i - metric of id i
+
+    struct Metric
+    {
+        std::string name;        // Name in the pipeline layout and the client request
+        std::string description; // Menu text
+        Kernel kernel;
+    };
+
+    static constexpr int MAX_METRICS = 32;
+
+private:
+    std::vector<Metric> metrics; // Index - metric id
+
+    MetricRegistry();
+
+public:
+    static MetricRegistry &getInstance();
+
+    int registerMetric(const std::string &name, const std::string &description, Kernel kernel); // Id - throws std::invalid_argument if taken or full
+    int find(const std::string &name) const;    // -1 if unknown
+    const Metric &get(int id) const;
+    size_t size() const;
+    MetricSet allMetrics() const;
+    MetricSet parseSelection(const std::string &names) const; // "name,name" or "all" - throws std::invalid_argument
+    std::string listNames() const;                            // "name, name, ..."
+
+    // Pipeline layout "a>b;c;d" - parallel branches separated by ';', each a chain of metrics run in order by '>'
+    // Every metric appears at most once - throws std::invalid_argument
+    std::vector<std::vector<int>> parseLayout(const std::string &layout) const;
+};
+
+#endif
@@ -0,0 +1,269 @@
+#include "NumaTopology.hpp"
+#include "Logger.hpp"
+#include <algorithm>
+#include <cctype>
+#include <dirent.h>
+#include <fstream>
+#include <pthread.h>
+#include <sched.h>
+#include <sstream>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <thread>
+#include <unistd.h>
+
+#define MPOL_PREFERRED_MODE 1 // MPOL_PREFERRED of <numaif.h> - falls back to other nodes when the node is full
+#define NODE_DIRECTORY_PREFIX "node"
+#define MAX_NODE_MASK_BITS 1024 // Node numbers mbind accepts here
+#define MASK_WORD_BITS (8 * sizeof(unsigned long))
+
+static size_t pageSize()
+{
+    static const size_t size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+static size_t roundToPages(size_t bytes)
+{
+    return (bytes + pageSize() - 1) / pageSize() * pageSize();
+}
+
+NodeLocalResource::NodeLocalResource(int node, std::atomic<uint64_t> &bindFailures) : node(node), bindFailures(bindFailures) {}
+
+void *NodeLocalResource::do_allocate(size_t bytes, size_t alignment)
+{
+    if (alignment > pageSize())
+    {
+        throw std::bad_alloc();
+    }
+    size_t length = roundToPages(std::max<size_t>(bytes, 1));
+    void *pointer = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (pointer == MAP_FAILED)
+    {
+        throw std::bad_alloc();
+    }
+    // Nothing is touched yet, so every page of the mapping is placed by the policy
+    unsigned long nodeMask[MAX_NODE_MASK_BITS / MASK_WORD_BITS] = {};
+    if (this->node < MAX_NODE_MASK_BITS)
+    {
+        nodeMask[this->node / MASK_WORD_BITS] |= 1UL << (this->node % MASK_WORD_BITS);
+    }
+    if (this->node >= MAX_NODE_MASK_BITS || syscall(SYS_mbind, pointer, length, MPOL_PREFERRED_MODE, nodeMask, MAX_NODE_MASK_BITS, 0) != 0)
+    {
+        this->bindFailures.fetch_add(1, std::memory_order_relaxed); // First touch placement still applies
+    }
+    return pointer;
+}
+
+void NodeLocalResource::do_deallocate(void *pointer, size_t bytes, size_t)
+{
+    munmap(pointer, roundToPages(std::max<size_t>(bytes, 1)));
+}
+
+bool NodeLocalResource::do_is_equal(const std::pmr::memory_resource &other) const noexcept
+{
+    return this == &other;
+}
+
+NumaTopology::NumaTopology(const std::string &sysfsRoot) : placement(Off)
+{
+    discover(sysfsRoot);
+    for (int node = 0; node < getNumNodes(); ++node)
+    {
+        this->resources.push_back(std::make_unique<NodeLocalResource>(this->sysfsNodes[node], this->bindFailures));
+    }
+}
+
+NumaTopology &NumaTopology::getInstance()
+{
+    static NumaTopology instance;
+    return instance;
+}
+
+void NumaTopology::discover(const std::string &sysfsRoot)
+{
+    std::vector<std::pair<int, std::vector<int>>> nodes;
+    if (DIR *directory = opendir(sysfsRoot.c_str()))
+    {
+        while (dirent *entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+            if (name.rfind(NODE_DIRECTORY_PREFIX, 0) != 0 || name.size() == sizeof(NODE_DIRECTORY_PREFIX) - 1 ||
+                !std::all_of(name.begin() + sizeof(NODE_DIRECTORY_PREFIX) - 1, name.end(), ::isdigit))
+            {
+                continue;
+            }
+            std::ifstream cpulist(sysfsRoot + "/" + name + "/cpulist");
+            std::string list;
+            std::getline(cpulist, list);
+            std::vector<int> cpus = parseCpuList(list);
+            if (!cpus.empty()) // Memory only nodes run no threads
+            {
+                nodes.emplace_back(std::stoi(name.substr(sizeof(NODE_DIRECTORY_PREFIX) - 1)), std::move(cpus));
+            }
+        }
+        closedir(directory);
+    }
+    std::sort(nodes.begin(), nodes.end());
+
+    // Nodes are renumbered densely - the resources bind to the sysfs number
+    for (auto &[sysfsNode, cpus] : nodes)
+    {
+        this->sysfsNodes.push_back(sysfsNode);
+        this->nodeCpus.push_back(std::move(cpus));
+    }
+    if (this->nodeCpus.empty())
+    {
+        std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+        for (size_t cpu = 0; cpu < cpus.size(); ++cpu)
+        {
+            cpus[cpu] = static_cast<int>(cpu);
+        }
+        this->nodeCpus.push_back(std::move(cpus));
+        this->sysfsNodes.push_back(0);
+    }
+    for (size_t node = 0; node < this->nodeCpus.size(); ++node)
+    {
+        for (int cpu : this->nodeCpus[node])
+        {
+            if (cpu >= static_cast<int>(this->cpuNodes.size()))
+            {
+                this->cpuNodes.resize(cpu + 1, -1);
+            }
+            this->cpuNodes[cpu] = static_cast<int>(node);
+        }
+    }
+}
+
+void NumaTopology::setPlacement(Placement placement)
+{
+    this->placement = placement;
+    LOG_INFO("NUMA: " << getNumNodes() << " node(s), placement " << placementName(placement));
+}
+
+NumaTopology::Placement NumaTopology::getPlacement() const
+{
+    return this->placement;
+}
+
+int NumaTopology::getNumNodes() const
+{
+    return static_cast<int>(this->nodeCpus.size());
+}
+
+const std::vector<int> &NumaTopology::getNodeCpus(int node) const
+{
+    return this->nodeCpus.at(node);
+}
+
+int NumaTopology::nodeOfCpu(int cpu) const
+{
+    if (cpu < 0 || cpu >= static_cast<int>(this->cpuNodes.size()) || this->cpuNodes[cpu] < 0)
+    {
+        return 0;
+    }
+    return this->cpuNodes[cpu];
+}
+
+int NumaTopology::currentNode() const
+{
+    return getNumNodes() == 1 ? 0 : nodeOfCpu(sched_getcpu());
+}
+
+int NumaTopology::pinCurrentThread(int index)
+{
+    if (this->placement == Off)
+    {
+        return -1;
+    }
+    int node = index % getNumNodes();
+    const std::vector<int> &cpus = this->nodeCpus[node];
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    if (this->placement == Cpu)
+    {
+        CPU_SET(cpus[(index / getNumNodes()) % cpus.size()], &cpuSet);
+    }
+    else
+    {
+        for (int cpu : cpus)
+        {
+            CPU_SET(cpu, &cpuSet);
+        }
+    }
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        this->pinFailures.fetch_add(1, std::memory_order_relaxed);
+        LOG_WARN("NUMA: Could not pin thread " << index << " to node " << node);
+        return -1;
+    }
+    this->pinnedThreads.fetch_add(1, std::memory_order_relaxed);
+    return node;
+}
+
+std::pmr::memory_resource *NumaTopology::nodeResource(int node)
+{
+    if (this->placement == Off || getNumNodes() == 1)
+    {
+        return std::pmr::new_delete_resource();
+    }
+    return this->resources[node].get();
+}
+
+std::vector<int> NumaTopology::parseCpuList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::stringstream ranges(list);
+    std::string range;
+    while (std::getline(ranges, range, ','))
+    {
+        if (range.empty() || !std::isdigit(static_cast<unsigned char>(range[0])))
+        {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu)
+        {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+NumaTopology::Placement NumaTopology::parsePlacement(const std::string &name)
+{
+    if (name == "off") return Off;
+    if (name == "node") return Node;
+    if (name == "cpu") return Cpu;
+    throw std::invalid_argument("Unknown NUMA placement " + name + " (off|node|cpu)");
+}
+
+std::string NumaTopology::placementName(Placement placement)
+{
+    switch (placement)
+    {
+        case Node:
+            return "node";
+        case Cpu:
+            return "cpu";
+        default:
+            return "off";
+    }
+}
+
+std::string NumaTopology::getStatistics() const
+{
+    std::ostringstream report;
+    report << "NUMA: " << getNumNodes() << " node(s) | Placement " << placementName(this->placement)
+           << " | Pinned threads " << this->pinnedThreads.load(std::memory_order_relaxed)
+           << " | Pin failures " << this->pinFailures.load(std::memory_order_relaxed)
+           << " | Bind failures " << this->bindFailures.load(std::memory_order_relaxed) << "\n";
+    for (int node = 0; node < getNumNodes(); ++node)
+    {
+        report << "Node " << node << " (sysfs node" << this->sysfsNodes[node] << "): " << this->nodeCpus[node].size() << " CPUs\n";
+    }
+    return report.str();
+}
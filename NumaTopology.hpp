@@ -0,0 +1,82 @@
+#ifndef NUMATOPOLOGY_HPP
+#define NUMATOPOLOGY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+// Upstream resource whose allocations are mapped directly and preferably placed on one NUMA node
+class NodeLocalResource : public std::pmr::memory_resource
+{
+private:
+    int node;                                  // Preferred node of the pages (sysfs number)
+    std::atomic<uint64_t> &bindFailures;       // Shared counter of the topology - mbind refused (no NUMA support)
+
+    void *do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void *pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override;
+
+public:
+    NodeLocalResource(int node, std::atomic<uint64_t> &bindFailures);
+};
+
+/*
+    NUMA topology of the machine and the placement of the server threads and graphs.
+    The nodes and their CPUs are read from sysfs (/sys/devices/system/node/nodeN/cpulist); a
+    machine without that directory is one node with every CPU.
+    Placement is configured once at startup, before any pool starts its threads:
+        Off  - threads float, graphs use the default allocator (the previous behaviour)
+        Node - every thread is pinned to all the CPUs of one node
+        Cpu  - every thread is pinned to a single CPU of its node
+    Threads call pinCurrentThread(index) as they start with their index in their pool: thread i
+    goes to node i % nodes, so every pool (pipeline stages, Leader-Follower and compute workers,
+    event loops) is spread over the nodes. While placement is on, the matrices of a graph are
+    allocated on the node of the thread that created it - first touch would put them there too,
+    but a spilled graph is paged back in by whichever thread reads it - and the Leader-Follower
+    workers prefer the graphs of their own node (TaskScheduler).
+*/
+class NumaTopology
+{
+public:
+    enum Placement
+    {
+        Off,
+        Node,
+        Cpu
+    };
+
+private:
+    std::vector<std::vector<int>> nodeCpus;                       // [node] - CPUs of the node
+    std::vector<int> sysfsNodes;                                  // [node] - number of the node in sysfs and mbind
+    std::vector<int> cpuNodes;                                    // [cpu] - node of the CPU (-1 if offline)
+    std::vector<std::unique_ptr<NodeLocalResource>> resources;    // [node] - graph memory of the node
+    Placement placement;                                          // Written once at startup
+    std::atomic<uint64_t> pinnedThreads{0};                       // Threads pinned successfully
+    std::atomic<uint64_t> pinFailures{0};                         // pthread_setaffinity_np refused
+    std::atomic<uint64_t> bindFailures{0};                        // mbind refused
+
+    void discover(const std::string &sysfsRoot);
+
+public:
+    NumaTopology(const std::string &sysfsRoot = "/sys/devices/system/node");
+    static NumaTopology &getInstance();
+
+    void setPlacement(Placement placement);                 // Call before the thread pools start
+    Placement getPlacement() const;
+    int getNumNodes() const;
+    const std::vector<int> &getNodeCpus(int node) const;
+    int nodeOfCpu(int cpu) const;                           // 0 if the CPU is unknown
+    int currentNode() const;                                // Node of the CPU running the caller
+    int pinCurrentThread(int index);                        // Pin the index-th thread of a pool - returns its node (-1 if not pinned)
+    std::pmr::memory_resource *nodeResource(int node);      // Graph memory on a node (default allocator if Off)
+
+    static std::vector<int> parseCpuList(const std::string &list); // "0-3,8,10-11"
+    static Placement parsePlacement(const std::string &name);      // Throws std::invalid_argument
+    static std::string placementName(Placement placement);
+    std::string getStatistics() const;
+};
+
+#endif
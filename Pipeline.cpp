@@ -1,20 +1,9 @@
 #include "Pipeline.hpp"
 
-// Stage definitions
-#define STAGE_UNDEFINE -1 // Undefined stage for error handling
-#define STAGE_0_START_MST_CALCULATION 0
-#define STAGE_1_TOTAL_WEIGHT_MST 1
-#define STAGE_2_LON_DIS_BET_TWO_VER_MST 2
-#define STAGE_3_SHO_DIS_BET_TWO_VER_MST 3
-#define STAGE_4_AVG_DIS_BET_TWO_EDG_MST 4
-#define STAGE_5_FINISH_MST_CALCUATION 5
-
-Pipeline::Pipeline()
+Pipeline::Pipeline(const std::string &layout, size_t batchSize, bool adaptiveFusion)
+    : layout(MetricRegistry::getInstance().parseLayout(layout)), layoutMetrics(0), batchSize(batchSize), adaptiveFusion(adaptiveFusion)
 {
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::cout << "Starting Pipeline Design Pattern" << std::endl;
-    }
+    LOG_INFO("Starting Pipeline Design Pattern (layout " << layout << ", batch " << batchSize << ", adaptive fusion " << (adaptiveFusion ? "on" : "off") << ")");
     createAOStages();
     setAONextStage();
     setTaskHandler();
@@ -22,10 +11,7 @@ Pipeline::Pipeline()
 
 Pipeline::~Pipeline()
 {
-    {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::cout << "\n********* START Pipeline Stop Process *********" << std::endl;
-    }
+    LOG_INFO("********* START Pipeline Stop Process *********");
 
     // Lock the mutex to ensure thread safety
     for (auto stage : stages)
@@ -35,37 +21,72 @@ Pipeline::~Pipeline()
     
     // Clear the stages vector to release the shared_ptr resources
     stages.clear();
-    std::lock_guard<std::mutex> lock(mtx);
-    std::cout << "\nPipeline: Cleared Active-Object Stages " << std::endl;
-    std::cout << "\n********* FINISH Pipeline Stop Process *********" << std::endl;
+    LOG_DEBUG("Pipeline: Cleared Active-Object Stages ");
+    LOG_INFO("********* FINISH Pipeline Stop Process *********");
 }
 
 // Process the graphs that sended from the server
-void Pipeline::processGraphs(std::vector<std::weak_ptr<Graph>> &graphs)
+void Pipeline::processGraphs(std::vector<std::weak_ptr<Graph>> &graphs, std::shared_ptr<const CancellationToken> cancellation, MetricRegistry::MetricSet metrics)
 {
-    // Lock mutex is done in the active object enqueueTask function
+    // Lock mutex is done in the active object enqueueTasks function - once for all the graphs
+    std::vector<GraphTask> tasks;
     for (auto graph : graphs)
     {
-        stages[STAGE_0_START_MST_CALCULATION]->enqueueTask(graph); // enqueue the weak ptr although we have used shared ptr for validation
+        if (auto sharedGraph = graph.lock()) // enqueue the weak ptr although we have used shared ptr for validation
+        {
+            tasks.emplace_back(graph, sharedGraph->getGraphID());
+            tasks.back().cancellation = cancellation;
+            tasks.back().metrics = metrics & ~sharedGraph->getComputedMetrics(); // A reopened graph only computes what it lacks
+        }
+    }
+    stages.front()->enqueueTasks(std::move(tasks)); // Start stage
+}
+
+MetricRegistry::MetricSet Pipeline::getMetrics() const
+{
+    return this->layoutMetrics;
+}
+
+// Statistics of every stage - read without locking the stages
+std::string Pipeline::getStatistics() const
+{
+    std::string report;
+    for (const auto &stage : this->stages)
+    {
+        report += stage->getStatistics();
     }
+    return report;
 }
 
 void Pipeline::createAOStages()
 {
     try
     {
-        // Create stages with error checking
+        // Create stages with error checking - start, the metrics branch by branch, finish
         std::lock_guard<std::mutex> lock(mtx);
-        for (int stageNumber = STAGE_0_START_MST_CALCULATION; stageNumber <= STAGE_5_FINISH_MST_CALCUATION; ++stageNumber)
+        const MetricRegistry &registry = MetricRegistry::getInstance();
+        std::vector<std::pair<std::string, int>> stageMetrics{{"start", -1}};
+        for (const auto &branch : this->layout)
+        {
+            for (int metric : branch)
+            {
+                stageMetrics.emplace_back(registry.get(metric).name, metric);
+                this->layoutMetrics |= MetricRegistry::MetricSet(1) << metric;
+            }
+        }
+        stageMetrics.emplace_back("finish", -1);
+        for (size_t stageNumber = 0; stageNumber < stageMetrics.size(); ++stageNumber)
         {
-            std::cout << "***** " << "Pipeline: Creating stage " << stageNumber << " *****" << std::endl;
-            stages.push_back(std::make_shared<ActiveObject>(stageNumber)); // Create a shared pointer to an active object
-            std::cout << "Pipeline: Stage " << stageNumber << " created successfully" << std::endl;
+            LOG_DEBUG("***** " << "Pipeline: Creating stage " << stageNumber << " *****");
+            stages.push_back(std::make_shared<ActiveObject>(stageNumber, stageMetrics[stageNumber].first, this->batchSize)); // Create a shared pointer to an active object
+            stages.back()->setAdaptiveFusion(this->adaptiveFusion);
+            stages.back()->setMetric(stageMetrics[stageNumber].second);
+            LOG_DEBUG("Pipeline: Stage " << stageNumber << " (" << stageMetrics[stageNumber].first << ") created successfully");
         }
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Pipeline: Stage creation failed: " << e.what() << std::endl;
+        LOG_ERROR("Pipeline: Stage creation failed: " << e.what());
         throw;
     }
 }
@@ -74,107 +95,71 @@ void Pipeline::setAONextStage()
 {
     try
     {
-        std::weak_ptr<ActiveObject> myNextStage = stages[STAGE_1_TOTAL_WEIGHT_MST]; // Stage 1
-        stages[STAGE_0_START_MST_CALCULATION]->setNextStage(myNextStage);           // Set Stage 0 -> 1
-        myNextStage = stages[STAGE_2_LON_DIS_BET_TWO_VER_MST];                      // Stage 2
-        stages[STAGE_1_TOTAL_WEIGHT_MST]->setNextStage(myNextStage);                // Set Stage 1 -> 2
-        myNextStage = stages[STAGE_3_SHO_DIS_BET_TWO_VER_MST];                      // Stage 3
-        stages[STAGE_2_LON_DIS_BET_TWO_VER_MST]->setNextStage(myNextStage);         // Set Stage 2 -> 3
-        myNextStage = stages[STAGE_4_AVG_DIS_BET_TWO_EDG_MST];                      // Stage 4
-        stages[STAGE_3_SHO_DIS_BET_TWO_VER_MST]->setNextStage(myNextStage);         // Set Stage 3 -> 4
-        myNextStage = stages[STAGE_5_FINISH_MST_CALCUATION];                        // Stage 5
-        stages[STAGE_4_AVG_DIS_BET_TWO_EDG_MST]->setNextStage(myNextStage);         // Set Stage 4 -> 5
+        // start -> first stage of every branch, each stage -> the next of its branch, last of every branch -> finish
+        std::shared_ptr<ActiveObject> finishStage = stages.back();
+        size_t stageNumber = 1;
+        for (const auto &branch : this->layout)
+        {
+            stages.front()->addNextStage(stages[stageNumber]);
+            for (size_t i = 1; i < branch.size(); ++i, ++stageNumber)
+            {
+                stages[stageNumber]->addNextStage(stages[stageNumber + 1]);
+            }
+            stages[stageNumber++]->addNextStage(finishStage);
+        }
+        if (this->layout.size() > 1)
+        {
+            finishStage->setJoinStage();
+        }
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Set Next Active Object Failed: " << e.what() << std::endl;
+        LOG_ERROR("Set Next Active Object Failed: " << e.what());
         throw;
     }
 }
 
-// define the task handlers for each stage
+// define the task handlers - the start and finish stages move the status, the metric stages run their kernel
 void Pipeline::setTaskHandler()
 {
     try
     {
-        // Define task handlers for each stage
-        stages[STAGE_0_START_MST_CALCULATION]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
+        auto statusHandler = [](std::weak_ptr<Graph> graph) -> void
         {
             // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
             std::shared_ptr<Graph> sharedGraph = graph.lock();
 
             // Check if the shared_ptr is valid
             if (sharedGraph) {
-                sharedGraph->setMSTDataCalculationNextStatus();  // Access the method  (next set status is progress = 0 previous is none = -1)
+                sharedGraph->setMSTDataCalculationNextStatus();  // Start: none -> progress, finish: progress -> finish
             } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
+                LOG_WARN("Graph object no longer exists.");
             }
-        });
-
-        stages[STAGE_1_TOTAL_WEIGHT_MST]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
-                                                         {
-            // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
-            std::shared_ptr<Graph> sharedGraph = graph.lock();
-
-            // Check if the shared_ptr is valid
-            if (sharedGraph) {
-                sharedGraph->setMSTTotalWeight();  // Access the method
-            } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
-            } });
+        };
+        stages.front()->setTaskHandler(statusHandler);
+        stages.back()->setTaskHandler(statusHandler);
 
-        stages[STAGE_2_LON_DIS_BET_TWO_VER_MST]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
-                                                                {
-            // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
-            std::shared_ptr<Graph> sharedGraph = graph.lock();
-
-            // Check if the shared_ptr is valid
-            if (sharedGraph) {
-                sharedGraph->setMSTLongestDistance();  // Access the method
-            } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
-            } });
-
-        stages[STAGE_3_SHO_DIS_BET_TWO_VER_MST]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
-                                                                {
-            // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
-            std::shared_ptr<Graph> sharedGraph = graph.lock();
-
-            // Check if the shared_ptr is valid
-            if (sharedGraph) {
-                sharedGraph->setMSTShortestDistance();  // Access the method
-            } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
-            } });
-
-        stages[STAGE_4_AVG_DIS_BET_TWO_EDG_MST]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
-                                                                {
-            // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
-            std::shared_ptr<Graph> sharedGraph = graph.lock();
-
-            // Check if the shared_ptr is valid
-            if (sharedGraph) {
-                sharedGraph->setMSTAvgEdgeWeight();  // Access the method
-            } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
-            } });
-
-        stages[STAGE_5_FINISH_MST_CALCUATION]->setTaskHandler([this](std::weak_ptr<Graph> graph) -> void
-                                                              {
-            // Lock the weak_ptr to get a shared_ptr (to be able to access the graph methods)
-            std::shared_ptr<Graph> sharedGraph = graph.lock();
-
-            // Check if the shared_ptr is valid
-            if (sharedGraph) {
-                sharedGraph->setMSTDataCalculationNextStatus();  // Access the method (next set status is finish = 1, previous one is progress = 0)
-            } else {   // Handle the case where the managed object no longer exists
-                std::cerr << "Graph object no longer exists." << std::endl;
-            } });
+        size_t stageNumber = 1;
+        for (const auto &branch : this->layout)
+        {
+            for (int metric : branch)
+            {
+                stages[stageNumber++]->setTaskHandler([kernel = MetricRegistry::getInstance().get(metric).kernel, metric](std::weak_ptr<Graph> graph) -> void
+                {
+                    std::shared_ptr<Graph> sharedGraph = graph.lock();
+                    if (sharedGraph) {
+                        kernel(*sharedGraph);
+                        sharedGraph->markMetricsComputed(MetricRegistry::MetricSet(1) << metric);
+                    } else {
+                        LOG_WARN("Graph object no longer exists.");
+                    }
+                });
+            }
+        }
     }
     catch (const std::exception &e)
     {
-        std::cerr << "Set Next Active Object Failed: " << e.what() << std::endl;
+        LOG_ERROR("Set Task Handler Failed: " << e.what());
         throw;
     }
 }
-
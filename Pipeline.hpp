@@ -5,25 +5,43 @@
 #include <memory>
 #include <mutex>
 #include <condition_variable>
+#include <string>
 #include "ActiveObject.hpp"
+#include "MetricRegistry.hpp"
 
+/*
+    Pipeline of Active Objects built from a layout of MetricRegistry metrics (MetricRegistry::parseLayout).
+    A start stage marks the graphs in progress and forks them into the branches of the layout, each
+    a chain of metric stages; a finish stage joins the branches and marks the graphs finished.
+    Independent metrics thus run in parallel on different stage threads, and a graph only runs the
+    stages of the metrics its client requested.
+*/
 class Pipeline
 {
 private:
     // Private members
-    std::vector<std::shared_ptr<ActiveObject>> stages; // Vector of active objects (we used shared_ptr to avoid memory leaks)
+    std::vector<std::shared_ptr<ActiveObject>> stages; // Vector of active objects - start, metric stages by branch, finish
     std::mutex mtx;                                // Mutex for the pipe
+    std::vector<std::vector<int>> layout;          // Metric ids of each branch, in order
+    MetricRegistry::MetricSet layoutMetrics;       // Metrics some stage computes
+    size_t batchSize;                              // Tasks a stage takes and hands over per lock acquisition
+    bool adaptiveFusion;                           // Stages run cheap next stages inline
 
     // Private methods
     void createAOStages(); // Setup the pipe with active objects
-    void setAONextStage(); // Set the next stage for each active object
+    void setAONextStage(); // Connect the stages - start forks into the branches, finish joins them
     void setTaskHandler(); // Set the task handler for each active object
 
 public:
-    Pipeline();
+    Pipeline(const std::string &layout = DEFAULT_PIPELINE_LAYOUT, size_t batchSize = 1, bool adaptiveFusion = false); // Throws std::invalid_argument on a bad layout
     ~Pipeline();
 
-    void processGraphs(std::vector<std::weak_ptr<Graph>>& graphs); // Process the graphs that sended from the server
+    // Process the graphs that sended from the server - only the stages of the requested metrics run,
+    // and a cancelled token drops the graphs at the next stage boundary
+    void processGraphs(std::vector<std::weak_ptr<Graph>>& graphs, std::shared_ptr<const CancellationToken> cancellation = nullptr,
+                       MetricRegistry::MetricSet metrics = ~MetricRegistry::MetricSet(0));
+    MetricRegistry::MetricSet getMetrics() const; // Metrics the layout computes
+    std::string getStatistics() const;            // Statistics summary of all stages
 };
 
-#endif
\ No newline at end of file
+#endif
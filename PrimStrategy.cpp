@@ -1,32 +1,31 @@
 #include "PrimStrategy.hpp"
-#include <iostream>
+#include "CancellationToken.hpp"
 #include <algorithm>
 
-std::unique_ptr<std::vector<std::vector<int>>> PrimStrategy::computeMST(const std::vector<std::vector<int>> &graphAdjacencyMatrix)
+template <typename Weight, typename NoEdge>
+std::unique_ptr<BasicAdjacencyMatrix<Weight>> BasicPrimStrategy<Weight, NoEdge>::computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource)
 {
-    {
-        std::lock_guard<std::mutex> cout_lock(cout_mtx);
-        std::cout << "Strategy Activated - Start Compute MST using Prim" << std::endl;
-    }
+    LOG_DEBUG("Strategy Activated - Start Compute MST using Prim");
     int numVertices = graphAdjacencyMatrix.size();
     
     if (numVertices == 0)
         return nullptr;
 
-    std::vector<int> minEdgeToVertex(numVertices, std::numeric_limits<int>::max());
-    std::vector<int> parentVertex(numVertices, -1);
-    std::vector<bool> isInMST(numVertices, false);
-    std::priority_queue<std::pair<int, int>,
-                        std::vector<std::pair<int, int>>,
-                        std::greater<std::pair<int, int>>>
-        minEdgeQueue;
+    ScratchArena::Scope scratch; // Working buffers are reused by this thread across requests
+    std::pmr::vector<Weight> minEdgeToVertex(numVertices, std::numeric_limits<Weight>::max(), scratch.resource());
+    std::pmr::vector<int> parentVertex(numVertices, -1, scratch.resource());
+    std::pmr::vector<bool> isInMST(numVertices, false, scratch.resource());
+    std::priority_queue<std::pair<Weight, int>,
+                        std::pmr::vector<std::pair<Weight, int>>,
+                        std::greater<std::pair<Weight, int>>>
+        minEdgeQueue(std::greater<std::pair<Weight, int>>(), std::pmr::vector<std::pair<Weight, int>>(scratch.resource()));
 
     // Find the first non-isolated vertex
     int startVertex = 0;
     for (int i = 0; i < numVertices; ++i)
     {
-        if (std::any_of(graphAdjacencyMatrix[i].begin(), graphAdjacencyMatrix[i].end(), [](int w)
-                        { return w != 0; }))
+        if (std::any_of(graphAdjacencyMatrix[i].begin(), graphAdjacencyMatrix[i].end(), [](Weight w)
+                        { return NoEdge::isEdge(w); }))
         {
             startVertex = i;
             break;
@@ -35,8 +34,8 @@ std::unique_ptr<std::vector<std::vector<int>>> PrimStrategy::computeMST(const st
 
     
 
-    minEdgeToVertex[startVertex] = 0;
-    minEdgeQueue.push({0, startVertex});
+    minEdgeToVertex[startVertex] = std::numeric_limits<Weight>::lowest();
+    minEdgeQueue.push({std::numeric_limits<Weight>::lowest(), startVertex});
 
     while (!minEdgeQueue.empty())
     {
@@ -47,11 +46,12 @@ std::unique_ptr<std::vector<std::vector<int>>> PrimStrategy::computeMST(const st
             continue;
 
         isInMST[currentVertex] = true;
+        CancellationToken::checkpoint(); // Once per vertex added - a row scan of work
 
         for (int adjacentVertex = 0; adjacentVertex < numVertices; ++adjacentVertex)
         {
-            int weight = graphAdjacencyMatrix[currentVertex][adjacentVertex];
-            if (weight != 0 && !isInMST[adjacentVertex] && weight < minEdgeToVertex[adjacentVertex])
+            Weight weight = graphAdjacencyMatrix[currentVertex][adjacentVertex];
+            if (NoEdge::isEdge(weight) && !isInMST[adjacentVertex] && weight < minEdgeToVertex[adjacentVertex])
             {
                 parentVertex[adjacentVertex] = currentVertex;
                 minEdgeToVertex[adjacentVertex] = weight;
@@ -60,21 +60,22 @@ std::unique_ptr<std::vector<std::vector<int>>> PrimStrategy::computeMST(const st
         }
     }
 
-    auto mstMatrix = std::make_unique<std::vector<std::vector<int>>>(
-        numVertices, std::vector<int>(numVertices, 0));
+    auto mstMatrix = std::make_unique<Matrix>(
+        numVertices, std::pmr::vector<Weight>(numVertices, NoEdge::noEdge), resultResource);
 
     for (int vertex = 0; vertex < numVertices; ++vertex)
     {
         int parent = parentVertex[vertex];
         if (parent != -1)
         {
-            int weight = graphAdjacencyMatrix[parent][vertex];
+            Weight weight = graphAdjacencyMatrix[parent][vertex];
             (*mstMatrix)[parent][vertex] = weight;
             (*mstMatrix)[vertex][parent] = weight;
         }
     }
 
-    std::lock_guard<std::mutex> cout_lock(cout_mtx);
-    std::cout << "Finish Compute MST using Prim" << std::endl;
+    LOG_DEBUG("Finish Compute MST using Prim");
     return mstMatrix;
-}
\ No newline at end of file
+}
+
+INSTANTIATE_WEIGHT_POLICIES(BasicPrimStrategy)
@@ -7,9 +7,15 @@
 #include <queue>
 #include <memory>
 
-class PrimStrategy : public MSTStrategy
+template <typename Weight, typename NoEdge = ZeroNoEdge<Weight>>
+class BasicPrimStrategy : public BasicMSTStrategy<Weight, NoEdge>
 {
 public:
-    std::unique_ptr<std::vector<std::vector<int>>> computeMST(const std::vector<std::vector<int>> &graphAdjacencyMatrix) override;
+    using Matrix = BasicAdjacencyMatrix<Weight>;
+
+    std::unique_ptr<Matrix> computeMST(const Matrix &graphAdjacencyMatrix, std::pmr::memory_resource *resultResource) override;
 };
-#endif
\ No newline at end of file
+
+using PrimStrategy = BasicPrimStrategy<int>;
+
+#endif
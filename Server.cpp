@@ -1,62 +1,81 @@
 #include "Server.hpp"
 
-#define PORT 4040
 #define INVALID -1
 #define NO_MST_DATA_CALCULATION -1
+#define FINISH_MST_DATA_CALCULATION 1
+#define LEADER_FOLLOWER_METRICS (MST_TOTAL_WEIGHT | MST_LONGEST_DISTANCE | MST_SHORTEST_DISTANCE | MST_AVERAGE_WEIGHT) // Computed by every Leader-Follower task
+#define MAX_PATH_QUERIES 1000000 // Queries of one batch
+
+static volatile sig_atomic_t stopSignal = 0; // SIGTERM of a worker process
+
+static void handleStopSignal(int)
+{
+    stopSignal = 1;
+}
 
 // Constructor
-Server::Server(): server_fd(INVALID), pipeline(nullptr), leaderfollower(nullptr), stopServer(false)
+Server::Server(const ServerConfig &config)
+    : config(config), stopServer(false), server_fd(INVALID), unix_fd(INVALID), pipeline(nullptr), leaderfollower(nullptr), computeExecutor(nullptr)
 {
+    LOG_INFO("Start Building the Server...");
+    if (config.workerIndex >= 0)
+    {
+        this->sharedStore = SharedGraphStore::attach(config.storeName());
+        Graph::useGraphIDCounter(&this->sharedStore->graphIDCounter()); // Graph ids unique across the workers
+        signal(SIGTERM, handleStopSignal);
+        LOG_INFO("Worker " << config.workerIndex << " (pid " << getpid() << ") attached to " << config.storeName());
+    }
+    NumaTopology::getInstance().setPlacement(config.numaPlacement); // Before the pools below start their threads
+    MSTCostModel::getInstance().calibrate(); // Before any client can ask for the automatic MST algorithm
+    ExternalSortContext::getInstance().configure(static_cast<size_t>(config.externalSortMB) * 1024 * 1024, config.spillDirectory);
+    if (config.memoryBudgetMB > 0 && config.workerIndex < 0)
+    {
+        this->memoryBudget = std::make_unique<GraphMemoryBudget>(static_cast<size_t>(config.memoryBudgetMB) * 1024 * 1024, config.spillDirectory);
+    }
+    this->pipeline = new Pipeline(config.pipelineLayout, config.pipelineBatch, config.pipelineFusion);
+    this->leaderfollower = new LeaderFollower(config.lfScheduler, config.lfSjfSlowdown);
+    this->computeExecutor = new ComputeExecutor(config.mstThreads, config.mstQueueLimit);
+    for (int i = 0; i < config.ioThreads; ++i)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::cout << "Start Building the Server..." << std::endl;
+        this->eventLoops.push_back(EventLoop::create(config.ioBackend, i));
     }
-    this->pipeline = new Pipeline();
-    this->leaderfollower = new LeaderFollower();
     startServer(); // Start the server
 }
 
 // Destructor
 Server::~Server()
 {
+    LOG_INFO("********* START Server Stop Process *********");
+    
+    // Stop the loops first so no session submits to the executor any more, then finish the executor jobs -
+    // they store graphs in the server and post resumptions to the stopped loops - before the sessions are destroyed
+    size_t numSessions = 0;
+    for (const auto &loop : this->eventLoops)
     {
-        std::lock_guard<std::mutex> lock(mtx);
-        std::cout << "\n********* START Server Stop Process *********" << std::endl;
+        loop->joinThread();
+        numSessions += loop->getNumSessions();
     }
-    
+    delete computeExecutor;
+    this->eventLoops.clear(); // Stops the loops, destroys the suspended sessions and closes their sockets
+    LOG_INFO("Server: " << numSessions << " client sessions CLOSED");
     delete pipeline;       // Delete the pipeline object
     delete leaderfollower; // Delete the leaderfollower object
     {
         std::unique_lock<std::mutex> lock(this->mtx);
-        for (auto &client : clients_dataset)
-        {
-            if (client.first >= 0)
-            {
-                lock.unlock();
-                close(client.first);
-                lock.lock();
-            }
-            if (client.second->joinable())
-            {
-                lock.unlock();
-                client.second->join();
-                lock.lock();
-            }
-        }
-        lock.unlock();
-        clients_dataset.clear();
-        lock.lock();
-
-        std::cout << "Server: All clients File Descriptor are CLOSED" << std::endl;
-        std::cout << "Server: All clients Threads are JOINED" << std::endl;
         if (server_fd >= 0)
         {
             lock.unlock();
             close(server_fd);
             lock.lock();
         }
-        std::cout << "Server: Server File Descriptor CLOSE" << std::endl;
-        std::cout << "\n********* FINISH Server Stop Process *********" << std::endl;
+        LOG_INFO("Server: Server File Descriptor CLOSE");
+        if (unix_fd >= 0)
+        {
+            close(unix_fd);
+            unlink(this->config.unixSocketPath().c_str());
+            LOG_INFO("Server: Unix Socket " << this->config.unixSocketPath() << " CLOSE");
+        }
+        LOG_INFO("********* FINISH Server Stop Process *********");
     }
 }
 
@@ -81,7 +100,7 @@ void Server::startServer()
     // Set the address and port number
     address.sin_family = AF_INET;         // IPv4
     address.sin_addr.s_addr = INADDR_ANY; // Any IP address
-    address.sin_port = htons(PORT);       // Port number
+    address.sin_port = htons(this->config.port);       // Port number
 
     // Bind the socket to the address and port number
     if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0)
@@ -91,19 +110,47 @@ void Server::startServer()
     }
 
     // Listen for incoming connections
-    if (listen(server_fd, 3) < 0)
+    if (listen(server_fd, SOMAXCONN) < 0) // Sessions are cheap - do not refuse bursts of connections
     {
         perror("listen");
         exit(EXIT_FAILURE);
     }
+    LOG_INFO("Server started listening on port " << this->config.port);
+    if (!this->config.unixSocket.empty())
     {
-        std::lock_guard<std::mutex> lock(this->mtx);
-        std::cout << "Server started listening on port " << PORT << std::endl;
+        startUnixListener();
     }
     // Handle incoming connections
     this->handleConnections();
 }
 
+// Listen for local clients handing off graphs in a memfd
+void Server::startUnixListener()
+{
+    std::string path = this->config.unixSocketPath();
+    struct sockaddr_un unixAddress{};
+    unixAddress.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(unixAddress.sun_path))
+    {
+        LOG_ERROR("Unix socket path too long: " << path);
+        return;
+    }
+    strcpy(unixAddress.sun_path, path.c_str());
+    unlink(path.c_str()); // Left over by a previous run
+    if ((unix_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)) < 0 ||
+        bind(unix_fd, (struct sockaddr *)&unixAddress, sizeof(unixAddress)) < 0 || listen(unix_fd, SOMAXCONN) < 0)
+    {
+        LOG_ERROR("Unix socket " << path << " failed: " << strerror(errno));
+        if (unix_fd >= 0)
+        {
+            close(unix_fd);
+            unix_fd = INVALID;
+        }
+        return;
+    }
+    LOG_INFO("Server started listening on unix socket " << path);
+}
+
 // handle client connections
 void Server::handleConnections()
 {
@@ -111,13 +158,31 @@ void Server::handleConnections()
     fd_set readfds;
     struct timeval timeout;
     int stdin_fd = fileno(stdin);
-    int max_fd = std::max(server_fd, stdin_fd);
+    bool worker = this->sharedStore != nullptr; // The console belongs to the supervisor
+    int max_fd = std::max({server_fd, stdin_fd, unix_fd});
+
+    // An io_uring loop accepts the connections itself - the main thread only reads the console then
+    bool loopAccepts = this->eventLoops[0]->startAccept(server_fd, [this](int new_socket)
+    {
+        LOG_INFO("New client connected!");
+        startSession(new_socket);
+    });
 
-    while (!stopServer)
+    while (!stopServer && !stopSignal)
     {                      // Loop until the server is stopped
         FD_ZERO(&readfds); // Clear the file descriptor set
-        FD_SET(server_fd, &readfds);
-        FD_SET(stdin_fd, &readfds);
+        if (!loopAccepts)
+        {
+            FD_SET(server_fd, &readfds);
+        }
+        if (!worker)
+        {
+            FD_SET(stdin_fd, &readfds);
+        }
+        if (unix_fd >= 0)
+        {
+            FD_SET(unix_fd, &readfds);
+        }
 
         // Set timeout to 1 second
         timeout.tv_sec = 1;
@@ -131,23 +196,65 @@ void Server::handleConnections()
             perror("select error");
             continue;
         }
+        if (worker)
+        {
+            syncSharedStore(); // At least once a second - results become visible to the other workers
+        }
+        if (activity <= 0)
+        {
+            continue; // Timeout or signal - the sets are not valid
+        }
 
         // Check for keyboard input
-        if (FD_ISSET(stdin_fd, &readfds))
+        if (!worker && FD_ISSET(stdin_fd, &readfds))
         { // Check if the file descriptor is set
             std::string command;
             std::getline(std::cin, command); // Get the command from the user
             if (command == "stop")
             {
-                std::lock_guard<std::mutex> lock(this->mtx);
-                std::cout << "Command: " << command << std::endl;
+                LOG_INFO("Command: " << command);
                 stopServer = true;
                 break;
             }
+            else if (command == "stats")
+            {
+                std::string report = collectStatistics();
+                Logger::getInstance().flush(); // Keep the report after the pending log lines
+                std::cout << report << std::flush;
+            }
+            else if (command == "memory")
+            {
+                std::string report = this->memoryBudget != nullptr ? this->memoryBudget->memoryReport()
+                                                                   : "No graph memory budget (start with --memory-budget-mb=N)\n";
+                Logger::getInstance().flush();
+                std::cout << report << std::flush;
+            }
+            else if (command.rfind("trace start", 0) == 0)
+            {
+                std::string path = command.size() > 12 ? command.substr(12) : "trace.json";
+                Tracer::getInstance().start(path);
+            }
+            else if (command == "trace stop")
+            {
+                Tracer::getInstance().stop();
+            }
+            else if (command.rfind("loglevel", 0) == 0)
+            {
+                int level = Logger::parseLevel(command.size() > 9 ? command.substr(9) : "");
+                if (level < 0)
+                {
+                    LOG_WARN("Usage: loglevel debug|info|warn|error|off (current: " << Logger::levelName(Logger::getInstance().getLevel()) << ")");
+                }
+                else
+                {
+                    Logger::getInstance().setLevel(level);
+                    LOG_WARN("Log level set to " << Logger::levelName(level));
+                }
+            }
         }
 
         // Check for new connections
-        if (FD_ISSET(server_fd, &readfds))
+        if (!loopAccepts && FD_ISSET(server_fd, &readfds))
         {                                                                                           // Check if the file descriptor is set
             int new_socket = accept(server_fd, (struct sockaddr *)&address, (socklen_t *)&addrlen); // Accept the connection
             if (new_socket < 0)
@@ -155,24 +262,201 @@ void Server::handleConnections()
                 perror("accept failed");
                 continue;
             }
-        
-            std::lock_guard<std::mutex> lock(this->mtx); // Lock the mutex because we are modifying the clients vector
-            std::cout << "New client connected!" << std::endl;
-            auto client_thread = std::make_unique<std::thread>(&Server::handleRequest, this, new_socket);
-            clients_dataset.emplace_back(new_socket, std::move(client_thread)); // Add client to the list (unique ptr owner is being moved)
-            std::cout << "Client has Added to the Clients list!" << std::endl;
+
+            LOG_INFO("New client connected!");
+            startSession(new_socket);
+        }
+
+        // Check for new local clients
+        if (unix_fd >= 0 && FD_ISSET(unix_fd, &readfds))
+        {
+            int new_socket = accept4(unix_fd, NULL, NULL, SOCK_CLOEXEC);
+            if (new_socket < 0)
+            {
+                perror("accept failed");
+                continue;
+            }
+            LOG_INFO("New local client connected!");
+            startSession(new_socket, true);
         }
     }
 }
 
-void Server::handleRequest(int client_FD)
+// Start the session of a new client on the next event loop (round robin)
+void Server::startSession(int client_FD, bool local)
+{
+    EventLoop &loop = *this->eventLoops[this->nextEventLoop++ % this->eventLoops.size()];
+    loop.spawn(client_FD, local ? handleLocalRequest(client_FD, loop) : handleRequest(client_FD, loop));
+    LOG_DEBUG("Client session started on its event loop!");
+}
+
+// Local client session: every request hands over a graph memfd and gets back a result memfd
+Task<void> Server::handleLocalRequest(int client_FD, EventLoop &loop)
 {
-    if (client_FD < 0)
+    while (true)
     {
-        std::perror("Error: Invalid client file descriptor.");
+        // Request with the graph memfd attached
+        GraphHandoff::Request request{};
+        char control[CMSG_SPACE(sizeof(int))];
+        struct iovec requestData{&request, sizeof(request)};
+        struct msghdr message{};
+        message.msg_iov = &requestData;
+        message.msg_iovlen = 1;
+        message.msg_control = control;
+        message.msg_controllen = sizeof(control);
+        ssize_t received = co_await loop.receiveMsg(client_FD, &message);
+        if (received <= 0)
+        {
+            break;
+        }
+        int graphFD = INVALID;
+        struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+        if (header != nullptr && header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+        {
+            memcpy(&graphFD, CMSG_DATA(header), sizeof(int));
+        }
+        while (received > 0 && received < static_cast<ssize_t>(sizeof(request))) // Stream socket - the rest may come later
+        {
+            ssize_t bytes = co_await loop.read(client_FD, reinterpret_cast<char *>(&request) + received, sizeof(request) - received);
+            received = bytes > 0 ? received + bytes : -1;
+        }
+        if (received < 0)
+        {
+            if (graphFD >= 0) close(graphFD);
+            break;
+        }
+
+        GraphHandoff::Response response{HANDOFF_REQUEST_MAGIC, GraphHandoff::Ok, -1, 0};
+        int resultFD = INVALID;
+        if (request.magic != HANDOFF_REQUEST_MAGIC || request.version != HANDOFF_VERSION || graphFD < 0 ||
+            (request.algorithm < GraphHandoff::Prim || request.algorithm > GraphHandoff::Auto))
+        {
+            response.status = GraphHandoff::InvalidRequest;
+        }
+        else
+        {
+            // Mapping, MST and MST data run on the compute executor - the graph may be large
+            std::shared_ptr<Graph> graph;
+            std::string error;
+            bool accepted = co_await loop.offload(*this->computeExecutor, TRACE_NO_GRAPH, [this, &graph, &error, &resultFD, &request, graphFD]()
+            {
+                try
+                {
+                    graph = GraphHandoff::readGraph(graphFD);
+                    graph->reorderVertices(this->config.vertexOrder);
+                    graph->setMSTStrategy(MSTFactory::createMSTStrategy(request.algorithm == GraphHandoff::Prim      ? MSTFactory::AlgorithmType::Prim
+                                                                        : request.algorithm == GraphHandoff::Kruskal ? MSTFactory::AlgorithmType::Kruskal
+                                                                                                                     : MSTFactory::AlgorithmType::Auto));
+                    graph->activateMSTStrategy();
+                    if (graph->getValidationMSTExist())
+                    {
+                        graph->setMSTDataCalculationNextStatus();
+                        graph->setMSTTotalWeight();
+                        graph->setMSTLongestDistance();
+                        graph->setMSTShortestDistance();
+                        graph->setMSTAvgEdgeWeight();
+                        graph->setMSTDataCalculationNextStatus();
+                        resultFD = GraphHandoff::writeResult(*graph);
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    error = e.what();
+                }
+            });
+            if (!accepted)
+            {
+                response.status = GraphHandoff::ServerBusy;
+            }
+            else if (!error.empty())
+            {
+                LOG_WARN("Local client: graph handoff rejected: " << error);
+                response.status = GraphHandoff::InvalidRequest;
+            }
+            else
+            {
+                response.graphID = graph->getGraphID();
+                if (resultFD >= 0)
+                {
+                    storeComputedGraph(graph);
+                }
+                else
+                {
+                    response.status = GraphHandoff::NoMST;
+                }
+            }
+        }
+        if (graphFD >= 0)
+        {
+            close(graphFD);
+        }
+
+        // Response with the result memfd attached
+        char responseControl[CMSG_SPACE(sizeof(int))] = {};
+        struct iovec responseData{&response, sizeof(response)};
+        struct msghdr reply{};
+        reply.msg_iov = &responseData;
+        reply.msg_iovlen = 1;
+        if (resultFD >= 0)
+        {
+            reply.msg_control = responseControl;
+            reply.msg_controllen = sizeof(responseControl);
+            struct cmsghdr *resultHeader = CMSG_FIRSTHDR(&reply);
+            resultHeader->cmsg_level = SOL_SOCKET;
+            resultHeader->cmsg_type = SCM_RIGHTS;
+            resultHeader->cmsg_len = CMSG_LEN(sizeof(int));
+            memcpy(CMSG_DATA(resultHeader), &resultFD, sizeof(int));
+        }
+        ssize_t sent = co_await loop.sendMsg(client_FD, &reply);
+        if (resultFD >= 0)
+        {
+            close(resultFD);
+        }
+        if (sent < 0 || (sent < static_cast<ssize_t>(sizeof(response)) &&
+                         !co_await loop.sendAll(client_FD, std::string(reinterpret_cast<char *>(&response) + sent, sizeof(response) - sent))))
+        {
+            break;
+        }
+    }
+    LOG_INFO("Local client disconnected");
+    loop.closeFD(client_FD);
+}
+
+// Graphs of the local clients arrive with their MST data - stored as processed
+void Server::storeComputedGraph(std::shared_ptr<Graph> graph)
+{
+    if (this->sharedStore != nullptr)
+    {
+        if (this->sharedStore->publish(*graph, this->config.workerIndex))
+        {
+            this->sharedStore->complete(*graph);
+        }
         return;
     }
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        graph->markStored();
+        this->vec_SharedPtrGraphs.push_back(graph);
+    }
+    accountStoredGraph(graph);
+}
+
+// Outside mtx - adding a graph may spill others to disk
+void Server::accountStoredGraph(const std::shared_ptr<Graph> &graph)
+{
+    if (this->memoryBudget != nullptr)
+    {
+        graph->setMemoryBudget(this->memoryBudget.get());
+    }
+}
 
+Task<void> Server::handleRequest(int client_FD, EventLoop &loop)
+{
+    ClientSession client{client_FD, loop};
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_mailboxes);
+        this->clientMailboxes[client_FD] = std::make_shared<ClientMailbox>();
+    }
     char buffer[1024];
     std::string menu =
         "\nMenu:\n"
@@ -180,6 +464,11 @@ void Server::handleRequest(int client_FD)
         "2. Send Data to Pipeline and Active Objects\n"
         "3. Send Data to Leader-Follower\n"
         "4. Print MST Graphs Data\n"
+        "5. Print Pipeline and Leader-Follower Statistics\n"
+        "6. Generate a Synthetic Graph\n"
+        "7. Query MST Paths (Distance and Bottleneck Edge)\n"
+        "8. MST Sensitivity Analysis and Second-Best MST\n"
+        "9. Send Data to Pipeline with Selected Metrics\n"
         "0. Exit\n"
         "\nChoice: ";
 
@@ -187,13 +476,18 @@ void Server::handleRequest(int client_FD)
     {
         try
         {
-            sendMessage(client_FD, menu);            // Send the menu to the client
-            memset(buffer, 0, sizeof(buffer));       // Clear the buffer
-            read(client_FD, buffer, sizeof(buffer)); // Read the client's choice
+            co_await sendPendingNotices(client);                // Results of the MST computations finished meanwhile
+            co_await sendMessage(client, menu);                 // Send the menu to the client
+            memset(buffer, 0, sizeof(buffer));                  // Clear the buffer
+            if (co_await loop.read(client_FD, buffer, sizeof(buffer) - 1) <= 0) // Read the client's choice
+            {
+                stopClient(client); // The client disconnected
+                co_return;
+            }
         
             int choice = 0;
             choice = std::stoi(buffer);
-            if (choice < 0 || choice > 4)
+            if (choice < 0 || choice > 9)
             {
                 continue;
             }
@@ -201,30 +495,55 @@ void Server::handleRequest(int client_FD)
             switch (choice)
             {
                 case 0:
-                    stopClient(client_FD);
-                    return;
+                    stopClient(client);
+                    co_return;
 
                 case 1:
-                    graphCreation(client_FD);
+                    co_await graphCreation(client);
                     break;
 
                 case 2:
-                    sendDataToPipeline(client_FD);
+                    co_await sendDataToPipeline(client);
                     break;
 
                 case 3:
-                    sendDataToLeaderFollower(client_FD);
+                    co_await sendDataToLeaderFollower(client);
                     break;
 
                 case 4:
-                    sendMSTDataToClient(client_FD);
+                    co_await sendMSTDataToClient(client);
+                    break;
+
+                case 5:
+                    co_await sendStatisticsToClient(client);
+                    break;
+
+                case 6:
+                    co_await graphGeneration(client);
+                    break;
+
+                case 7:
+                    co_await queryMSTPaths(client);
+                    break;
+
+                case 8:
+                    co_await sendMSTSensitivityToClient(client);
+                    break;
+
+                case 9:
+                    co_await sendSelectedMetricsToPipeline(client);
                     break;
 
                 default:
-                    sendMessage(client_FD, "Invalid choice. Please try again.\n");
+                    co_await sendMessage(client, "Invalid choice. Please try again.\n");
                     break;
             }
         }
+        catch (const ClientDisconnected &)
+        {
+            stopClient(client);
+            co_return;
+        }
         catch (const std::exception &e)
         {
             continue;
@@ -233,40 +552,47 @@ void Server::handleRequest(int client_FD)
 }
 
 
-// Send a message to the client
-void Server::sendMessage(int client_FD, const std::string message)
+// Send a message to the client - suspends only while the socket buffer is full
+Task<void> Server::sendMessage(ClientSession &client, std::string message)
 {
-    if (client_FD < 0)
+    if (client.fd < 0)
     {
         std::perror("Error: Invalid client file descriptor.");
-        return;
+        co_return;
     }
-    send(client_FD, message.c_str(), message.size(), 0);
+    co_await client.loop.sendAll(client.fd, std::move(message)); // A failed send shows up as a closed connection on the next read
 }
 
-void Server::graphCreation(int client_FD)
+Task<void> Server::graphCreation(ClientSession &client)
 {
-    sendMessage(client_FD, "Enter the number of vertices: ");
-    int numVertices = getIntegerInputFromClient(client_FD);
+    TraceSpan span("graphCreation", "server");
+    co_await sendMessage(client, "Enter the number of vertices: ");
+    int numVertices = co_await getIntegerInputFromClient(client);
 
     if (numVertices <= 1)
     {
-        sendMessage(client_FD, "Invalid number of vertices.\n");
-        return;
+        co_await sendMessage(client, "Invalid number of vertices.\n");
+        co_return;
     }
 
     auto graph = std::make_shared<Graph>(numVertices);
+    span.setGraphID(graph->getGraphID());
     int numEdges = -1;
     while(numEdges < 0)
     {
+        bool invalidInput = false; // co_await is not allowed inside a handler
         try
         {
-            sendMessage(client_FD, "Enter the number of edges: ");
-            numEdges = getIntegerInputFromClient(client_FD);
+            co_await sendMessage(client, "Enter the number of edges: ");
+            numEdges = co_await getIntegerInputFromClient(client);
         }
         catch (const std::exception &e)
         {
-            sendMessage(client_FD, "Invalid number of edges.\n");
+            invalidInput = true;
+        }
+        if (invalidInput)
+        {
+            co_await sendMessage(client, "Invalid number of edges.\n");
             continue;
         }
     }
@@ -274,20 +600,25 @@ void Server::graphCreation(int client_FD)
     for (int i = 0; i < numEdges; ++i)
     {
         int src = -1, dest = -1, weight = -1;
-        while((src < 0 || src >= numVertices) || (dest < 0 || dest >= numVertices))
+        while((src < 0 || src >= numVertices) || (dest < 0 || dest >= numVertices) || weight < 0) // Negative weights break the distance metrics
         {
+            bool invalidInput = false;
             try
             {
-                sendMessage(client_FD, "Edge - Enter Source / From: ");
-                src = getIntegerInputFromClient(client_FD);
-                sendMessage(client_FD, "Edge - Enter Destination / To: ");
-                dest = getIntegerInputFromClient(client_FD);
-                sendMessage(client_FD, "Edge - Enter Weight: ");
-                weight = getIntegerInputFromClient(client_FD);
+                co_await sendMessage(client, "Edge - Enter Source / From: ");
+                src = co_await getIntegerInputFromClient(client);
+                co_await sendMessage(client, "Edge - Enter Destination / To: ");
+                dest = co_await getIntegerInputFromClient(client);
+                co_await sendMessage(client, "Edge - Enter Weight: ");
+                weight = co_await getIntegerInputFromClient(client);
             }
             catch (const std::exception &e)
             {
-                sendMessage(client_FD, "Invalid vertices in edge.\n");
+                invalidInput = true;
+            }
+            if (invalidInput)
+            {
+                co_await sendMessage(client, "Invalid vertices in edge.\n");
                 continue;  // retry this edge
             }
         }
@@ -296,100 +627,504 @@ void Server::graphCreation(int client_FD)
         src = -1, dest = -1, weight = -1;  // Reset the values
     }
 
-    std::unique_ptr<MSTStrategy> algorithmType;
+    graph->setMSTStrategy(co_await chooseMSTStrategy(client));  // Set the chosen algorithm
+    co_await storeGraph(client, graph);
+}
+
+// Ask the client for the MST algorithm until a valid choice is given
+Task<std::unique_ptr<MSTStrategy>> Server::chooseMSTStrategy(ClientSession &client)
+{
     while (true)
     {
-        sendMessage(client_FD, "Choose MST algorithm:\n"                                
+        co_await sendMessage(client, "Choose MST algorithm:\n"                                
                             "1. Prim's Algorithm\n"
-                           "2. Kruskal's Algorithm\nChoice: ");
-        int algorithmChoice = getIntegerInputFromClient(client_FD);
+                           "2. Kruskal's Algorithm\n"
+                           "3. Automatic (fastest for the graph)\n"
+                           "4. External-memory Kruskal (edges sorted on disk)\nChoice: ");
+        int algorithmChoice = co_await getIntegerInputFromClient(client);
         
         if (algorithmChoice == 1)
         {
-            algorithmType = std::move(MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::Prim));
-            break;
+            co_return MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::Prim);
         }
         else if (algorithmChoice == 2)
         {
-            algorithmType = std::move(MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::Kruskal));
-            break;
+            co_return MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::Kruskal);
         }
-        else
+        else if (algorithmChoice == 3)
         {
-            sendMessage(client_FD, "Invalid algorithm choice.\n");
-            continue;
+            co_return MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::Auto);
+        }
+        else if (algorithmChoice == 4)
+        {
+            co_return MSTFactory::createMSTStrategy(MSTFactory::AlgorithmType::ExternalKruskal);
         }
+        co_await sendMessage(client, "Invalid algorithm choice.\n");
     }
+}
+
+// Submit the MST computation to the compute executor - the graph is stored as unprocessed when it finishes
+// The session does not wait, the result is delivered to the client before its next menu
+Task<void> Server::storeGraph(ClientSession &client, std::shared_ptr<Graph> graph)
+{
+    int graphID = graph->getGraphID();
+    graph->setOwnerID(client.fd); // Tenant of the graph for fair scheduling
+    std::weak_ptr<ClientMailbox> mailbox = getMailbox(client.fd);
+    bool accepted = this->computeExecutor->trySubmit(graphID, [this, graph, mailbox, graphID]()
+    {
+        std::shared_ptr<Graph> original;
+        std::string cancelled; // Reason the computation was dropped (empty - it ran)
+        try
+        {
+            CancellationToken::checkpoint(); // The deadline may have passed in the queue
+            if (this->sharedStore == nullptr)
+            {
+                original = storeIdenticalGraph(*graph, nullptr); // Same edges as a stored graph - no MST to compute
+            }
+            if (original == nullptr)
+            {
+                graph->reorderVertices(this->config.vertexOrder);
+                graph->activateMSTStrategy();  // Store the graph along with the chosen algorithm
+            }
+        }
+        catch (const JobCancelled &e)
+        {
+            cancelled = e.what();
+        }
+
+        std::string notice;
+        if (!cancelled.empty())
+        {
+            notice = "MST computation of graph " + std::to_string(graphID) + " dropped (" + cancelled + "), the graph was not stored.\n";
+        }
+        else if (original != nullptr)
+        {
+            notice = sharedCopyNotice(graphID, original->getGraphID());
+        }
+        else if (graph->getValidationMSTExist() && this->sharedStore != nullptr)
+        {
+            // Worker - the graph is processed by whichever worker claims it from the shared store
+            if (this->sharedStore->publish(*graph, this->config.workerIndex))
+            {
+                std::lock_guard<std::mutex> lock(this->mtx);
+                graph->markStored();
+                this->vec_SharedPtrGraphs.push_back(graph); // Claimed without rebuilding if this worker claims it
+                notice = "Graph " + std::to_string(graphID) + " created and stored.\n";
+            }
+            else
+            {
+                notice = "Shared graph store is full, graph " + std::to_string(graphID) + " was not stored.\n";
+            }
+        }
+        else if (graph->getValidationMSTExist())
+        {
+            // An identical graph may have finished while this one was computed
+            original = storeIdenticalGraph(*graph, [this, &graph]()
+            {
+                graph->markStored();
+                this->vec_SharedPtrGraphs.push_back(graph);
+                this->vec_WeakPtrGraphs_Unprocessed.push_back(graph);
+                this->graphsByContent[graph->getContentHash()].push_back(graph);
+            });
+            if (original == nullptr)
+            {
+                accountStoredGraph(graph);
+            }
+            notice = original == nullptr ? "Graph " + std::to_string(graphID) + " created and stored.\n" : sharedCopyNotice(graphID, original->getGraphID());
+        }
+        else
+        {
+            notice = "MST does not exist for graph " + std::to_string(graphID) + ".\n";
+        }
 
-    graph->setMSTStrategy(std::move(algorithmType));  // Set the chosen algorithm
-    graph->activateMSTStrategy();  // Store the graph along with the chosen algorithm
+        if (auto clientMailbox = mailbox.lock()) // The client may have disconnected meanwhile
+        {
+            std::lock_guard<std::mutex> lock(clientMailbox->mtx);
+            clientMailbox->notices.push_back(notice);
+        }
+        if (!cancelled.empty())
+        {
+            throw JobCancelled(cancelled); // Counted as cancelled by the executor
+        }
+    }, jobCancellation(client.fd));
 
-    if (graph->getValidationMSTExist())
+    if (accepted)
     {
-        std::lock_guard<std::mutex> lock(this->mtx);
-        this->vec_SharedPtrGraphs.push_back(graph);
-        this->vec_WeakPtrGraphs_Unprocessed.push_back(graph);
-        sendMessage(client_FD, "Graph created and stored.\n");
+        co_await sendMessage(client, "Graph " + std::to_string(graphID) + " accepted, computing MST.\n");
     }
     else
     {
-        graph.reset();
-        sendMessage(client_FD, "MST does not exist for the given graph.\n");
+        LOG_WARN("Server busy - MST computation of graph " << graphID << " rejected");
+        co_await sendMessage(client, "Server busy, graph " + std::to_string(graphID) + " was not stored. Try again later.\n");
+    }
+}
+
+// Store a stored graph with the same content again - the new graph is dropped
+// Both entries share one adjacency matrix, MST and MST data, so the metrics are computed once
+// The matrices are compared without mtx (a comparison pins both graphs, which may read a spill file or spill
+// other graphs); mtx is only held to snapshot the candidates and to store the result. storeUnique (may be
+// empty) stores the graph under mtx when nothing matches - graphs stored meanwhile are compared first
+std::shared_ptr<Graph> Server::storeIdenticalGraph(const Graph &graph, const std::function<void()> &storeUnique)
+{
+    std::vector<std::shared_ptr<Graph>> compared;
+    while (true)
+    {
+        std::vector<std::shared_ptr<Graph>> candidates;
+        {
+            std::lock_guard<std::mutex> lock(this->mtx);
+            auto bucket = this->graphsByContent.find(graph.getContentHash());
+            if (bucket != this->graphsByContent.end())
+            {
+                for (const auto &candidate : bucket->second)
+                {
+                    auto original = candidate.lock();
+                    if (original != nullptr && std::find(compared.begin(), compared.end(), original) == compared.end())
+                    {
+                        candidates.push_back(std::move(original));
+                    }
+                }
+            }
+            if (candidates.empty())
+            {
+                if (storeUnique)
+                {
+                    storeUnique();
+                }
+                return nullptr;
+            }
+        }
+        for (auto &original : candidates)
+        {
+            if (original->hasSameContent(graph))
+            {
+                std::lock_guard<std::mutex> lock(this->mtx); // Stored graphs are never changed or removed - no re-check needed
+                this->vec_SharedPtrGraphs.push_back(original);
+                this->deduplicatedGraphs.fetch_add(1, std::memory_order_relaxed);
+                LOG_DEBUG("Graph " << graph.getGraphID() << " is identical to graph " << original->getGraphID() << " - sharing it");
+                return original;
+            }
+            compared.push_back(std::move(original));
+        }
     }
 }
 
-void Server::sendDataToPipeline(int client_FD)
+// The client chose an algorithm for the new graph, but it gets the stored graph with its MST
+std::string Server::sharedCopyNotice(int graphID, int originalID)
 {
-    if(this->vec_WeakPtrGraphs_Unprocessed.size() > 0) filterUnprocessedGraphs();
-    this->pipeline->processGraphs(this->vec_WeakPtrGraphs_Unprocessed);
-    sendMessage(client_FD, "All graphs have been sent to Pipeline for processing using Active Object.\n");
+    return "Graph " + std::to_string(graphID) + " is identical to graph " + std::to_string(originalID) +
+           ", stored as a shared copy of it: the MST of graph " + std::to_string(originalID) +
+           " is reused and the algorithm chosen for graph " + std::to_string(graphID) + " is not run.\n";
 }
 
-void Server::sendDataToLeaderFollower(int client_FD)
+std::shared_ptr<Server::ClientMailbox> Server::getMailbox(int client_FD)
 {
-    if(this->vec_WeakPtrGraphs_Unprocessed.size() > 0) filterUnprocessedGraphs();
-    this->leaderfollower->processGraphs(this->vec_WeakPtrGraphs_Unprocessed);
-    sendMessage(client_FD, "All graphs have been sent to Leader-Follower for processing.\n");
+    std::lock_guard<std::mutex> lock(this->mtx_mailboxes);
+    auto mailbox = this->clientMailboxes.find(client_FD);
+    return mailbox != this->clientMailboxes.end() ? mailbox->second : nullptr;
 }
 
-void Server::filterUnprocessedGraphs()
+std::shared_ptr<const CancellationToken> Server::jobCancellation(int client_FD)
 {
+    auto mailbox = getMailbox(client_FD);
+    return CancellationToken::forJob(std::chrono::milliseconds(this->config.jobDeadlineMs), mailbox != nullptr ? mailbox->session : nullptr);
+}
+
+Task<void> Server::sendPendingNotices(ClientSession &client)
+{
+    auto mailbox = getMailbox(client.fd);
+    if (mailbox == nullptr)
+    {
+        co_return;
+    }
+    std::vector<std::string> notices;
+    {
+        std::lock_guard<std::mutex> lock(mailbox->mtx);
+        notices.swap(mailbox->notices);
+    }
+    for (const auto &notice : notices)
+    {
+        co_await sendMessage(client, notice);
+    }
+}
+
+Task<void> Server::graphGeneration(ClientSession &client)
+{
+    TraceSpan span("graphGeneration", "server");
+    GraphGenerator::Parameters parameters;
+    co_await sendMessage(client, "Choose graph generator:\n"
+                                 "1. Erdos-Renyi\n"
+                                 "2. 2D Grid\n"
+                                 "3. Complete\n"
+                                 "4. Random Geometric\n"
+                                 "5. R-MAT (power-law)\nChoice: ");
+    parameters.type = static_cast<GraphGenerator::GeneratorType>(co_await getIntegerInputFromClient(client));
+    co_await sendMessage(client, "Enter the number of vertices: ");
+    parameters.numVertices = co_await getIntegerInputFromClient(client);
+    co_await sendMessage(client, "Enter the density in per mille (1-1000): ");
+    parameters.density = co_await getIntegerInputFromClient(client) / 1000.0;
+    co_await sendMessage(client, "Enter the seed: ");
+    parameters.seed = static_cast<uint64_t>(co_await getIntegerInputFromClient(client));
+    co_await sendMessage(client, "Choose weight distribution:\n"
+                                 "1. Uniform\n"
+                                 "2. Exponential\n"
+                                 "3. Normal\nChoice: ");
+    parameters.weights = static_cast<GraphGenerator::WeightDistribution>(co_await getIntegerInputFromClient(client));
+    co_await sendMessage(client, "Enter the minimum weight: ");
+    parameters.minWeight = co_await getIntegerInputFromClient(client);
+    co_await sendMessage(client, "Enter the maximum weight: ");
+    parameters.maxWeight = co_await getIntegerInputFromClient(client);
+
+    // Generation runs on the compute executor so the event loop keeps serving the other clients
+    std::shared_ptr<Graph> graph;
+    std::string error;
+    auto start = std::chrono::steady_clock::now();
+    bool accepted = co_await client.loop.offload(*this->computeExecutor, TRACE_NO_GRAPH, [&graph, &error, &parameters]()
+    {
+        try
+        {
+            graph = GraphGenerator::generate(parameters);
+        }
+        catch (const std::exception &e)
+        {
+            error = e.what();
+        }
+    });
+    if (!accepted)
+    {
+        co_await sendMessage(client, "Server busy, the graph was not generated. Try again later.\n");
+        co_return;
+    }
+    if (graph == nullptr)
+    {
+        co_await sendMessage(client, "Invalid generator parameters: " + error + "\n");
+        co_return;
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    span.setGraphID(graph->getGraphID());
+    co_await sendMessage(client, "Generated " + GraphGenerator::typeName(parameters.type) + " graph with " + std::to_string(graph->getSizeVertices()) +
+                                 " vertices and " + std::to_string(graph->getSizeEdges()) + " edges in " + std::to_string(elapsed.count()) + " ms.\n");
+
+    graph->setMSTStrategy(co_await chooseMSTStrategy(client));
+    co_await storeGraph(client, graph);
+}
+
+Task<void> Server::sendDataToPipeline(ClientSession &client, MetricRegistry::MetricSet metrics)
+{
+    MetricRegistry::MetricSet computable = metrics & this->pipeline->getMetrics();
+    if (this->sharedStore != nullptr) claimSharedGraphs(computable);
+    std::vector<std::weak_ptr<Graph>> unprocessedGraphs = filterUnprocessedGraphs(computable);
+    traceUnprocessedWait(unprocessedGraphs);
+    this->pipeline->processGraphs(unprocessedGraphs, jobCancellation(client.fd), metrics);
+    co_await sendMessage(client, "All graphs have been sent to Pipeline for processing using Active Object.\n");
+}
+
+// Only the pipeline stages of the chosen metrics run - the O(V^3) distances are skipped unless asked for
+Task<void> Server::sendSelectedMetricsToPipeline(ClientSession &client)
+{
+    const MetricRegistry &registry = MetricRegistry::getInstance();
+    std::string prompt = "Metrics (comma separated, or all):\n";
+    for (size_t id = 0; id < registry.size(); ++id)
+    {
+        prompt += "  " + registry.get(id).name + " - " + registry.get(id).description + "\n";
+    }
+    co_await sendMessage(client, prompt + "Enter the metrics: ");
+    std::string selection = co_await getStringInputFromClient(client);
+    MetricRegistry::MetricSet metrics = 0;
+    std::string error;
+    try
+    {
+        metrics = registry.parseSelection(selection);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        error = e.what();
+    }
+    if (!error.empty())
+    {
+        co_await sendMessage(client, error + "\n");
+        co_return;
+    }
+    if ((metrics & ~this->pipeline->getMetrics()) != 0)
+    {
+        co_await sendMessage(client, "Some of the metrics have no stage in the pipeline layout (--pipeline-layout) and are skipped.\n");
+    }
+    co_await sendDataToPipeline(client, metrics);
+}
+
+Task<void> Server::sendDataToLeaderFollower(ClientSession &client)
+{
+    if (this->sharedStore != nullptr) claimSharedGraphs(LEADER_FOLLOWER_METRICS);
+    std::vector<std::weak_ptr<Graph>> unprocessedGraphs = filterUnprocessedGraphs(LEADER_FOLLOWER_METRICS);
+    traceUnprocessedWait(unprocessedGraphs);
+    this->leaderfollower->processGraphs(unprocessedGraphs, jobCancellation(client.fd));
+    co_await sendMessage(client, "All graphs have been sent to Leader-Follower for processing.\n");
+}
+
+// Executor threads append stored graphs under mtx - filter and copy under it, then submit the copy without the lock
+// Finished graphs that lack some of the requested metrics (an earlier request selected fewer) are reopened and queued again
+std::vector<std::weak_ptr<Graph>> Server::filterUnprocessedGraphs(MetricRegistry::MetricSet metrics)
+{
+    std::lock_guard<std::mutex> lock(this->mtx);
     std::vector<std::weak_ptr<Graph>> tempWeakGraphs;
+    for (const auto &unlockedPtrGraph : this->vec_WeakPtrGraphs_Unprocessed)
     {
-        // locking to get shared and access the graph methods and check the status to filter the one that are not yet processed
-        auto weakGraphs = this->vec_WeakPtrGraphs_Unprocessed;
-        for (const auto &unlockedPtrGraph : weakGraphs)
+        if (auto sharedGraph = unlockedPtrGraph.lock()) // Lock the weak pointer to check validity
         {
-            if (auto sharedGraph = unlockedPtrGraph.lock()) // Lock the weak pointer to check validity
+            if (sharedGraph->getMSTDataStatusCalculation() == NO_MST_DATA_CALCULATION)
             {
-                if (sharedGraph->getMSTDataStatusCalculation() == NO_MST_DATA_CALCULATION)
-                {
-                    tempWeakGraphs.push_back(sharedGraph);  // Add the graph to the temporary vector
-                }
+                tempWeakGraphs.push_back(sharedGraph);  // Add the graph to the temporary vector
             }
         }
     }
     if(this->vec_WeakPtrGraphs_Unprocessed.size() != tempWeakGraphs.size()) {
-        std::lock_guard<std::mutex> lock(this->mtx);
-        this->vec_WeakPtrGraphs_Unprocessed = std::move(tempWeakGraphs);  // prevent copying
-        std::cout << "Unprocessed Graphs are filtered, remain " << tempWeakGraphs.size() <<" graphs to process"<< std::endl;
+        this->vec_WeakPtrGraphs_Unprocessed = tempWeakGraphs;
+        LOG_DEBUG("Unprocessed Graphs are filtered, remain " << this->vec_WeakPtrGraphs_Unprocessed.size() << " graphs to process");
+    }
+
+    // Worker graphs are processed from their shared store claims, not from the local list - claimSharedGraphs() reopens them
+    if (this->sharedStore == nullptr)
+    {
+        std::unordered_set<const Graph *> reopened; // Shared copies of a deduplicated graph appear more than once
+        for (const auto &graph : this->vec_SharedPtrGraphs)
+        {
+            if (graph->getValidationMSTExist() && graph->getMSTDataStatusCalculation() == FINISH_MST_DATA_CALCULATION &&
+                (metrics & ~graph->getComputedMetrics()) != 0 && reopened.insert(graph.get()).second)
+            {
+                graph->reopenMSTDataCalculation();
+                this->vec_WeakPtrGraphs_Unprocessed.push_back(graph);
+                tempWeakGraphs.push_back(graph);
+            }
+        }
+        if (!reopened.empty())
+        {
+            LOG_DEBUG(reopened.size() << " processed graphs lack requested metrics and are queued again");
+        }
     }
+    return tempWeakGraphs;
 }
 
-// Get MST data based on choice
-void Server::sendMSTDataToClient(int client_FD)
+void Server::traceUnprocessedWait(const std::vector<std::weak_ptr<Graph>> &graphs)
 {
-    if (client_FD < 0)
+    if (!Tracer::getInstance().isEnabled())
+    {
+        return;
+    }
+    auto now = std::chrono::steady_clock::now();
+    for (const auto &unprocessedGraph : graphs)
+    {
+        if (auto sharedGraph = unprocessedGraph.lock())
+        {
+            Tracer::getInstance().recordAsync("vec_WeakPtrGraphs_Unprocessed wait", "queue", sharedGraph->getGraphID(), sharedGraph->getStoredTime(), now);
+        }
+    }
+}
+
+// Claim the pending graphs of all the workers, and the done ones that lack some of the requested metrics -
+// graphs of this worker are reused (reopened if finished), the others rebuilt from their edges
+void Server::claimSharedGraphs(MetricRegistry::MetricSet metrics)
+{
+    std::vector<SharedGraphStore::SharedGraph> claimed = this->sharedStore->claimPending(getpid(), metrics);
+    if (claimed.empty())
     {
-        std::perror("Error: Invalid client file descriptor.");
         return;
     }
+    std::lock_guard<std::mutex> lock(this->mtx);
+    for (const auto &sharedGraph : claimed)
+    {
+        std::shared_ptr<Graph> graph;
+        for (const auto &localGraph : this->vec_SharedPtrGraphs)
+        {
+            if (localGraph->getGraphID() == sharedGraph.graphID)
+            {
+                graph = localGraph;
+                break;
+            }
+        }
+        if (graph != nullptr)
+        {
+            graph->reopenMSTDataCalculation(); // Keeps the metrics this worker computed, the others are computed again
+        }
+        if (graph == nullptr || graph->getMSTDataStatusCalculation() != NO_MST_DATA_CALCULATION)
+        {
+            graph = std::make_shared<Graph>(sharedGraph.numVertices, sharedGraph.graphID);
+            for (const WeightedEdge &edge : sharedGraph.edges)
+            {
+                graph->setEdgeUnchecked(edge.u, edge.v, edge.weight);
+            }
+            graph->addEdgeCount(sharedGraph.numEdges);
+            graph->rehashContent();
+            graph->loadMST(sharedGraph.mstEdges);
+        }
+        graph->markStored();
+        this->sharedClaims.push_back(graph);
+        this->vec_WeakPtrGraphs_Unprocessed.push_back(graph);
+    }
+    LOG_INFO("Worker " << this->config.workerIndex << ": claimed " << claimed.size() << " graphs from the shared store");
+}
+
+void Server::syncSharedStore()
+{
+    std::lock_guard<std::mutex> lock(this->mtx);
+    auto claim = this->sharedClaims.begin();
+    while (claim != this->sharedClaims.end())
+    {
+        if ((*claim)->getMSTDataStatusCalculation() == FINISH_MST_DATA_CALCULATION)
+        {
+            this->sharedStore->complete(**claim);
+            claim = this->sharedClaims.erase(claim);
+        }
+        else
+        {
+            ++claim;
+        }
+    }
+}
+
+// MST data of the graphs of every worker, in the order they were stored
+Task<void> Server::sendSharedMSTDataToClient(ClientSession &client)
+{
+    syncSharedStore();
+    int counter = 0;
+    for (const auto &sharedGraph : this->sharedStore->snapshot())
+    {
+        counter++;
+        std::string message = "********* Graph Number " + std::to_string(counter) + " *********.\n ";
+        if (sharedGraph.state != SharedGraphStore::Done)
+        {
+            message += "MST is not computed. Please pass it to Pipeline or Leader-Follower.\n";
+            co_await sendMessage(client, message);
+            continue;
+        }
+        // A client may have requested only some of the metrics
+        auto metric = [&sharedGraph](MSTMetric metric, std::string value) { return (sharedGraph.mstMetrics & metric) ? value : std::string("not computed"); };
+        message += "Weight of the longest path in MST: " + metric(MST_LONGEST_DISTANCE, std::to_string(sharedGraph.mstLongestDistance)) + "\n";
+        message += "Weight of the shortest path in MST: " + metric(MST_SHORTEST_DISTANCE, std::to_string(sharedGraph.mstShortestDistance)) + "\n";
+        message += "Average weight of the edges in MST: " + metric(MST_AVERAGE_WEIGHT, std::to_string(sharedGraph.mstAvgEdgeWeight)) + "\n";
+        message += "Total weight of the MST: " + metric(MST_TOTAL_WEIGHT, std::to_string(sharedGraph.mstTotalWeight)) + "\n";
+        message += "MST Edge Printing (Not Part Of Design Patterns Process):\n" + Graph::formatMSTEdges(sharedGraph.mstEdges);
+        co_await sendMessage(client, message);
+    }
+}
+
+// Get MST data based on choice
+Task<void> Server::sendMSTDataToClient(ClientSession &client)
+{
+    if (this->sharedStore != nullptr)
+    {
+        co_await sendSharedMSTDataToClient(client);
+        co_return;
+    }
     int counter = 0; // Number of graphs start from 1 (increase in every loop - also the first one)
-    for (auto myGraph : this->vec_SharedPtrGraphs)
+    std::vector<std::shared_ptr<Graph>> graphs;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx); // The session suspends while sending - do not iterate the shared vector
+        graphs = this->vec_SharedPtrGraphs;
+    }
+    for (auto myGraph : graphs)
     {
         counter++; // Increase Number of graphs (Starting from 1)
         std::string message = "********* Graph Number " + std::to_string(counter) + " *********.\n ";
-        sendMessage(client_FD, message);
+        co_await sendMessage(client, message);
         if (myGraph == nullptr)
         {
             continue;
@@ -397,40 +1132,249 @@ void Server::sendMSTDataToClient(int client_FD)
         else if (!myGraph->getValidationMSTExist())
         {
             message = "MST Graph does exist, unable show mst data!.\n";
-            sendMessage(client_FD, message);
+            co_await sendMessage(client, message);
             continue;
         }
         else if(myGraph->getMSTDataStatusCalculation() == NO_MST_DATA_CALCULATION)
         {
             message = "MST is not computed. Please pass it to Pipeline or Leader-Follower.\n";
-            sendMessage(client_FD, message);
+            co_await sendMessage(client, message);
             continue;
         }
-        message = "Weight of the longest path in MST: " + std::to_string(myGraph->getMSTLongestDistance()) + "\n";
-        message += "Weight of the shortest path in MST: " + std::to_string(myGraph->getMSTShortestDistance()) + "\n";
-        message += "Average weight of the edges in MST: " + std::to_string(myGraph->getMSTAvgEdgeWeight()) + "\n";
-        message += "Total weight of the MST: " + std::to_string(myGraph->getMSTTotalWeight()) + "\n";
+        // A client may have requested only some of the metrics
+        auto metric = [&myGraph](MSTMetric metric, std::string value) { return myGraph->hasMSTMetric(metric) ? value : std::string("not computed"); };
+        message = "Weight of the longest path in MST: " + metric(MST_LONGEST_DISTANCE, std::to_string(myGraph->getMSTLongestDistance())) + "\n";
+        message += "Weight of the shortest path in MST: " + metric(MST_SHORTEST_DISTANCE, std::to_string(myGraph->getMSTShortestDistance())) + "\n";
+        message += "Average weight of the edges in MST: " + metric(MST_AVERAGE_WEIGHT, std::to_string(myGraph->getMSTAvgEdgeWeight())) + "\n";
+        message += "Total weight of the MST: " + metric(MST_TOTAL_WEIGHT, std::to_string(myGraph->getMSTTotalWeight())) + "\n";
         message += "MST Edge Printing (Not Part Of Design Patterns Process):\n" + myGraph->printMST();
-        sendMessage(client_FD, message);
+        co_await sendMessage(client, message);
+    }
+}
+
+// Path distance and heaviest edge between pairs of vertices of a stored MST
+// The index of a graph is built by its first query, every query takes O(log V)
+Task<void> Server::queryMSTPaths(ClientSession &client)
+{
+    co_await sendMessage(client, "Enter the graph number: ");
+    int graphNumber = co_await getIntegerInputFromClient(client);
+    std::string error;
+    auto storedMST = findStoredMST(graphNumber, false, error);
+    if (!storedMST)
+    {
+        co_await sendMessage(client, error);
+        co_return;
+    }
+    co_await sendMessage(client, "Enter the number of queries: ");
+    int numQueries = co_await getIntegerInputFromClient(client);
+    if (numQueries <= 0 || numQueries > MAX_PATH_QUERIES)
+    {
+        co_await sendMessage(client, "Invalid number of queries (1 - " + std::to_string(MAX_PATH_QUERIES) + ").\n");
+        co_return;
+    }
+    co_await sendMessage(client, "Enter the queries - pairs of vertices \"u v\" separated by spaces or lines:\n");
+    std::vector<int> vertices = co_await getIntegersFromClient(client, 2 * static_cast<size_t>(numQueries));
+    if (vertices.size() < 2 * static_cast<size_t>(numQueries))
+    {
+        co_await sendMessage(client, "Invalid query, vertices must be integers.\n");
+        co_return;
+    }
+
+    // Building the index reads the whole MST matrix - run it and the batch on the compute executor
+    std::string answer;
+    bool accepted = co_await client.loop.offload(*this->computeExecutor, TRACE_NO_GRAPH, [&answer, &vertices, &storedMST]()
+    {
+        std::shared_ptr<const MSTPathIndex> index = storedMST().pathIndex;
+        for (size_t i = 0; i + 1 < vertices.size(); i += 2)
+        {
+            int u = vertices[i], v = vertices[i + 1];
+            answer += "Path " + std::to_string(u) + " - " + std::to_string(v) + ": ";
+            if (u < 0 || u >= index->getSizeVertices() || v < 0 || v >= index->getSizeVertices())
+            {
+                answer += "vertex out of range\n";
+                continue;
+            }
+            MSTPathIndex::PathResult result = index->query(u, v);
+            if (!result.connected)
+            {
+                answer += "not connected\n";
+                continue;
+            }
+            answer += "Distance " + std::to_string(result.distance) + " | Bottleneck Edge " + std::to_string(result.bottleneck) + "\n";
+        }
+    });
+    if (!accepted)
+    {
+        co_await sendMessage(client, "Server is busy, try the queries again later.\n");
+        co_return;
+    }
+    co_await sendMessage(client, answer);
+}
+
+// Every edge: how far its weight may change before the MST changes, and the second-best MST
+Task<void> Server::sendMSTSensitivityToClient(ClientSession &client)
+{
+    co_await sendMessage(client, "Enter the graph number: ");
+    int graphNumber = co_await getIntegerInputFromClient(client);
+    std::string error;
+    auto storedMST = findStoredMST(graphNumber, true, error);
+    if (!storedMST)
+    {
+        co_await sendMessage(client, error);
+        co_return;
+    }
+    std::string answer;
+    bool accepted = co_await client.loop.offload(*this->computeExecutor, TRACE_NO_GRAPH, [&answer, &storedMST]()
+    {
+        StoredMST mst = storedMST();
+        answer = MSTSensitivity::format(MSTSensitivity::analyze(mst.edges, mst.mstEdges, *mst.pathIndex));
+    });
+    if (!accepted)
+    {
+        co_await sendMessage(client, "Server is busy, try the analysis again later.\n");
+        co_return;
+    }
+    co_await sendMessage(client, answer);
+}
+
+// Graph numbers are the ones of option 4 - the returned loader runs on the compute executor
+std::function<Server::StoredMST()> Server::findStoredMST(int graphNumber, bool withEdges, std::string &error)
+{
+    if (this->sharedStore != nullptr)
+    {
+        syncSharedStore();
+        std::vector<SharedGraphStore::SharedGraph> sharedGraphs = this->sharedStore->snapshot();
+        if (graphNumber < 1 || graphNumber > static_cast<int>(sharedGraphs.size()))
+        {
+            error = "Invalid graph number.\n";
+            return nullptr;
+        }
+        auto sharedGraph = std::make_shared<SharedGraphStore::SharedGraph>(std::move(sharedGraphs[graphNumber - 1]));
+        if (sharedGraph->state != SharedGraphStore::Done || sharedGraph->mstEdges.empty())
+        {
+            error = "MST is not computed. Please pass it to Pipeline or Leader-Follower.\n";
+            return nullptr;
+        }
+        return [this, sharedGraph, withEdges]()
+        {
+            StoredMST mst;
+            {
+                std::lock_guard<std::mutex> lock(this->mtx);
+                auto cached = this->sharedPathIndexes.find(sharedGraph->graphID);
+                if (cached != this->sharedPathIndexes.end())
+                {
+                    mst.pathIndex = cached->second;
+                }
+            }
+            if (mst.pathIndex == nullptr)
+            {
+                auto index = std::make_shared<const MSTPathIndex>(sharedGraph->numVertices, sharedGraph->mstEdges);
+                std::lock_guard<std::mutex> lock(this->mtx);
+                mst.pathIndex = this->sharedPathIndexes.emplace(sharedGraph->graphID, index).first->second;
+            }
+            if (withEdges)
+            {
+                this->sharedStore->find(sharedGraph->graphID, *sharedGraph); // Records are never removed
+                mst.edges = std::move(sharedGraph->edges);
+                mst.mstEdges = std::move(sharedGraph->mstEdges);
+            }
+            return mst;
+        };
+    }
+    std::shared_ptr<Graph> graph;
+    {
+        std::lock_guard<std::mutex> lock(this->mtx);
+        if (graphNumber >= 1 && graphNumber <= static_cast<int>(this->vec_SharedPtrGraphs.size()))
+        {
+            graph = this->vec_SharedPtrGraphs[graphNumber - 1];
+        }
     }
+    if (graph == nullptr)
+    {
+        error = "Invalid graph number.\n";
+        return nullptr;
+    }
+    if (!graph->getValidationMSTExist() || graph->getMSTDataStatusCalculation() != FINISH_MST_DATA_CALCULATION)
+    {
+        error = "MST is not computed. Please pass it to Pipeline or Leader-Follower.\n";
+        return nullptr;
+    }
+    return [graph, withEdges]()
+    {
+        StoredMST mst;
+        mst.pathIndex = graph->getMSTPathIndex();
+        if (withEdges)
+        {
+            mst.edges = graph->getEdges();
+            mst.mstEdges = graph->getMSTEdges();
+        }
+        return mst;
+    };
+}
+
+// Statistics are read from atomics only - no lock of the processing path is taken
+std::string Server::collectStatistics()
+{
+    std::string report = "********* Pipeline Statistics *********\n";
+    report += this->pipeline->getStatistics();
+    report += "********* Leader-Follower Statistics *********\n";
+    report += this->leaderfollower->getStatistics();
+    report += "********* MST Compute Statistics *********\n";
+    report += this->computeExecutor->getStatistics();
+    if (this->memoryBudget != nullptr)
+    {
+        report += "********* Graph Memory Budget *********\n";
+        report += this->memoryBudget->getStatistics();
+    }
+    report += "********* Graph Deduplication *********\n";
+    report += "Identical graphs stored as shared copies: " + std::to_string(this->deduplicatedGraphs.load(std::memory_order_relaxed)) + "\n";
+    report += "********* MST Algorithm Selection *********\n";
+    report += MSTCostModel::getInstance().getStatistics();
+    report += "********* External-Memory Kruskal *********\n";
+    report += ExternalSortContext::getInstance().getStatistics();
+    report += "********* NUMA Placement *********\n";
+    report += NumaTopology::getInstance().getStatistics();
+    if (this->sharedStore != nullptr)
+    {
+        report += "********* Shared Graph Store (worker " + std::to_string(this->config.workerIndex) + ") *********\n";
+        report += this->sharedStore->getStatistics();
+    }
+    report += "********* Event Loop Statistics *********\n";
+    for (const auto &loop : this->eventLoops)
+    {
+        report += loop->getStatistics();
+    }
+    return report;
 }
 
-void Server::stopClient(int client_FD)
+Task<void> Server::sendStatisticsToClient(ClientSession &client)
+{
+    co_await sendMessage(client, collectStatistics());
+}
+
+void Server::stopClient(ClientSession &client)
 { // Stop the client connection
-    if (client_FD < 0)
     {
-        std::perror("Error: Invalid client file descriptor.");
+        std::lock_guard<std::mutex> lock(this->mtx_mailboxes);
+        auto mailbox = this->clientMailboxes.find(client.fd);
+        if (mailbox != this->clientMailboxes.end())
+        {
+            mailbox->second->session->cancel(); // Queued and running jobs of the client are dropped
+            this->clientMailboxes.erase(mailbox);
+        }
     }
-    close(client_FD);
-    std::lock_guard<std::mutex> lock(this->mtx);
-    std::cout << "Client Connection Closed" << std::endl;
+    client.loop.closeFD(client.fd);
+    LOG_INFO("Client Connection Closed");
 }
 
-int Server::getIntegerInputFromClient(int client_FD)
+Task<int> Server::getIntegerInputFromClient(ClientSession &client)
 {
     char buffer[1024];
     memset(buffer, 0, sizeof(buffer));
-    read(client_FD, buffer, sizeof(buffer));
+    if (co_await client.loop.read(client.fd, buffer, sizeof(buffer) - 1) <= 0)
+    {
+        throw ClientDisconnected();
+    }
     int data = INVALID;
     try
     {
@@ -438,23 +1382,91 @@ int Server::getIntegerInputFromClient(int client_FD)
     }
     catch (std::invalid_argument &e)
     {
-        return INVALID;
+        co_return INVALID;
+    }
+    co_return data;
+}
+
+// Reads until count integers arrived, each one followed by a space or a line break - a number may be split between two reads
+// Returns fewer integers if the input holds something else
+Task<std::vector<int>> Server::getIntegersFromClient(ClientSession &client, size_t count)
+{
+    std::vector<int> values;
+    values.reserve(count);
+    std::string pending; // Digits of a number cut by the end of a read
+    char buffer[65536];
+    while (values.size() < count)
+    {
+        ssize_t bytes = co_await client.loop.read(client.fd, buffer, sizeof(buffer));
+        if (bytes <= 0)
+        {
+            throw ClientDisconnected();
+        }
+        for (ssize_t i = 0; i < bytes && values.size() < count; ++i)
+        {
+            if (!isspace(static_cast<unsigned char>(buffer[i])))
+            {
+                pending += buffer[i];
+                continue;
+            }
+            if (pending.empty())
+            {
+                continue;
+            }
+            char *end = nullptr;
+            errno = 0;
+            long value = strtol(pending.c_str(), &end, 10);
+            if (*end != '\0' || errno == ERANGE || value < INT_MIN || value > INT_MAX)
+            {
+                co_return values;
+            }
+            values.push_back(static_cast<int>(value));
+            pending.clear();
+        }
     }
-    return data;
+    co_return values;
 }
 
-std::string Server::getStringInputFromClient(int client_FD)
+Task<std::string> Server::getStringInputFromClient(ClientSession &client)
 {
     char buffer[1024];
     memset(buffer, 0, sizeof(buffer));
-    read(client_FD, buffer, sizeof(buffer));
-    return std::string(buffer);
+    if (co_await client.loop.read(client.fd, buffer, sizeof(buffer) - 1) <= 0)
+    {
+        throw ClientDisconnected();
+    }
+    co_return std::string(buffer);
 }
 
 int main(int argc, char *argv[])
 {
-    Server *serverObj = new Server();
+    ServerConfig config;
+    try
+    {
+        config = ServerConfig::parse(argc, argv);
+    }
+    catch (const std::invalid_argument &e)
+    {
+        std::cerr << e.what() << "\n" << ServerConfig::usage(argv[0]);
+        return 1;
+    }
+    if (config.workers > 0 && config.workerIndex < 0)
+    {
+        try
+        {
+            WorkerSupervisor supervisor(config, argc, argv);
+            supervisor.run();
+        }
+        catch (const std::runtime_error &e)
+        {
+            LOG_ERROR("Supervisor: " << e.what());
+        }
+        Logger::getInstance().shutdown();
+        return 0;
+    }
+    Server *serverObj = new Server(config);
     delete serverObj;
+    Logger::getInstance().shutdown(); // Write the remaining log records
     return 0;
 }
 
@@ -9,48 +9,133 @@
 #include <sys/types.h>
 #include <sys/select.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 #include <netinet/in.h>
 #include <arpa/inet.h>
+#include <fcntl.h>
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <memory>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+#include <csignal>
 #include "Pipeline.hpp"
 #include "LeaderFollower.hpp"
 #include "Graph.hpp"
 #include "MSTFactory.hpp"
 #include "MSTStrategy.hpp"
+#include "GraphGenerator.hpp"
+#include "ComputeExecutor.hpp"
+#include "ServerConfig.hpp"
+#include "SharedGraphStore.hpp"
+#include "WorkerSupervisor.hpp"
+#include "GraphHandoff.hpp"
+#include "GraphMemoryBudget.hpp"
+#include "MSTPathIndex.hpp"
+#include "MSTSensitivity.hpp"
+#include "EventLoop.hpp"
+#include "Task.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include "CancellationToken.hpp"
 
 
 class Server
 {
 private:
+    // Messages for a client produced off its connection thread, delivered before its next menu
+    struct ClientMailbox
+    {
+        std::mutex mtx;
+        std::vector<std::string> notices;
+        std::shared_ptr<CancellationToken> session = std::make_shared<CancellationToken>(); // Cancelled on disconnect - parent of the client's jobs
+    };
+
+    // Thrown by the input functions when the client closed the connection
+    // Not an std::exception, so the retry loops of the dialogs do not swallow it
+    struct ClientDisconnected {};
+
+    // A stored graph with a computed MST, as the MST queries see it
+    struct StoredMST
+    {
+        std::shared_ptr<const MSTPathIndex> pathIndex;
+        std::vector<WeightedEdge> edges;      // Only if asked for
+        std::vector<WeightedEdge> mstEdges;   // Only if asked for
+    };
+
+    // Connection of a session - lives in the frame of handleRequest, the dialog coroutines take it by reference
+    struct ClientSession
+    {
+        int fd;
+        EventLoop &loop;
+    };
+
+    ServerConfig config;                                                       // Startup options
+    std::unique_ptr<GraphMemoryBudget> memoryBudget;                           // Budget of the stored graphs (nullptr - unlimited) - outlives them
     std::vector<std::shared_ptr<Graph>> vec_SharedPtrGraphs;                   // Vector to store graphs
     std::vector<std::weak_ptr<Graph>> vec_WeakPtrGraphs_Unprocessed;           // Vector to store graphs that are not processed yet
-    std::vector<std::pair<int, std::unique_ptr<std::thread>>> clients_dataset; // Vector to store client data: socket and thread
+    std::vector<std::unique_ptr<EventLoop>> eventLoops;                       // Event loops running the client sessions
+    std::atomic<size_t> nextEventLoop{0};                                      // Round robin assignment of new clients
     std::mutex mtx;                                                  // Mutex for the clients for
     std::atomic<bool> stopServer;                                       // Flag to stop the server
     struct sockaddr_in address;                                              // Address structure
     int server_fd;                                                         // File descriptor for the server
+    int unix_fd;                                                           // AF_UNIX listener of the local clients (-1 if disabled)
     Pipeline *pipeline;                                                        // Pointer to the Pipeline pattern
     LeaderFollower *leaderfollower;                                            // Pointer to the Leader-Follower pattern
+    ComputeExecutor *computeExecutor;                                          // Bounded executor of the MST computations
+    std::map<int, std::shared_ptr<ClientMailbox>> clientMailboxes;             // Mailbox of every connected client
+    std::mutex mtx_mailboxes;                                                  // Mutex for the mailboxes map
+    std::unique_ptr<SharedGraphStore> sharedStore;                            // Graphs of all the workers (worker process only)
+    std::vector<std::shared_ptr<Graph>> sharedClaims;                         // Claimed graphs whose MST data is not written back yet (guarded by mtx)
+    std::map<int, std::shared_ptr<const MSTPathIndex>> sharedPathIndexes;     // Worker: path indexes of the graphs of the store by id (guarded by mtx)
+    std::unordered_map<uint64_t, std::vector<std::weak_ptr<Graph>>> graphsByContent; // Stored graphs by content hash (guarded by mtx)
+    std::atomic<uint64_t> deduplicatedGraphs{0};                              // Graphs stored as a shared copy of an identical one
 
     void startServer();                    // Start the server
     void handleConnections();              // Handle client connections
-    void handleRequest(int client_socket); // Handle client requests
-    void stopClient(int client_FD);  // Stop the client FD
-    void sendMessage(int client_FD, const std::string message);  // Send a message to the client
-    void graphCreation(int client_FD); // All the progress to create graph and store it (include mst calculation)
-    void sendDataToLeaderFollower(int client_FD);
-    void sendDataToPipeline(int client_FD);  // Send data to Pipeline
-    void sendMSTDataToClient(int client_FD); // send MST Data to client
-    void filterUnprocessedGraphs();  // Filter unprocessed graphs
-    int getIntegerInputFromClient(int client_FD);  // Get integer input from the client
-    std::string getStringInputFromClient(int client_FD); // Get string input from the client
+    void startUnixListener();              // Listen for local clients on the AF_UNIX socket
+    void startSession(int client_FD, bool local = false); // Hand a new client to an event loop
+    Task<void> handleRequest(int client_socket, EventLoop &loop); // Client session - the menu dialog
+    Task<void> handleLocalRequest(int client_socket, EventLoop &loop); // Local client session - binary graph handoff
+    void storeComputedGraph(std::shared_ptr<Graph> graph);       // Store a graph whose MST data is already computed
+    void stopClient(ClientSession &client);  // Stop the client FD
+    Task<void> sendMessage(ClientSession &client, std::string message);  // Send a message to the client
+    Task<void> graphCreation(ClientSession &client); // All the progress to create graph and store it (include mst calculation)
+    Task<void> graphGeneration(ClientSession &client); // Generate a synthetic graph on the server and store it
+    Task<std::unique_ptr<MSTStrategy>> chooseMSTStrategy(ClientSession &client); // Ask the client for the MST algorithm
+    Task<void> storeGraph(ClientSession &client, std::shared_ptr<Graph> graph);  // Submit the MST computation, the graph is stored when it finishes
+    std::shared_ptr<Graph> storeIdenticalGraph(const Graph &graph, const std::function<void()> &storeUnique); // Store the stored graph with the same content instead (nullptr if none - storeUnique ran under mtx)
+    static std::string sharedCopyNotice(int graphID, int originalID);  // Client notice of a deduplicated graph
+    std::shared_ptr<ClientMailbox> getMailbox(int client_FD);      // Mailbox of a connected client (nullptr if none)
+    std::shared_ptr<const CancellationToken> jobCancellation(int client_FD); // Token of a new job of the client (--job-deadline-ms)
+    Task<void> sendPendingNotices(ClientSession &client);          // Deliver the mailbox of the client
+    Task<void> sendDataToLeaderFollower(ClientSession &client);
+    Task<void> sendDataToPipeline(ClientSession &client, MetricRegistry::MetricSet metrics = ~MetricRegistry::MetricSet(0)); // Send data to Pipeline
+    Task<void> sendSelectedMetricsToPipeline(ClientSession &client); // Ask for the metrics, then send data to Pipeline
+    Task<void> sendMSTDataToClient(ClientSession &client); // send MST Data to client
+    Task<void> sendStatisticsToClient(ClientSession &client); // send Pipeline and Leader-Follower statistics to client
+    Task<void> queryMSTPaths(ClientSession &client);       // Batch of path distance / bottleneck queries on a stored MST
+    Task<void> sendMSTSensitivityToClient(ClientSession &client); // Sensitivity of every edge and the second-best MST of a stored graph
+    std::function<StoredMST()> findStoredMST(int graphNumber, bool withEdges, std::string &error); // Loader of a stored MST (empty if none)
+    void accountStoredGraph(const std::shared_ptr<Graph> &graph); // Put a stored graph under the memory budget
+    std::string collectStatistics();           // Statistics report of the Pipeline and the Leader-Follower
+    std::vector<std::weak_ptr<Graph>> filterUnprocessedGraphs(MetricRegistry::MetricSet metrics); // Graphs lacking some of the metrics - a copy taken under mtx
+    void traceUnprocessedWait(const std::vector<std::weak_ptr<Graph>> &graphs); // Trace how long the unprocessed graphs waited to be submitted
+    void claimSharedGraphs(MetricRegistry::MetricSet metrics); // Worker: claim the pending graphs of all the workers (and those lacking the metrics) as unprocessed
+    void syncSharedStore();          // Worker: write the finished MST data of the claimed graphs back
+    Task<void> sendSharedMSTDataToClient(ClientSession &client); // Worker: MST data of the graphs of all the workers
+    Task<int> getIntegerInputFromClient(ClientSession &client);  // Get integer input from the client
+    Task<std::string> getStringInputFromClient(ClientSession &client); // Get string input from the client
+    Task<std::vector<int>> getIntegersFromClient(ClientSession &client, size_t count); // Whitespace separated integers over any number of reads
 
 public:
-    Server();  // Constructor
+    Server(const ServerConfig &config);  // Constructor
     ~Server(); // Destructor
 };
 
@@ -0,0 +1,134 @@
+#include "ServerConfig.hpp"
+#include <stdexcept>
+#include <thread>
+#include <algorithm>
+
+static int parseInteger(const std::string &key, const std::string &value)
+{
+    try
+    {
+        return std::stoi(value);
+    }
+    catch (const std::logic_error &)
+    {
+        throw std::invalid_argument("Invalid value for " + key + ": " + value);
+    }
+}
+
+static double parseDouble(const std::string &key, const std::string &value)
+{
+    try
+    {
+        return std::stod(value);
+    }
+    catch (const std::logic_error &)
+    {
+        throw std::invalid_argument("Invalid value for " + key + ": " + value);
+    }
+}
+
+static bool parseSwitch(const std::string &key, const std::string &value)
+{
+    if (value == "on" || value == "adaptive") return true;
+    if (value == "off") return false;
+    throw std::invalid_argument("Invalid value for " + key + ": " + value + " (on|off)");
+}
+
+// A layout is built by the Pipeline - checked here so a bad one fails at startup with the usage
+static std::string parseLayout(const std::string &value)
+{
+    MetricRegistry::getInstance().parseLayout(value);
+    return value;
+}
+
+ServerConfig ServerConfig::parse(int argc, char *argv[])
+{
+    ServerConfig config;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        size_t separator = arg.find('=');
+        std::string key = arg.substr(0, separator);
+        std::string value = separator == std::string::npos ? "" : arg.substr(separator + 1);
+
+        if (key == "--port") config.port = parseInteger(key, value);
+        else if (key == "--io-threads") config.ioThreads = parseInteger(key, value);
+        else if (key == "--io-backend") config.ioBackend = EventLoop::parseBackend(value);
+        else if (key == "--mst-threads") config.mstThreads = parseInteger(key, value);
+        else if (key == "--mst-queue") config.mstQueueLimit = parseInteger(key, value);
+        else if (key == "--lf-scheduler") config.lfScheduler = TaskScheduler::parsePolicy(value);
+        else if (key == "--lf-sjf-slowdown") config.lfSjfSlowdown = parseDouble(key, value);
+        else if (key == "--workers") config.workers = parseInteger(key, value);
+        else if (key == "--store-mb") config.storeMB = parseInteger(key, value);
+        else if (key == "--unix-socket") config.unixSocket = value;
+        else if (key == "--memory-budget-mb") config.memoryBudgetMB = parseInteger(key, value);
+        else if (key == "--spill-dir") config.spillDirectory = value;
+        else if (key == "--vertex-order") config.vertexOrder = VertexOrdering::parseMethod(value);
+        else if (key == "--numa") config.numaPlacement = NumaTopology::parsePlacement(value);
+        else if (key == "--pipeline-batch") config.pipelineBatch = parseInteger(key, value);
+        else if (key == "--pipeline-fusion") config.pipelineFusion = parseSwitch(key, value);
+        else if (key == "--pipeline-layout") config.pipelineLayout = parseLayout(value);
+        else if (key == "--external-sort-mb") config.externalSortMB = parseInteger(key, value);
+        else if (key == "--job-deadline-ms") config.jobDeadlineMs = parseInteger(key, value);
+        else if (key == "--worker") config.workerIndex = parseInteger(key, value);
+        else if (key == "--help") throw std::invalid_argument("Help requested");
+        else throw std::invalid_argument("Unknown option " + arg);
+    }
+
+    if (config.mstThreads <= 0)
+    {
+        config.mstThreads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (config.port <= 0 || config.ioThreads <= 0 || config.mstQueueLimit < 0 || config.lfSjfSlowdown < 0.0)
+    {
+        throw std::invalid_argument("Port and I/O threads must be positive, the MST queue limit and the SJF slowdown not negative");
+    }
+    if (config.workers < 0 || config.storeMB <= 0)
+    {
+        throw std::invalid_argument("Workers must not be negative and the store size must be positive");
+    }
+    if (config.memoryBudgetMB < 0 || config.spillDirectory.empty() || config.externalSortMB <= 0)
+    {
+        throw std::invalid_argument("The memory budget must not be negative, the external sort memory must be positive and the spill directory must be set");
+    }
+    if (config.jobDeadlineMs < 0 || config.pipelineBatch <= 0)
+    {
+        throw std::invalid_argument("The job deadline must not be negative and the pipeline batch must be positive");
+    }
+    return config;
+}
+
+std::string ServerConfig::usage(const char *program)
+{
+    return std::string("Usage: ") + program + " [options]\n"
+           "  --port=N             Listening port (default 4040)\n"
+           "  --io-threads=N       Event loop threads running the client sessions (default 1)\n"
+           "  --io-backend=B       Event loop I/O: epoll or uring (io_uring, falls back to epoll if unavailable) (default epoll)\n"
+           "  --mst-threads=N      Concurrent MST computations (default hardware concurrency)\n"
+           "  --mst-queue=N        MST computations allowed to wait before replying busy (default 64)\n"
+           "  --lf-scheduler=P     Leader-Follower queue order: fifo, sjf (shortest job first) or wfq (fair per client) (default fifo)\n"
+           "  --lf-sjf-slowdown=X  SJF aging: a graph waits at most about X times its own estimated work (default 10)\n"
+           "  --workers=N          Worker processes accepting on the same port and sharing the graphs (default 0 - single process)\n"
+           "  --store-mb=N         Size of the shared graph store of the workers in MB (default 64)\n"
+           "  --unix-socket=PATH   Also listen on an AF_UNIX socket for binary graph handoff in a memfd (default off)\n"
+           "  --memory-budget-mb=N Memory of the stored graphs before the least recently used spill to disk (default 0 - unlimited)\n"
+           "  --spill-dir=PATH     Directory of the spilled graphs and the external-memory Kruskal runs (default /tmp)\n"
+           "  --external-sort-mb=N Memory of the edge sort of the external-memory Kruskal before it merges runs from disk (default 64)\n"
+           "  --vertex-order=O     Relabel the vertices of a graph for locality before its MST: none, rcm (reverse Cuthill-McKee) or bfs (default none)\n"
+           "  --numa=P             NUMA placement: off, node (pin threads to a node, graphs on their creator's node) or cpu (pin to one CPU) (default off)\n"
+           "  --job-deadline-ms=N  Drop an MST computation or Pipeline/Leader-Follower job not finished N ms after submission (default 0 - none)\n"
+           "  --pipeline-batch=N   Graphs a pipeline stage takes from its queue and hands to the next stage at once (default 32)\n"
+           "  --pipeline-fusion=F  adaptive: a stage runs the next stages inline while they are cheaper than a hand-off, or off (default off)\n"
+           "  --pipeline-layout=L  Metric stages: parallel branches separated by ';', each a chain of metrics joined by '>'\n"
+           "                       (default " DEFAULT_PIPELINE_LAYOUT ")\n";
+}
+
+std::string ServerConfig::storeName() const
+{
+    return "/mst-graph-store-" + std::to_string(this->port);
+}
+
+std::string ServerConfig::unixSocketPath() const
+{
+    return this->workerIndex >= 0 ? this->unixSocket + "." + std::to_string(this->workerIndex) : this->unixSocket;
+}
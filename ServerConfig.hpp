@@ -0,0 +1,41 @@
+#ifndef SERVERCONFIG_HPP
+#define SERVERCONFIG_HPP
+
+#include <string>
+#include "TaskScheduler.hpp"
+#include "EventLoop.hpp"
+#include "VertexOrdering.hpp"
+#include "NumaTopology.hpp"
+#include "MetricRegistry.hpp"
+
+// Startup options of the server, parsed from --key=value command line arguments
+struct ServerConfig
+{
+    int port = 4040;             // Listening port
+    int mstThreads = 0;          // MST compute threads - the cap on concurrent MST computations (0 - hardware concurrency)
+    int ioThreads = 1;           // Event loop threads running the client sessions
+    EventLoop::Backend ioBackend = EventLoop::Epoll; // I/O backend of the event loops
+    int mstQueueLimit = 64;      // MST computations allowed to wait before the server answers busy
+    TaskScheduler::Policy lfScheduler = TaskScheduler::FIFO; // Leader-Follower queue order
+    double lfSjfSlowdown = 10.0; // SJF aging - a task waits at most about this many times its own estimated work
+    int workers = 0;             // Worker processes sharing the port and the graph store (0 - single process)
+    int storeMB = 64;            // Size of the shared graph store segment
+    int workerIndex = -1;        // Set by the supervisor in the command line of a worker process (--worker)
+    std::string unixSocket;      // Path of the AF_UNIX listener for binary graph handoff (empty - disabled)
+    int memoryBudgetMB = 0;      // Resident memory of the stored graph matrices before the LRU graphs spill (0 - unlimited)
+    std::string spillDirectory = "/tmp"; // Directory of the spill files
+    VertexOrdering::Method vertexOrder = VertexOrdering::Identity; // Relabeling of the graphs before their MST is computed
+    NumaTopology::Placement numaPlacement = NumaTopology::Off; // Thread pinning and node-local graph memory
+    int pipelineBatch = 32;      // Tasks a pipeline stage takes and hands over per lock acquisition
+    bool pipelineFusion = false; // Pipeline stages run cheap next stages inline (adaptive)
+    std::string pipelineLayout = DEFAULT_PIPELINE_LAYOUT; // Metric stages of the pipeline - branches by ';', chained by '>'
+    int externalSortMB = 64;     // Memory of the edge sort of the external-memory Kruskal (its files go to spillDirectory)
+    int jobDeadlineMs = 0;       // Deadline of an MST computation or metrics job from its submission (0 - none)
+
+    static ServerConfig parse(int argc, char *argv[]); // Throws std::invalid_argument
+    static std::string usage(const char *program);
+    std::string storeName() const; // POSIX shared memory name of the graph store
+    std::string unixSocketPath() const; // Path of the AF_UNIX listener - suffixed with the index in a worker process
+};
+
+#endif
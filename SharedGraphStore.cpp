@@ -0,0 +1,319 @@
+#include "SharedGraphStore.hpp"
+#include "Logger.hpp"
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define SHARED_STORE_MAGIC 0x4d535453 // "MSTS"
+
+struct SharedGraphStore::Record
+{
+    int graphID;
+    int state;
+    pid_t claimedBy;
+    int worker;
+    int numVertices;
+    int numEdges;
+    int numMSTEdges;
+    size_t edgesOffset;    // Offsets into the edge area
+    size_t mstEdgesOffset;
+    Graph::Sum mstTotalWeight;
+    Graph::Sum mstLongestDistance;
+    Graph::Sum mstShortestDistance;
+    double mstAvgEdgeWeight;
+    uint32_t mstMetrics;   // MetricRegistry bits of the metrics written by complete()
+};
+
+struct SharedGraphStore::Header
+{
+    uint32_t magic;
+    pthread_mutex_t mutex;         // Robust, process-shared - guards everything below
+    std::atomic<int> nextGraphID;  // Lock-free, so usable across processes without the mutex
+    int numRecords;
+    size_t edgesUsed;              // Edges allocated from the edge area
+    size_t edgesCapacity;
+    Record records[SHARED_STORE_MAX_GRAPHS];
+    // Edge area (WeightedEdge[edgesCapacity]) follows the header
+};
+
+// Holds the store mutex - recovers it if its previous owner died while holding it
+class SharedGraphStore::Lock
+{
+private:
+    pthread_mutex_t &mutex;
+
+public:
+    explicit Lock(pthread_mutex_t &mutex) : mutex(mutex)
+    {
+        if (pthread_mutex_lock(&this->mutex) == EOWNERDEAD)
+        {
+            LOG_WARN("Shared graph store: a worker died holding the store lock, recovering");
+            pthread_mutex_consistent(&this->mutex);
+        }
+    }
+    ~Lock() { pthread_mutex_unlock(&this->mutex); }
+};
+
+SharedGraphStore::SharedGraphStore(const std::string &name, Header *header, size_t size, bool owner)
+    : name(name), header(header), size(size), owner(owner)
+{
+}
+
+SharedGraphStore::~SharedGraphStore()
+{
+    munmap(this->header, this->size);
+    if (this->owner)
+    {
+        shm_unlink(this->name.c_str());
+    }
+}
+
+std::unique_ptr<SharedGraphStore> SharedGraphStore::create(const std::string &name, size_t bytes)
+{
+    if (bytes < sizeof(Header) + sizeof(WeightedEdge))
+    {
+        throw std::runtime_error("Shared graph store: segment too small");
+    }
+    shm_unlink(name.c_str()); // Left over by a killed supervisor
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0 || ftruncate(fd, bytes) < 0)
+    {
+        std::string error = strerror(errno);
+        if (fd >= 0)
+        {
+            close(fd);
+            shm_unlink(name.c_str());
+        }
+        throw std::runtime_error("Shared graph store: cannot create " + name + ": " + error);
+    }
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        shm_unlink(name.c_str());
+        throw std::runtime_error("Shared graph store: mmap failed: " + std::string(strerror(errno)));
+    }
+
+    Header *header = static_cast<Header *>(memory); // ftruncate zero-filled the segment
+    pthread_mutexattr_t attributes;
+    pthread_mutexattr_init(&attributes);
+    pthread_mutexattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&attributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header->mutex, &attributes);
+    pthread_mutexattr_destroy(&attributes);
+    new (&header->nextGraphID) std::atomic<int>(1);
+    header->numRecords = 0;
+    header->edgesUsed = 0;
+    header->edgesCapacity = (bytes - sizeof(Header)) / sizeof(WeightedEdge);
+    header->magic = SHARED_STORE_MAGIC;
+    LOG_INFO("Shared graph store " << name << " created (" << bytes / (1024 * 1024) << " MB, " << header->edgesCapacity << " edges)");
+    return std::unique_ptr<SharedGraphStore>(new SharedGraphStore(name, header, bytes, true));
+}
+
+std::unique_ptr<SharedGraphStore> SharedGraphStore::attach(const std::string &name)
+{
+    int fd = shm_open(name.c_str(), O_RDWR, 0);
+    struct stat status;
+    if (fd < 0 || fstat(fd, &status) < 0)
+    {
+        std::string error = strerror(errno);
+        if (fd >= 0)
+        {
+            close(fd);
+        }
+        throw std::runtime_error("Shared graph store: cannot open " + name + ": " + error);
+    }
+    size_t bytes = status.st_size;
+    void *memory = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (memory == MAP_FAILED)
+    {
+        throw std::runtime_error("Shared graph store: mmap failed: " + std::string(strerror(errno)));
+    }
+    Header *header = static_cast<Header *>(memory);
+    if (bytes < sizeof(Header) || header->magic != SHARED_STORE_MAGIC)
+    {
+        munmap(memory, bytes);
+        throw std::runtime_error("Shared graph store: " + name + " is not a graph store");
+    }
+    return std::unique_ptr<SharedGraphStore>(new SharedGraphStore(name, header, bytes, false));
+}
+
+WeightedEdge *SharedGraphStore::edgesAt(size_t offset) const
+{
+    return reinterpret_cast<WeightedEdge *>(reinterpret_cast<char *>(this->header) + sizeof(Header)) + offset;
+}
+
+std::atomic<int> &SharedGraphStore::graphIDCounter()
+{
+    return this->header->nextGraphID;
+}
+
+bool SharedGraphStore::publish(const Graph &graph, int worker)
+{
+    std::vector<WeightedEdge> edges = graph.getEdges();
+    std::vector<WeightedEdge> mstEdges = graph.getMSTEdges();
+
+    Lock lock(this->header->mutex);
+    size_t needed = edges.size() + mstEdges.size();
+    if (this->header->numRecords == SHARED_STORE_MAX_GRAPHS || this->header->edgesCapacity - this->header->edgesUsed < needed)
+    {
+        return false;
+    }
+    Record &record = this->header->records[this->header->numRecords];
+    record.graphID = graph.getGraphID();
+    record.claimedBy = 0;
+    record.mstMetrics = 0;
+    record.worker = worker;
+    record.numVertices = graph.getSizeVertices();
+    record.numEdges = edges.size();
+    record.numMSTEdges = mstEdges.size();
+    record.edgesOffset = this->header->edgesUsed;
+    record.mstEdgesOffset = record.edgesOffset + edges.size();
+    std::copy(edges.begin(), edges.end(), edgesAt(record.edgesOffset));
+    std::copy(mstEdges.begin(), mstEdges.end(), edgesAt(record.mstEdgesOffset));
+    record.state = Pending;
+    this->header->edgesUsed += needed;
+    this->header->numRecords++;
+    return true;
+}
+
+SharedGraphStore::SharedGraph SharedGraphStore::copyRecord(const Record &record, bool withEdges) const
+{
+    SharedGraph graph;
+    graph.graphID = record.graphID;
+    graph.state = static_cast<State>(record.state);
+    graph.worker = record.worker;
+    graph.numVertices = record.numVertices;
+    graph.numEdges = record.numEdges;
+    if (withEdges)
+    {
+        graph.edges.assign(edgesAt(record.edgesOffset), edgesAt(record.edgesOffset) + record.numEdges);
+    }
+    graph.mstEdges.assign(edgesAt(record.mstEdgesOffset), edgesAt(record.mstEdgesOffset) + record.numMSTEdges);
+    graph.mstTotalWeight = record.mstTotalWeight;
+    graph.mstLongestDistance = record.mstLongestDistance;
+    graph.mstShortestDistance = record.mstShortestDistance;
+    graph.mstAvgEdgeWeight = record.mstAvgEdgeWeight;
+    graph.mstMetrics = record.mstMetrics;
+    return graph;
+}
+
+// A done graph computed for an earlier request that selected fewer metrics is claimed again
+std::vector<SharedGraphStore::SharedGraph> SharedGraphStore::claimPending(pid_t claimer, uint32_t metrics)
+{
+    std::vector<SharedGraph> claimed;
+    Lock lock(this->header->mutex);
+    for (int i = 0; i < this->header->numRecords; ++i)
+    {
+        Record &record = this->header->records[i];
+        if (record.state == Pending || (record.state == Done && (metrics & ~record.mstMetrics) != 0))
+        {
+            record.state = Claimed;
+            record.claimedBy = claimer;
+            claimed.push_back(copyRecord(record, true));
+        }
+    }
+    return claimed;
+}
+
+void SharedGraphStore::complete(const Graph &graph)
+{
+    Lock lock(this->header->mutex);
+    for (int i = 0; i < this->header->numRecords; ++i)
+    {
+        Record &record = this->header->records[i];
+        if (record.graphID == graph.getGraphID())
+        {
+            // Only the computed metrics are written - the ones of an earlier claim stay
+            uint32_t computed = graph.getComputedMetrics();
+            if (computed & MST_TOTAL_WEIGHT)
+            {
+                record.mstTotalWeight = graph.getMSTTotalWeight();
+            }
+            if (computed & MST_LONGEST_DISTANCE)
+            {
+                record.mstLongestDistance = graph.getMSTLongestDistance();
+            }
+            if (computed & MST_SHORTEST_DISTANCE)
+            {
+                record.mstShortestDistance = graph.getMSTShortestDistance();
+            }
+            if (computed & MST_AVERAGE_WEIGHT)
+            {
+                record.mstAvgEdgeWeight = graph.getMSTAvgEdgeWeight();
+            }
+            record.mstMetrics |= computed;
+            record.state = Done;
+            record.claimedBy = 0;
+            return;
+        }
+    }
+}
+
+int SharedGraphStore::releaseClaims(pid_t claimer)
+{
+    int released = 0;
+    Lock lock(this->header->mutex);
+    for (int i = 0; i < this->header->numRecords; ++i)
+    {
+        Record &record = this->header->records[i];
+        if (record.state == Claimed && record.claimedBy == claimer)
+        {
+            record.state = Pending;
+            record.claimedBy = 0;
+            released++;
+        }
+    }
+    return released;
+}
+
+std::vector<SharedGraphStore::SharedGraph> SharedGraphStore::snapshot() const
+{
+    std::vector<SharedGraph> graphs;
+    Lock lock(this->header->mutex);
+    graphs.reserve(this->header->numRecords);
+    for (int i = 0; i < this->header->numRecords; ++i)
+    {
+        graphs.push_back(copyRecord(this->header->records[i], false));
+    }
+    return graphs;
+}
+
+bool SharedGraphStore::find(int graphID, SharedGraph &graph) const
+{
+    Lock lock(this->header->mutex);
+    for (int i = 0; i < this->header->numRecords; ++i)
+    {
+        if (this->header->records[i].graphID == graphID)
+        {
+            graph = copyRecord(this->header->records[i], true);
+            return true;
+        }
+    }
+    return false;
+}
+
+std::string SharedGraphStore::getStatistics() const
+{
+    int states[Done + 1] = {0};
+    int numRecords;
+    size_t edgesUsed;
+    {
+        Lock lock(this->header->mutex);
+        numRecords = this->header->numRecords;
+        edgesUsed = this->header->edgesUsed;
+        for (int i = 0; i < numRecords; ++i)
+        {
+            states[this->header->records[i].state]++;
+        }
+    }
+    return "Shared Graph Store " + this->name + " | graphs " + std::to_string(numRecords) + " of " + std::to_string(SHARED_STORE_MAX_GRAPHS) +
+           " (pending " + std::to_string(states[Pending]) + ", claimed " + std::to_string(states[Claimed]) + ", done " + std::to_string(states[Done]) +
+           ") | edges " + std::to_string(edgesUsed) + " of " + std::to_string(this->header->edgesCapacity) + "\n";
+}
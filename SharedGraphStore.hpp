@@ -0,0 +1,78 @@
+#ifndef SHAREDGRAPHSTORE_HPP
+#define SHAREDGRAPHSTORE_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <cstddef>
+#include <sys/types.h>
+#include "Graph.hpp"
+
+#define SHARED_STORE_MAX_GRAPHS 4096 // Records of the store (graphs are never removed)
+
+/*
+    Graph and MST store shared by the worker processes in a POSIX shared memory segment.
+    A worker publishes every graph it stores (edges and MST edges). Workers running the
+    Pipeline or the Leader-Follower claim the pending graphs of all workers, compute the MST
+    data and write it back, so any worker can serve any graph. The segment is guarded by a
+    robust process-shared mutex: a worker dying while holding it does not block the others,
+    and the supervisor returns the claims of a dead worker to the pending state.
+*/
+class SharedGraphStore
+{
+public:
+    enum State
+    {
+        Pending = 1, // MST computed, MST data not yet
+        Claimed,     // A worker is computing the MST data
+        Done         // MST data available (the metrics of mstMetrics)
+    };
+
+    // Copy of a record, taken under the lock
+    struct SharedGraph
+    {
+        int graphID;
+        State state;
+        int worker;                        // Worker that created the graph
+        int numVertices;
+        int numEdges;
+        std::vector<WeightedEdge> edges;   // Only filled by claimPending() and find()
+        std::vector<WeightedEdge> mstEdges;
+        Graph::Sum mstTotalWeight;
+        Graph::Sum mstLongestDistance;
+        Graph::Sum mstShortestDistance;
+        double mstAvgEdgeWeight;
+        uint32_t mstMetrics;               // MetricRegistry bits of the metrics computed
+    };
+
+private:
+    struct Record;
+    struct Header;
+    class Lock;
+
+    std::string name;     // Name of the segment (shm_open)
+    Header *header;       // Start of the mapping
+    size_t size;          // Bytes mapped
+    bool owner;           // Unlinks the segment on destruction
+
+    SharedGraphStore(const std::string &name, Header *header, size_t size, bool owner);
+    WeightedEdge *edgesAt(size_t offset) const;
+    SharedGraph copyRecord(const Record &record, bool withEdges) const;
+
+public:
+    static std::unique_ptr<SharedGraphStore> create(const std::string &name, size_t bytes); // Throws std::runtime_error
+    static std::unique_ptr<SharedGraphStore> attach(const std::string &name);               // Throws std::runtime_error
+    ~SharedGraphStore();
+
+    std::atomic<int> &graphIDCounter();                          // Graph ids unique across the workers
+    bool publish(const Graph &graph, int worker);                // Add a graph with its MST (false - store full)
+    std::vector<SharedGraph> claimPending(pid_t claimer, uint32_t metrics); // Claim the pending graphs and the done ones lacking some of the metrics
+    void complete(const Graph &graph);                           // Add the computed MST data of a claimed graph
+    int releaseClaims(pid_t claimer);                            // Return the claims of a dead worker, number released
+    std::vector<SharedGraph> snapshot() const;                   // Every graph, without its edges
+    bool find(int graphID, SharedGraph &graph) const;            // One graph with its edges (false - unknown id)
+    std::string getStatistics() const;                           // One line summary
+};
+
+#endif
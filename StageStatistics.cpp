@@ -0,0 +1,117 @@
+#include "StageStatistics.hpp"
+#include <sstream>
+#include <iomanip>
+
+#define HISTOGRAM_MAX_NANOS 3600000000000LL // 1 hour
+#define HISTOGRAM_MAX_DEPTH 100000000LL
+#define STATISTICS_SIGNIFICANT_DIGITS 2
+#define NANOS_PER_MICRO 1000.0
+
+StageStatistics::StageStatistics(const std::string &name)
+    : name(name), startTime(std::chrono::steady_clock::now()),
+      queueDepthHistogram(HISTOGRAM_MAX_DEPTH, STATISTICS_SIGNIFICANT_DIGITS),
+      waitTimeHistogram(HISTOGRAM_MAX_NANOS, STATISTICS_SIGNIFICANT_DIGITS),
+      serviceTimeHistogram(HISTOGRAM_MAX_NANOS, STATISTICS_SIGNIFICANT_DIGITS) {}
+
+void StageStatistics::recordEnqueue(int64_t depthAfter)
+{
+    this->enqueuedTasks.store(this->enqueuedTasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    this->queueDepth.store(depthAfter, std::memory_order_relaxed);
+    if (depthAfter > this->maxQueueDepth.load(std::memory_order_relaxed))
+    {
+        this->maxQueueDepth.store(depthAfter, std::memory_order_relaxed);
+    }
+    this->queueDepthHistogram.recordValue(depthAfter);
+}
+
+void StageStatistics::recordDequeue(int64_t depthAfter)
+{
+    this->queueDepth.store(depthAfter, std::memory_order_relaxed);
+}
+
+void StageStatistics::recordWait(std::chrono::steady_clock::time_point enqueueTime)
+{
+    auto wait = std::chrono::steady_clock::now() - enqueueTime;
+    this->waitTimeHistogram.recordValue(std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count());
+}
+
+void StageStatistics::recordExecution(std::chrono::nanoseconds serviceTime, bool success)
+{
+    this->serviceTimeHistogram.recordValue(serviceTime.count());
+    this->processedTasks.store(this->processedTasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    if (!success)
+    {
+        this->failedTasks.store(this->failedTasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+}
+
+void StageStatistics::recordCancelled()
+{
+    this->cancelledTasks.store(this->cancelledTasks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void StageStatistics::recordFused()
+{
+    this->fusedTasks.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t StageStatistics::getProcessedTasks() const
+{
+    return this->processedTasks.load(std::memory_order_relaxed);
+}
+
+int64_t StageStatistics::getQueueDepth() const
+{
+    return this->queueDepth.load(std::memory_order_relaxed);
+}
+
+double StageStatistics::getThroughput() const
+{
+    std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - this->startTime;
+    return uptime.count() > 0 ? this->getProcessedTasks() / uptime.count() : 0.0;
+}
+
+// One line summary - times in microseconds
+std::string StageStatistics::report() const
+{
+    std::stringstream line;
+    line << std::fixed << std::setprecision(1);
+    line << this->name;
+
+    // Queue part - units that only process (Leader-Follower workers) share the queue of the pool
+    if (this->enqueuedTasks.load(std::memory_order_relaxed) > 0)
+    {
+        line << " | enqueued " << this->enqueuedTasks.load(std::memory_order_relaxed)
+             << " | queue depth " << this->getQueueDepth()
+             << " (p99 " << this->queueDepthHistogram.getValueAtPercentile(99.0)
+             << ", max " << this->maxQueueDepth.load(std::memory_order_relaxed) << ")";
+    }
+    if (this->getProcessedTasks() > 0 || this->enqueuedTasks.load(std::memory_order_relaxed) == 0)
+    {
+        line << " | processed " << this->getProcessedTasks()
+             << " | failed " << this->failedTasks.load(std::memory_order_relaxed)
+             << " | throughput " << this->getThroughput() << "/s";
+    }
+    if (this->cancelledTasks.load(std::memory_order_relaxed) > 0)
+    {
+        line << " | cancelled " << this->cancelledTasks.load(std::memory_order_relaxed);
+    }
+    if (this->fusedTasks.load(std::memory_order_relaxed) > 0)
+    {
+        line << " | fused " << this->fusedTasks.load(std::memory_order_relaxed);
+    }
+    if (this->waitTimeHistogram.getTotalCount() > 0)
+    {
+        line << " | wait us p50 " << this->waitTimeHistogram.getValueAtPercentile(50.0) / NANOS_PER_MICRO
+             << " p99 " << this->waitTimeHistogram.getValueAtPercentile(99.0) / NANOS_PER_MICRO
+             << " max " << this->waitTimeHistogram.getMax() / NANOS_PER_MICRO;
+    }
+    if (this->serviceTimeHistogram.getTotalCount() > 0)
+    {
+        line << " | handler us p50 " << this->serviceTimeHistogram.getValueAtPercentile(50.0) / NANOS_PER_MICRO
+             << " p99 " << this->serviceTimeHistogram.getValueAtPercentile(99.0) / NANOS_PER_MICRO
+             << " max " << this->serviceTimeHistogram.getMax() / NANOS_PER_MICRO;
+    }
+    line << "\n";
+    return line.str();
+}
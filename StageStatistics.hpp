@@ -0,0 +1,50 @@
+#ifndef STAGESTATISTICS_HPP
+#define STAGESTATISTICS_HPP
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include "LatencyHistogram.hpp"
+
+/*
+    Counters and histograms of one processing unit (a pipeline stage or a Leader-Follower worker).
+    Every field has a single writer at a time (the unit's thread, or the producer side while it
+    holds the queue mutex) and is published with relaxed atomics, so the statistics can be
+    read and aggregated at any time without taking any lock of the processing path.
+*/
+class StageStatistics
+{
+private:
+    std::string name;                                // Display name of the unit
+    std::chrono::steady_clock::time_point startTime; // Creation time - base for the throughput
+    std::atomic<uint64_t> enqueuedTasks{0};          // Tasks pushed to the queue
+    std::atomic<uint64_t> processedTasks{0};         // Tasks that ran the handler
+    std::atomic<uint64_t> failedTasks{0};            // Tasks whose handler threw
+    std::atomic<uint64_t> cancelledTasks{0};         // Tasks dropped by their cancellation token (before or while running)
+    std::atomic<uint64_t> fusedTasks{0};             // Tasks whose handler an earlier unit ran inline - the only multi-writer counter
+    std::atomic<int64_t> queueDepth{0};              // Current queue depth
+    std::atomic<int64_t> maxQueueDepth{0};           // Highest queue depth seen
+    LatencyHistogram queueDepthHistogram;            // Queue depth sampled on every enqueue
+    LatencyHistogram waitTimeHistogram;              // Enqueue to dequeue time (ns)
+    LatencyHistogram serviceTimeHistogram;           // Handler execution time (ns)
+
+public:
+    StageStatistics(const std::string &name);
+
+    // Queue side - call while holding the queue mutex, with the depth after the operation
+    void recordEnqueue(int64_t depthAfter);
+    void recordDequeue(int64_t depthAfter);
+    // Worker side - call from the unit's thread
+    void recordWait(std::chrono::steady_clock::time_point enqueueTime);
+    void recordExecution(std::chrono::nanoseconds serviceTime, bool success);
+    void recordCancelled();
+    void recordFused(); // Any thread
+
+    uint64_t getProcessedTasks() const;
+    int64_t getQueueDepth() const;
+    double getThroughput() const;                    // Processed tasks per second since creation
+    std::string report() const;                      // One line summary
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef TASK_HPP
+#define TASK_HPP
+
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <utility>
+
+/*
+    Lazily started coroutine returning T.
+    co_await on a Task starts it and resumes the awaiting coroutine when it finishes (symmetric
+    transfer, so long await chains do not grow the stack). Exceptions propagate to the awaiter.
+    The Task owns its coroutine frame - destroying a suspended parent destroys the whole chain.
+*/
+template <typename T = void>
+class Task;
+
+namespace detail
+{
+    struct TaskPromiseBase
+    {
+        std::coroutine_handle<> continuation;   // Coroutine awaiting this task
+        std::exception_ptr exception;           // Exception thrown by the task body
+
+        struct FinalAwaiter
+        {
+            bool await_ready() noexcept { return false; }
+
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                std::coroutine_handle<> continuation = handle.promise().continuation;
+                return continuation ? continuation : std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void unhandled_exception() { this->exception = std::current_exception(); }
+    };
+
+    template <typename T>
+    struct TaskPromise : TaskPromiseBase
+    {
+        std::optional<T> value;
+
+        Task<T> get_return_object();
+        void return_value(T result) { this->value = std::move(result); }
+
+        T result()
+        {
+            if (this->exception)
+            {
+                std::rethrow_exception(this->exception);
+            }
+            return std::move(*this->value);
+        }
+    };
+
+    template <>
+    struct TaskPromise<void> : TaskPromiseBase
+    {
+        Task<void> get_return_object();
+        void return_void() {}
+
+        void result()
+        {
+            if (this->exception)
+            {
+                std::rethrow_exception(this->exception);
+            }
+        }
+    };
+}
+
+template <typename T>
+class Task
+{
+public:
+    using promise_type = detail::TaskPromise<T>;
+
+private:
+    std::coroutine_handle<promise_type> handle;
+
+public:
+    explicit Task(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+    Task(Task &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+    Task(const Task &) = delete;
+    Task &operator=(const Task &) = delete;
+
+    Task &operator=(Task &&other) noexcept
+    {
+        if (this != &other)
+        {
+            if (this->handle)
+            {
+                this->handle.destroy();
+            }
+            this->handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    ~Task()
+    {
+        if (this->handle)
+        {
+            this->handle.destroy();
+        }
+    }
+
+    bool await_ready() const noexcept { return false; }
+
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        this->handle.promise().continuation = awaiting;
+        return this->handle;
+    }
+
+    T await_resume() { return this->handle.promise().result(); }
+};
+
+namespace detail
+{
+    template <typename T>
+    Task<T> TaskPromise<T>::get_return_object()
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object()
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+    }
+}
+
+#endif
@@ -0,0 +1,121 @@
+#include "TaskScheduler.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#define FLOYD_WARSHALL_RUNS 2 // Longest and shortest distance metrics
+#define NUMA_LOOKAHEAD 4      // Tasks of the policy order searched for a node-local graph
+
+TaskScheduler::TaskScheduler(Policy policy, double slowdown)
+    : policy(policy), slowdown(slowdown), nextSequence(0), epoch(std::chrono::steady_clock::now()), virtualTime(0.0) {}
+
+void TaskScheduler::push(GraphTask task)
+{
+    double key = 0.0;
+    switch (this->policy)
+    {
+        case SJF:
+        {
+            double enqueueNs = std::chrono::duration<double, std::nano>(task.enqueueTime - this->epoch).count();
+            key = enqueueNs + this->slowdown * task.cost;
+            break;
+        }
+        case WFQ:
+        {
+            double &clientFinish = this->lastFinish[task.clientID];
+            key = std::max(this->virtualTime, clientFinish) + task.cost;
+            clientFinish = key;
+            break;
+        }
+        default:
+            key = static_cast<double>(this->nextSequence);
+            break;
+    }
+    this->heap.push(Entry{std::move(task), key, this->nextSequence++});
+}
+
+GraphTask TaskScheduler::pop(int preferredNode)
+{
+    Entry entry = this->heap.top();
+    this->heap.pop();
+    if (preferredNode >= 0 && entry.task.numaNode >= 0 && entry.task.numaNode != preferredNode)
+    {
+        // Look a few tasks further for one on the worker's node - the passed over tasks go back
+        std::vector<Entry> skipped;
+        while (!this->heap.empty() && skipped.size() + 1 < NUMA_LOOKAHEAD && entry.task.numaNode != preferredNode)
+        {
+            skipped.push_back(std::move(entry));
+            entry = this->heap.top();
+            this->heap.pop();
+        }
+        if (entry.task.numaNode != preferredNode)
+        {
+            skipped.push_back(std::move(entry));
+            entry = std::move(skipped.front());
+            skipped.erase(skipped.begin());
+        }
+        for (Entry &other : skipped)
+        {
+            this->heap.push(std::move(other));
+        }
+    }
+    if (this->policy == WFQ)
+    {
+        this->virtualTime = entry.key;
+        if (this->heap.empty())
+        {
+            // Idle - no client has backlog, so the finish tags can start over
+            this->virtualTime = 0.0;
+            this->lastFinish.clear();
+        }
+    }
+    return std::move(entry.task);
+}
+
+bool TaskScheduler::empty() const
+{
+    return this->heap.empty();
+}
+
+size_t TaskScheduler::size() const
+{
+    return this->heap.size();
+}
+
+void TaskScheduler::clear()
+{
+    this->heap = std::priority_queue<Entry, std::vector<Entry>, Later>();
+    this->virtualTime = 0.0;
+    this->lastFinish.clear();
+}
+
+TaskScheduler::Policy TaskScheduler::getPolicy() const
+{
+    return this->policy;
+}
+
+double TaskScheduler::estimateCost(const Graph &graph)
+{
+    double numVertices = graph.getSizeVertices();
+    return FLOYD_WARSHALL_RUNS * numVertices * numVertices * numVertices + graph.getSizeEdges();
+}
+
+TaskScheduler::Policy TaskScheduler::parsePolicy(const std::string &name)
+{
+    if (name == "fifo") return FIFO;
+    if (name == "sjf") return SJF;
+    if (name == "wfq") return WFQ;
+    throw std::invalid_argument("Unknown scheduling policy " + name + " (fifo|sjf|wfq)");
+}
+
+std::string TaskScheduler::policyName(Policy policy)
+{
+    switch (policy)
+    {
+        case SJF:
+            return "sjf";
+        case WFQ:
+            return "wfq";
+        default:
+            return "fifo";
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef TASKSCHEDULER_HPP
+#define TASKSCHEDULER_HPP
+
+#include <queue>
+#include <vector>
+#include <unordered_map>
+#include <string>
+#include <cstdint>
+#include "GraphTask.hpp"
+
+/*
+    Ordering of the Leader-Follower task queue.
+    FIFO - arrival order.
+    SJF  - shortest estimated job first with aging: a task is ordered by its virtual deadline
+           enqueueTime + slowdown * estimatedServiceTime, so a large graph waits behind small ones
+           at most about slowdown times its own service time and is never starved.
+    WFQ  - self-clocked weighted fair queuing between clients (graph owners): every client gets
+           an equal share of the estimated work, so one client's bulk batch cannot monopolize the
+           workers. Tasks of the same client keep their arrival order.
+    A worker may name its NUMA node: among the next few tasks of the policy it takes the first
+    one whose graph is on that node, so the policy order is only bent within that window.
+    Not thread safe - guarded by the Leader-Follower queue mutex.
+*/
+class TaskScheduler
+{
+public:
+    enum Policy
+    {
+        FIFO,
+        SJF,
+        WFQ
+    };
+
+private:
+    struct Entry
+    {
+        GraphTask task;
+        double key;         // Smaller key is served first
+        uint64_t sequence;  // Arrival order - breaks ties
+    };
+
+    struct Later
+    {
+        bool operator()(const Entry &a, const Entry &b) const
+        {
+            return a.key > b.key || (a.key == b.key && a.sequence > b.sequence);
+        }
+    };
+
+    Policy policy;
+    double slowdown;                                                // SJF aging - bound on the relative wait of a large task
+    std::priority_queue<Entry, std::vector<Entry>, Later> heap;     // Waiting tasks
+    uint64_t nextSequence;                                          // Arrival counter
+    std::chrono::steady_clock::time_point epoch;                    // Time zero of the SJF keys
+    double virtualTime;                                             // WFQ - finish tag of the last served task
+    std::unordered_map<int, double> lastFinish;                     // WFQ - finish tag of the last task of each client
+
+public:
+    TaskScheduler(Policy policy = FIFO, double slowdown = 10.0);
+
+    void push(GraphTask task);
+    GraphTask pop(int preferredNode = -1); // Next task to serve, node-local if one is near the head - must not be empty
+    bool empty() const;
+    size_t size() const;
+    void clear();
+
+    Policy getPolicy() const;
+    static double estimateCost(const Graph &graph); // Estimated work (~ns): two Floyd-Warshall runs plus the edges
+    static Policy parsePolicy(const std::string &name); // Throws std::invalid_argument
+    static std::string policyName(Policy policy);
+};
+
+#endif
@@ -0,0 +1,158 @@
+#include "Tracer.hpp"
+#include "Logger.hpp"
+#include <fstream>
+#include <iomanip>
+#include <unistd.h>
+
+#define TRACE_PROCESS_ID 1
+
+static thread_local std::string currentThreadName; // Name given before the buffer is created
+
+static std::string escapeJson(const std::string &text)
+{
+    std::string escaped;
+    for (char c : text)
+    {
+        if (c == '"' || c == '\\')
+        {
+            escaped.push_back('\\');
+        }
+        escaped.push_back(c == '\n' ? ' ' : c);
+    }
+    return escaped;
+}
+
+Tracer &Tracer::getInstance()
+{
+    static Tracer instance;
+    return instance;
+}
+
+Tracer::ThreadBuffer &Tracer::localBuffer()
+{
+    static std::atomic<uint64_t> nextThreadTag{1};
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer)
+    {
+        buffer = std::make_shared<ThreadBuffer>();
+        buffer->threadTag = nextThreadTag++;
+        buffer->threadName = currentThreadName;
+        std::lock_guard<std::mutex> lock(this->mtx_tracer);
+        this->buffers.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Tracer::setThreadName(const std::string &name)
+{
+    currentThreadName = name;
+}
+
+double Tracer::toMicros(Clock::time_point time) const
+{
+    return std::chrono::duration<double, std::micro>(time - this->epoch).count();
+}
+
+void Tracer::record(TraceEvent event)
+{
+    ThreadBuffer &buffer = localBuffer();
+    std::lock_guard<std::mutex> lock(buffer.mtx);
+    buffer.events.push_back(std::move(event));
+}
+
+void Tracer::recordComplete(const std::string &name, const char *category, int graphID, Clock::time_point begin, Clock::time_point end)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    record(TraceEvent{name, category, 'X', toMicros(begin), toMicros(end) - toMicros(begin), graphID});
+}
+
+// Async begin / end pair on the track of the graph (used for queue waits, which belong to no thread)
+void Tracer::recordAsync(const std::string &name, const char *category, int graphID, Clock::time_point begin, Clock::time_point end)
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+    record(TraceEvent{name, category, 'b', toMicros(begin), 0.0, graphID});
+    record(TraceEvent{name, category, 'e', toMicros(end), 0.0, graphID});
+}
+
+bool Tracer::start(const std::string &path)
+{
+    std::lock_guard<std::mutex> lock(this->mtx_tracer);
+    if (this->enabled)
+    {
+        LOG_WARN("Tracer: Already tracing to " << this->outputPath);
+        return false;
+    }
+    for (auto &buffer : this->buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mtx);
+        buffer->events.clear();
+    }
+    this->outputPath = path;
+    this->epoch = Clock::now();
+    this->enabled = true;
+    LOG_INFO("Tracer: Started, trace file " << path);
+    return true;
+}
+
+bool Tracer::stop()
+{
+    std::lock_guard<std::mutex> lock(this->mtx_tracer);
+    if (!this->enabled)
+    {
+        return false;
+    }
+    this->enabled = false;
+
+    std::ofstream file(this->outputPath);
+    if (!file)
+    {
+        LOG_ERROR("Tracer: Cannot open trace file " << this->outputPath);
+        return false;
+    }
+
+    size_t numEvents = 0;
+    bool first = true;
+    file << std::fixed << std::setprecision(3) << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    for (auto &buffer : this->buffers)
+    {
+        std::lock_guard<std::mutex> bufferLock(buffer->mtx);
+        if (buffer->events.empty())
+        {
+            continue;
+        }
+        if (!buffer->threadName.empty())
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":" << TRACE_PROCESS_ID
+                 << ",\"tid\":" << buffer->threadTag << ",\"args\":{\"name\":\"" << escapeJson(buffer->threadName) << "\"}}";
+            first = false;
+        }
+        for (const auto &event : buffer->events)
+        {
+            file << (first ? "" : ",\n") << "{\"name\":\"" << escapeJson(event.name) << "\",\"cat\":\"" << event.category
+                 << "\",\"ph\":\"" << event.phase << "\",\"ts\":" << event.timestampUs
+                 << ",\"pid\":" << TRACE_PROCESS_ID << ",\"tid\":" << buffer->threadTag;
+            if (event.phase == 'X')
+            {
+                file << ",\"dur\":" << event.durationUs;
+            }
+            else
+            {
+                file << ",\"id\":" << event.graphID;
+            }
+            file << ",\"args\":{\"graph\":" << event.graphID << "}}";
+            first = false;
+        }
+        numEvents += buffer->events.size();
+        buffer->events.clear();
+        buffer->events.shrink_to_fit();
+    }
+    file << "\n]}\n";
+    LOG_INFO("Tracer: Stopped, " << numEvents << " events written to " << this->outputPath);
+    return true;
+}
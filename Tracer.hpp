@@ -0,0 +1,101 @@
+#ifndef TRACER_HPP
+#define TRACER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#define TRACE_NO_GRAPH -1
+
+/*
+    Timeline tracer writing Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+    Spans are recorded per thread into a buffer guarded by its own (uncontended) mutex and
+    written to the file when tracing stops. When tracing is disabled a span costs one relaxed
+    atomic load.
+    Thread spans are "complete" events tagged with the graph id; queue waits are async events
+    whose id is the graph id, so each graph gets its own track in the viewer.
+*/
+class Tracer
+{
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct TraceEvent
+    {
+        std::string name;       // Span name
+        const char *category;   // Span category
+        char phase;             // 'X' complete, 'b' / 'e' async begin / end
+        double timestampUs;     // Start time since the trace epoch
+        double durationUs;      // Duration (complete events)
+        int graphID;            // Graph the span belongs to (TRACE_NO_GRAPH if none)
+    };
+
+    // Events of one thread
+    struct ThreadBuffer
+    {
+        std::mutex mtx;                  // Taken by the owner on every event and by stop() once
+        std::vector<TraceEvent> events;  // Recorded events
+        std::string threadName;          // Name shown in the viewer
+        uint64_t threadTag = 0;          // Short id of the thread
+    };
+
+private:
+    std::atomic<bool> enabled{false};                       // Tracing is active
+    std::mutex mtx_tracer;                                  // Guards the registry and start / stop
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers;     // Buffers of all threads that traced
+    std::string outputPath;                                 // File written by stop()
+    Clock::time_point epoch;                                // Time zero of the trace
+
+    Tracer() = default;
+    ThreadBuffer &localBuffer();                            // Buffer of the calling thread
+    double toMicros(Clock::time_point time) const;
+    void record(TraceEvent event);
+
+public:
+    static Tracer &getInstance();
+
+    bool isEnabled() const { return this->enabled.load(std::memory_order_relaxed); }
+    bool start(const std::string &path);                    // Start a new trace written to path
+    bool stop();                                            // Stop and write the trace file
+
+    static void setThreadName(const std::string &name);     // Name of the calling thread in the viewer
+    void recordComplete(const std::string &name, const char *category, int graphID, Clock::time_point begin, Clock::time_point end);
+    void recordAsync(const std::string &name, const char *category, int graphID, Clock::time_point begin, Clock::time_point end);
+};
+
+// RAII span of the calling thread
+class TraceSpan
+{
+private:
+    const char *name;
+    const char *category;
+    int graphID;
+    bool active;                        // Tracing was enabled when the span started
+    Tracer::Clock::time_point begin;
+
+public:
+    TraceSpan(const char *name, const char *category, int graphID = TRACE_NO_GRAPH)
+        : name(name), category(category), graphID(graphID), active(Tracer::getInstance().isEnabled())
+    {
+        if (this->active)
+        {
+            this->begin = Tracer::Clock::now();
+        }
+    }
+
+    ~TraceSpan()
+    {
+        if (this->active)
+        {
+            Tracer::getInstance().recordComplete(this->name, this->category, this->graphID, this->begin, Tracer::Clock::now());
+        }
+    }
+
+    void setGraphID(int id) { this->graphID = id; }
+};
+
+#endif
@@ -0,0 +1,471 @@
+#include "UringEventLoop.hpp"
+#include "Logger.hpp"
+#include "Tracer.hpp"
+#include "NumaTopology.hpp"
+#include <stdexcept>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include <cerrno>
+#include <cstring>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+
+#define URING_WAKE_TAG 1          // user_data of the wake up eventfd poll
+#define URING_ACCEPT_TAG 2        // user_data of the accept (operations use their address)
+#define URING_ACCEPT_RETRY_TAG 3  // user_data of the back-off timeout before the accept is re-armed
+#define URING_ACCEPT_RETRY_MIN_MS 10
+#define URING_ACCEPT_RETRY_MAX_MS 1000
+#define URING_BUFFER_GROUP 0      // Group id of the provided receive buffers
+#define URING_DRAIN_TIMEOUT_MS 1000
+
+UringEventLoop::UringEventLoop(int index)
+    : EventLoop(index), ringFD(-1), ringMemory(MAP_FAILED), ringSize(0), sqes(static_cast<io_uring_sqe *>(MAP_FAILED)), sqesSize(0),
+      localTail(0), bufferRing(static_cast<io_uring_buf_ring *>(MAP_FAILED)), bufferRingSize(0), buffers(nullptr), bufferTail(0),
+      wakeCount(0), listenFD(-1), multishotAccept(true), acceptFailures(0), acceptRetryDelay{}, inFlight(0)
+{
+    try
+    {
+        setupRing();
+        setupBuffers();
+    }
+    catch (...)
+    {
+        releaseRing();
+        throw;
+    }
+    startThread();
+}
+
+UringEventLoop::~UringEventLoop()
+{
+    joinThread();
+    drain();
+    destroySessions();
+    releaseRing();
+}
+
+void UringEventLoop::setupRing()
+{
+    io_uring_params params{};
+    params.flags = IORING_SETUP_SUBMIT_ALL | IORING_SETUP_COOP_TASKRUN;
+    this->ringFD = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    if (this->ringFD < 0 && errno == EINVAL) // Older kernel - retry without the optional flags
+    {
+        params = io_uring_params{};
+        this->ringFD = syscall(__NR_io_uring_setup, URING_ENTRIES, &params);
+    }
+    if (this->ringFD < 0)
+    {
+        throw std::runtime_error("io_uring_setup failed: " + std::string(strerror(errno)));
+    }
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP))
+    {
+        throw std::runtime_error("io_uring without single mmap support");
+    }
+
+    this->ringSize = std::max(params.sq_off.array + params.sq_entries * sizeof(unsigned),
+                              params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe));
+    this->ringMemory = mmap(nullptr, this->ringSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFD, IORING_OFF_SQ_RING);
+    this->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    this->sqes = static_cast<io_uring_sqe *>(mmap(nullptr, this->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this->ringFD, IORING_OFF_SQES));
+    if (this->ringMemory == MAP_FAILED || this->sqes == MAP_FAILED)
+    {
+        throw std::runtime_error("io_uring mmap failed: " + std::string(strerror(errno)));
+    }
+
+    char *ring = static_cast<char *>(this->ringMemory);
+    this->sqHead = reinterpret_cast<unsigned *>(ring + params.sq_off.head);
+    this->sqTail = reinterpret_cast<unsigned *>(ring + params.sq_off.tail);
+    this->sqMask = reinterpret_cast<unsigned *>(ring + params.sq_off.ring_mask);
+    this->sqArray = reinterpret_cast<unsigned *>(ring + params.sq_off.array);
+    this->cqHead = reinterpret_cast<unsigned *>(ring + params.cq_off.head);
+    this->cqTail = reinterpret_cast<unsigned *>(ring + params.cq_off.tail);
+    this->cqMask = reinterpret_cast<unsigned *>(ring + params.cq_off.ring_mask);
+    this->cqes = reinterpret_cast<io_uring_cqe *>(ring + params.cq_off.cqes);
+    this->sqEntries = params.sq_entries;
+    this->localTail = *this->sqTail;
+}
+
+void UringEventLoop::setupBuffers()
+{
+    this->bufferRingSize = URING_BUFFERS * sizeof(io_uring_buf);
+    this->bufferRing = static_cast<io_uring_buf_ring *>(mmap(nullptr, this->bufferRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0));
+    if (this->bufferRing == MAP_FAILED)
+    {
+        throw std::runtime_error("io_uring buffer ring mmap failed: " + std::string(strerror(errno)));
+    }
+    this->buffers = new char[URING_BUFFERS * URING_BUFFER_SIZE];
+
+    io_uring_buf_reg registration{};
+    registration.ring_addr = reinterpret_cast<uint64_t>(this->bufferRing);
+    registration.ring_entries = URING_BUFFERS;
+    registration.bgid = URING_BUFFER_GROUP;
+    if (syscall(__NR_io_uring_register, this->ringFD, IORING_REGISTER_PBUF_RING, &registration, 1) < 0)
+    {
+        throw std::runtime_error("io_uring buffer ring registration failed: " + std::string(strerror(errno)));
+    }
+    for (unsigned short bufferID = 0; bufferID < URING_BUFFERS; ++bufferID)
+    {
+        recycleBuffer(bufferID);
+    }
+}
+
+void UringEventLoop::releaseRing()
+{
+    if (this->ringFD >= 0)
+    {
+        close(this->ringFD);
+    }
+    if (this->sqes != MAP_FAILED)
+    {
+        munmap(this->sqes, this->sqesSize);
+    }
+    if (this->ringMemory != MAP_FAILED)
+    {
+        munmap(this->ringMemory, this->ringSize);
+    }
+    if (this->bufferRing != MAP_FAILED)
+    {
+        munmap(this->bufferRing, this->bufferRingSize);
+    }
+    delete[] this->buffers;
+}
+
+io_uring_sqe *UringEventLoop::getSQE()
+{
+    while (this->localTail - __atomic_load_n(this->sqHead, __ATOMIC_ACQUIRE) >= this->sqEntries)
+    {
+        int result = submit(0);
+        if (result < 0 && result != -EINTR)
+        {
+            throw std::runtime_error("io_uring submission failed: " + std::string(strerror(-result)));
+        }
+    }
+    unsigned slot = this->localTail & *this->sqMask;
+    io_uring_sqe *sqe = &this->sqes[slot];
+    memset(sqe, 0, sizeof(*sqe));
+    this->sqArray[slot] = slot;
+    this->localTail++;
+    return sqe;
+}
+
+int UringEventLoop::submit(unsigned waitFor)
+{
+    __atomic_store_n(this->sqTail, this->localTail, __ATOMIC_RELEASE);
+    unsigned pending = this->localTail - __atomic_load_n(this->sqHead, __ATOMIC_ACQUIRE);
+    if (pending == 0 && waitFor == 0)
+    {
+        return 0;
+    }
+    int result = syscall(__NR_io_uring_enter, this->ringFD, pending, waitFor, waitFor > 0 ? IORING_ENTER_GETEVENTS : 0, nullptr, 0);
+    return result < 0 ? -errno : result;
+}
+
+io_uring_sqe *UringEventLoop::prepare(uint8_t opcode, int fd, Operation *operation)
+{
+    io_uring_sqe *sqe = getSQE();
+    sqe->opcode = opcode;
+    sqe->fd = fd;
+    sqe->user_data = reinterpret_cast<uint64_t>(operation);
+    this->inFlight++;
+    return sqe;
+}
+
+void UringEventLoop::armWake()
+{
+    io_uring_sqe *sqe = getSQE();
+    sqe->opcode = IORING_OP_POLL_ADD; // Poll instead of read - the eventfd is non-blocking
+    sqe->fd = this->wakeFD;
+    sqe->poll32_events = POLLIN;
+    sqe->user_data = URING_WAKE_TAG;
+}
+
+void UringEventLoop::armAccept()
+{
+    io_uring_sqe *sqe = getSQE();
+    sqe->opcode = IORING_OP_ACCEPT;
+    sqe->fd = this->listenFD;
+    sqe->accept_flags = SOCK_CLOEXEC;
+    sqe->ioprio = this->multishotAccept ? IORING_ACCEPT_MULTISHOT : 0;
+    sqe->user_data = URING_ACCEPT_TAG;
+}
+
+// A failing accept is retried after 10 ms, doubled per failure in a row up to 1 s
+void UringEventLoop::armAcceptRetry()
+{
+    long delayMs = std::min<long>(static_cast<long>(URING_ACCEPT_RETRY_MIN_MS) << std::min(this->acceptFailures - 1, 10), URING_ACCEPT_RETRY_MAX_MS);
+    this->acceptRetryDelay.tv_sec = delayMs / 1000;
+    this->acceptRetryDelay.tv_nsec = (delayMs % 1000) * 1000000;
+    io_uring_sqe *sqe = getSQE();
+    sqe->opcode = IORING_OP_TIMEOUT;
+    sqe->fd = -1;
+    sqe->addr = reinterpret_cast<uint64_t>(&this->acceptRetryDelay);
+    sqe->len = 1;
+    sqe->off = 0; // Pure timeout - not completed early by other completions
+    sqe->user_data = URING_ACCEPT_RETRY_TAG;
+}
+
+void UringEventLoop::recycleBuffer(unsigned short bufferID)
+{
+    // Entries start at the ring address (bufs[] of the kernel header is shifted in C++ by its empty struct wrapper)
+    // and are written field by field - the ring tail overlays the reserved field of the first entry
+    io_uring_buf *buffer = reinterpret_cast<io_uring_buf *>(this->bufferRing) + (this->bufferTail & (URING_BUFFERS - 1));
+    buffer->addr = reinterpret_cast<uint64_t>(this->buffers + static_cast<size_t>(bufferID) * URING_BUFFER_SIZE);
+    buffer->len = URING_BUFFER_SIZE;
+    buffer->bid = bufferID;
+    this->bufferTail++;
+    __atomic_store_n(&this->bufferRing->tail, this->bufferTail, __ATOMIC_RELEASE);
+}
+
+void UringEventLoop::run()
+{
+    Tracer::setThreadName("Event Loop " + std::to_string(this->index));
+    NumaTopology::getInstance().pinCurrentThread(this->index);
+    std::vector<io_uring_cqe> completions;
+    try
+    {
+        armWake();
+        while (this->running)
+        {
+            int result = submit(1); // Submit everything queued since the last wait and wait for a completion
+            this->numWaits.fetch_add(1, std::memory_order_relaxed);
+            if (result < 0 && result != -EINTR && result != -EBUSY && result != -EAGAIN)
+            {
+                LOG_ERROR("Event loop " << this->index << ": io_uring_enter failed: " << strerror(-result));
+                break;
+            }
+
+            // Copy the completions out first - handlers queue new entries and may fill the queue again
+            completions.clear();
+            unsigned head = *this->cqHead;
+            unsigned tail = __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE);
+            for (; head != tail; ++head)
+            {
+                completions.push_back(this->cqes[head & *this->cqMask]);
+            }
+            __atomic_store_n(this->cqHead, head, __ATOMIC_RELEASE);
+            this->numEvents.fetch_add(completions.size(), std::memory_order_relaxed);
+
+            for (const io_uring_cqe &completion : completions)
+            {
+                if (!this->running)
+                {
+                    break;
+                }
+                handleCompletion(completion.user_data, completion.res, completion.flags);
+            }
+        }
+    }
+    catch (const std::exception &e)
+    {
+        LOG_ERROR("Event loop " << this->index << ": " << e.what());
+    }
+}
+
+void UringEventLoop::handleCompletion(uint64_t userData, int result, uint32_t flags)
+{
+    if (userData == URING_WAKE_TAG)
+    {
+        uint64_t count;
+        ::read(this->wakeFD, &count, sizeof(count));
+        runPosted();
+        if (this->running)
+        {
+            armWake();
+        }
+    }
+    else if (userData == URING_ACCEPT_TAG)
+    {
+        bool backOff = false;
+        if (result >= 0)
+        {
+            if (this->acceptFailures > 0)
+            {
+                LOG_INFO("Event loop " << this->index << ": accepting again after " << this->acceptFailures << " failed accepts");
+                this->acceptFailures = 0;
+            }
+            this->onAccept(result);
+        }
+        else if (result == -EINVAL && this->multishotAccept)
+        {
+            LOG_WARN("Event loop " << this->index << ": Multishot accept not supported, accepting one connection per submission");
+            this->multishotAccept = false;
+        }
+        else
+        {
+            // Out of descriptors (EMFILE, ENFILE) every accept fails until one is closed - back off and log once per streak
+            if (this->acceptFailures++ == 0)
+            {
+                LOG_ERROR("Event loop " << this->index << ": accept failed: " << strerror(-result) << " - retrying with back-off");
+            }
+            backOff = true;
+        }
+        if (!(flags & IORING_CQE_F_MORE) && this->running)
+        {
+            if (backOff)
+            {
+                armAcceptRetry();
+            }
+            else
+            {
+                armAccept(); // The multishot accept ended (or was single-shot) - accept again
+            }
+        }
+    }
+    else if (userData == URING_ACCEPT_RETRY_TAG)
+    {
+        if (this->running)
+        {
+            armAccept();
+        }
+    }
+    else
+    {
+        Operation *operation = reinterpret_cast<Operation *>(userData);
+        this->inFlight--;
+        operation->result = result;
+        operation->flags = flags;
+        operation->handle.resume();
+    }
+}
+
+void UringEventLoop::drain()
+{
+    // The loop thread is gone - wake the pending receives of the sessions and wait until the kernel
+    // no longer references their frames, which are destroyed next
+    {
+        std::lock_guard<std::mutex> lock(this->mtx_posted);
+        for (int fd : this->ownedFDs)
+        {
+            shutdown(fd, SHUT_RDWR);
+        }
+    }
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(URING_DRAIN_TIMEOUT_MS);
+    while (this->inFlight > 0 && std::chrono::steady_clock::now() < deadline)
+    {
+        submit(0);
+        pollfd ring{this->ringFD, POLLIN, 0};
+        poll(&ring, 1, 100);
+        unsigned head = *this->cqHead;
+        unsigned tail = __atomic_load_n(this->cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &completion = this->cqes[head & *this->cqMask];
+            if (completion.user_data != URING_WAKE_TAG && completion.user_data != URING_ACCEPT_TAG && completion.user_data != URING_ACCEPT_RETRY_TAG)
+            {
+                this->inFlight--;
+            }
+        }
+        __atomic_store_n(this->cqHead, head, __ATOMIC_RELEASE);
+    }
+    if (this->inFlight > 0)
+    {
+        LOG_WARN("Event loop " << this->index << ": " << this->inFlight << " operations still pending at shutdown");
+    }
+}
+
+Task<ssize_t> UringEventLoop::read(int fd, char *buffer, size_t size)
+{
+    while (true)
+    {
+        Operation operation;
+        io_uring_sqe *sqe = prepare(IORING_OP_RECV, fd, &operation);
+        sqe->len = std::min<size_t>(size, URING_BUFFER_SIZE);
+        sqe->flags = IOSQE_BUFFER_SELECT; // The kernel picks a provided buffer when data arrives
+        sqe->buf_group = URING_BUFFER_GROUP;
+        int result = co_await operation;
+
+        if (operation.flags & IORING_CQE_F_BUFFER)
+        {
+            unsigned short bufferID = operation.flags >> IORING_CQE_BUFFER_SHIFT;
+            if (result > 0)
+            {
+                memcpy(buffer, this->buffers + static_cast<size_t>(bufferID) * URING_BUFFER_SIZE, result);
+            }
+            recycleBuffer(bufferID);
+        }
+        if (result == -ENOBUFS) // Every provided buffer is in use - receive into the buffer of the session
+        {
+            Operation direct;
+            sqe = prepare(IORING_OP_RECV, fd, &direct);
+            sqe->addr = reinterpret_cast<uint64_t>(buffer);
+            sqe->len = size;
+            result = co_await direct;
+        }
+        if (result == -EINTR || result == -EAGAIN)
+        {
+            continue;
+        }
+        co_return result >= 0 ? result : -1;
+    }
+}
+
+Task<bool> UringEventLoop::sendAll(int fd, std::string message)
+{
+    size_t offset = 0;
+    while (offset < message.size())
+    {
+        Operation operation;
+        io_uring_sqe *sqe = prepare(IORING_OP_SEND, fd, &operation);
+        sqe->addr = reinterpret_cast<uint64_t>(message.data() + offset);
+        sqe->len = message.size() - offset;
+        sqe->msg_flags = MSG_NOSIGNAL;
+        int result = co_await operation;
+        if (result > 0)
+        {
+            offset += result;
+        }
+        else if (result != -EINTR && result != -EAGAIN)
+        {
+            co_return false;
+        }
+    }
+    co_return true;
+}
+
+Task<ssize_t> UringEventLoop::receiveMsg(int fd, msghdr *message)
+{
+    while (true)
+    {
+        Operation operation;
+        io_uring_sqe *sqe = prepare(IORING_OP_RECVMSG, fd, &operation);
+        sqe->addr = reinterpret_cast<uint64_t>(message);
+        sqe->msg_flags = MSG_CMSG_CLOEXEC;
+        int result = co_await operation;
+        if (result != -EINTR && result != -EAGAIN)
+        {
+            co_return result >= 0 ? result : -1;
+        }
+    }
+}
+
+Task<ssize_t> UringEventLoop::sendMsg(int fd, const msghdr *message)
+{
+    while (true)
+    {
+        Operation operation;
+        io_uring_sqe *sqe = prepare(IORING_OP_SENDMSG, fd, &operation);
+        sqe->addr = reinterpret_cast<uint64_t>(message);
+        sqe->msg_flags = MSG_NOSIGNAL;
+        int result = co_await operation;
+        if (result != -EINTR && result != -EAGAIN)
+        {
+            co_return result >= 0 ? result : -1;
+        }
+    }
+}
+
+bool UringEventLoop::startAccept(int listenFD, std::function<void(int)> onAccept)
+{
+    post([this, listenFD, onAccept]()
+    {
+        this->listenFD = listenFD;
+        this->onAccept = onAccept;
+        armAccept();
+    });
+    return true;
+}
@@ -0,0 +1,90 @@
+#ifndef URINGEVENTLOOP_HPP
+#define URINGEVENTLOOP_HPP
+
+#include <functional>
+#include <linux/io_uring.h>
+#include "EventLoop.hpp"
+
+#define URING_ENTRIES 256      // Submission queue entries (completion queue is twice as large)
+#define URING_BUFFERS 256      // Receive buffers provided to the kernel (power of two)
+#define URING_BUFFER_SIZE 2048 // Bytes per receive buffer
+
+/*
+    Completion based event loop on io_uring (raw system calls, no liburing).
+    Sessions queue their receives and sends as submission entries, which are submitted in one
+    io_uring_enter together with the wait for completions - one system call per loop iteration
+    however many sessions are active. Receives pick a buffer from a ring of buffers registered
+    with the kernel up front, so an idle connection pins no buffer. Connections are accepted by
+    a multishot accept on the loop instead of the main thread's select. An accept failing for lack
+    of descriptors (EMFILE, ENFILE) is re-armed after a growing delay instead of at once.
+*/
+class UringEventLoop : public EventLoop
+{
+public:
+    // A submitted operation - resumes the coroutine with the completion result
+    struct Operation
+    {
+        std::coroutine_handle<> handle;
+        int result = 0;       // Bytes or -errno
+        uint32_t flags = 0;   // Completion flags (selected buffer)
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> awaiting) { this->handle = awaiting; }
+        int await_resume() const noexcept { return this->result; }
+    };
+
+private:
+    int ringFD;                                                       // io_uring instance
+    void *ringMemory;                                                 // Submission and completion rings (single mapping)
+    size_t ringSize;
+    io_uring_sqe *sqes;                                               // Submission entries
+    size_t sqesSize;
+    unsigned *sqHead, *sqTail, *sqMask, *sqArray;
+    unsigned *cqHead, *cqTail, *cqMask;
+    io_uring_cqe *cqes;
+    unsigned sqEntries;
+    unsigned localTail;                                               // Tail including the entries not yet published
+
+    io_uring_buf_ring *bufferRing;                                    // Provided receive buffers (shared with the kernel)
+    size_t bufferRingSize;
+    char *buffers;                                                    // Receive buffer memory
+    unsigned short bufferTail;                                        // Tail of the provided buffer ring
+
+    uint64_t wakeCount;                                               // Target of the eventfd read
+    int listenFD;                                                     // Accepting socket (-1 - main thread accepts)
+    bool multishotAccept;                                             // Cleared if the kernel rejects multishot accept
+    int acceptFailures;                                               // Failed accepts in a row (back-off of the re-arm)
+    __kernel_timespec acceptRetryDelay;                               // Timeout of the pending accept retry (read by the kernel)
+    std::function<void(int)> onAccept;
+    size_t inFlight;                                                  // Operations of sessions waiting for completion
+
+    void setupRing();                                                 // Throws std::runtime_error
+    void setupBuffers();                                              // Throws std::runtime_error
+    void releaseRing();
+    io_uring_sqe *getSQE();                                           // Next free submission entry (submits if the queue is full)
+    int submit(unsigned waitFor);                                     // Publish the queued entries and enter the kernel
+    void armWake();
+    void armAccept();
+    void armAcceptRetry();                                            // Re-arm the accept after a back-off delay
+    void recycleBuffer(unsigned short bufferID);
+    void handleCompletion(uint64_t userData, int result, uint32_t flags);
+    void drain();                                                     // Wait for the operations of the sessions at shutdown
+
+protected:
+    void run() override;
+
+public:
+    UringEventLoop(int index);                                        // Throws std::runtime_error if io_uring is not usable
+    ~UringEventLoop() override;
+
+    io_uring_sqe *prepare(uint8_t opcode, int fd, Operation *operation); // Queue an operation completing into the awaitable
+
+    Backend getBackend() const override { return IoUring; }
+    Task<ssize_t> read(int fd, char *buffer, size_t size) override;
+    Task<bool> sendAll(int fd, std::string message) override;
+    Task<ssize_t> receiveMsg(int fd, msghdr *message) override;
+    Task<ssize_t> sendMsg(int fd, const msghdr *message) override;
+    bool startAccept(int listenFD, std::function<void(int)> onAccept) override;
+};
+
+#endif
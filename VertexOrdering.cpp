@@ -0,0 +1,91 @@
+#include "VertexOrdering.hpp"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+VertexOrdering::Method VertexOrdering::parseMethod(const std::string &name)
+{
+    if (name == "none") return Identity;
+    if (name == "rcm") return ReverseCuthillMcKee;
+    if (name == "bfs") return BreadthFirst;
+    throw std::invalid_argument("Unknown vertex order " + name + " (none|rcm|bfs)");
+}
+
+std::string VertexOrdering::methodName(Method method)
+{
+    switch (method)
+    {
+        case ReverseCuthillMcKee:
+            return "rcm";
+        case BreadthFirst:
+            return "bfs";
+        default:
+            return "none";
+    }
+}
+
+// Breadth-first numbering of every component - the start vertex of a component is the first
+// unvisited one in startOrder, the neighbors of a vertex are visited in the order of lessNeighbor
+template <typename Less>
+static std::vector<int> breadthFirstOrder(const std::vector<int> &startOrder, const std::vector<int> &offsets,
+                                          const std::vector<int> &neighbors, Less lessNeighbor)
+{
+    int numVertices = static_cast<int>(startOrder.size());
+    std::vector<int> order;
+    order.reserve(numVertices);
+    std::vector<bool> visited(numVertices, false);
+    std::vector<int> level; // Neighbors of the current vertex that are not visited yet
+    for (int start : startOrder)
+    {
+        if (visited[start])
+        {
+            continue;
+        }
+        visited[start] = true;
+        size_t head = order.size();
+        order.push_back(start);
+        while (head < order.size())
+        {
+            int v = order[head++];
+            level.clear();
+            for (int i = offsets[v]; i < offsets[v + 1]; ++i)
+            {
+                if (!visited[neighbors[i]])
+                {
+                    visited[neighbors[i]] = true;
+                    level.push_back(neighbors[i]);
+                }
+            }
+            std::sort(level.begin(), level.end(), lessNeighbor);
+            order.insert(order.end(), level.begin(), level.end());
+        }
+    }
+    return order;
+}
+
+std::vector<int> VertexOrdering::compute(Method method, const std::vector<int> &offsets, const std::vector<int> &neighbors)
+{
+    int numVertices = static_cast<int>(offsets.size()) - 1;
+    std::vector<int> order(numVertices);
+    std::iota(order.begin(), order.end(), 0);
+    if (method == Identity)
+    {
+        return order;
+    }
+
+    auto degree = [&offsets](int v) { return offsets[v + 1] - offsets[v]; };
+    if (method == ReverseCuthillMcKee)
+    {
+        // Components start at their lowest degree vertex - a cheap stand-in for a peripheral one
+        std::stable_sort(order.begin(), order.end(), [&degree](int a, int b) { return degree(a) < degree(b); });
+        order = breadthFirstOrder(order, offsets, neighbors, [&degree](int a, int b)
+                                  { return degree(a) != degree(b) ? degree(a) < degree(b) : a < b; });
+        std::reverse(order.begin(), order.end());
+    }
+    else
+    {
+        std::stable_sort(order.begin(), order.end(), [&degree](int a, int b) { return degree(a) > degree(b); });
+        order = breadthFirstOrder(order, offsets, neighbors, [](int a, int b) { return a < b; });
+    }
+    return order;
+}
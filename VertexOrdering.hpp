@@ -0,0 +1,32 @@
+#ifndef VERTEXORDERING_HPP
+#define VERTEXORDERING_HPP
+
+#include <string>
+#include <vector>
+
+/*
+    Vertex relabeling for cache locality of the matrix kernels.
+    Reverse Cuthill-McKee numbers the vertices of each component in breadth-first order from a
+    low degree vertex, visiting neighbors by increasing degree, and reverses the result - the
+    edges gather near the diagonal, so a row scan touches few cache lines and pages.
+    Breadth-first numbers them in plain BFS order from the highest degree vertex, which keeps
+    the neighborhoods of the hubs together.
+    The graph is given in compressed form: the neighbors of v are neighbors[offsets[v], offsets[v + 1]).
+*/
+class VertexOrdering
+{
+public:
+    enum Method
+    {
+        Identity,               // Input order
+        ReverseCuthillMcKee,
+        BreadthFirst
+    };
+
+    static Method parseMethod(const std::string &name); // Throws std::invalid_argument
+    static std::string methodName(Method method);
+    // order[new id] = original id
+    static std::vector<int> compute(Method method, const std::vector<int> &offsets, const std::vector<int> &neighbors);
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef WEIGHTTRAITS_HPP
+#define WEIGHTTRAITS_HPP
+
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+
+/*
+    Edge weight types of the graph and MST templates.
+    A no-edge policy tells which matrix value marks a missing edge. ZeroNoEdge is the historic
+    layout (weight 0 is no edge); MaxNoEdge keeps zero weights usable and marks a missing edge
+    with the largest value of the type. Weights are never negative under either policy: the MST
+    distance metrics run Floyd-Warshall on the symmetric MST matrix, where a negative edge is a
+    negative cycle (addEdge rejects one). Sums of weights (MST weight, path lengths)
+    are accumulated in a wider type, so an int32 graph cannot overflow its MST weight.
+*/
+
+// Weight 0 marks a missing edge
+template <typename Weight>
+struct ZeroNoEdge
+{
+    static constexpr Weight noEdge = Weight(0);
+    static constexpr bool isEdge(Weight weight) { return weight != noEdge; }
+};
+
+// The largest weight (infinity for floating point) marks a missing edge - zero weights are edges
+template <typename Weight>
+struct MaxNoEdge
+{
+    static constexpr Weight noEdge = std::numeric_limits<Weight>::has_infinity ? std::numeric_limits<Weight>::infinity()
+                                                                              : std::numeric_limits<Weight>::max();
+    static constexpr bool isEdge(Weight weight) { return weight != noEdge; }
+};
+
+template <typename Weight>
+struct WeightTraits
+{
+    using Sum = std::conditional_t<std::is_floating_point_v<Weight>, double, int64_t>; // Sums of weights
+};
+
+// Weight types compiled into the library - the templates are defined in their .cpp files
+#define INSTANTIATE_WEIGHT_TYPES(Template) \
+    template class Template<uint8_t>;      \
+    template class Template<int16_t>;      \
+    template class Template<int32_t>;      \
+    template class Template<int64_t>;      \
+    template class Template<float>;
+
+// Weight types and no-edge policies compiled into the library
+#define INSTANTIATE_WEIGHT_POLICIES(Template)           \
+    INSTANTIATE_WEIGHT_TYPES(Template)                  \
+    template class Template<int32_t, MaxNoEdge<int32_t>>; \
+    template class Template<float, MaxNoEdge<float>>;
+
+#endif
@@ -0,0 +1,182 @@
+#include "WorkerSupervisor.hpp"
+#include "Logger.hpp"
+#include <iostream>
+#include <stdexcept>
+#include <climits>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/select.h>
+#include <sys/wait.h>
+
+#define NO_WORKER -1
+
+WorkerSupervisor::WorkerSupervisor(const ServerConfig &config, int argc, char *argv[])
+    : config(config), numRestarts(0)
+{
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+    if (length <= 0)
+    {
+        throw std::runtime_error("Cannot resolve the server binary: " + std::string(strerror(errno)));
+    }
+    this->executable.assign(path, length);
+    for (int i = 0; i < argc; ++i)
+    {
+        this->arguments.push_back(argv[i]);
+    }
+    this->store = SharedGraphStore::create(config.storeName(), static_cast<size_t>(config.storeMB) * 1024 * 1024);
+    this->workers.assign(config.workers, NO_WORKER);
+    for (int i = 0; i < config.workers; ++i)
+    {
+        this->workers[i] = startWorker(i);
+    }
+}
+
+WorkerSupervisor::~WorkerSupervisor()
+{
+    stopWorkers();
+    LOG_INFO("Supervisor: " << this->numRestarts << " worker restarts");
+}
+
+pid_t WorkerSupervisor::startWorker(int index)
+{
+    std::vector<std::string> workerArguments = this->arguments;
+    workerArguments.push_back("--worker=" + std::to_string(index));
+    std::vector<char *> argv;
+    for (auto &argument : workerArguments)
+    {
+        argv.push_back(argument.data());
+    }
+    argv.push_back(nullptr);
+
+    pid_t supervisor = getpid();
+    pid_t pid = fork();
+    if (pid == 0)
+    {
+        // Child - only async-signal-safe calls until exec
+        prctl(PR_SET_PDEATHSIG, SIGTERM); // Do not outlive the supervisor
+        if (getppid() != supervisor)
+        {
+            _exit(EXIT_FAILURE);
+        }
+        int devNull = open("/dev/null", O_RDONLY);
+        if (devNull >= 0)
+        {
+            dup2(devNull, STDIN_FILENO); // The console belongs to the supervisor
+            close(devNull);
+        }
+        execv(this->executable.c_str(), argv.data());
+        _exit(127);
+    }
+    if (pid < 0)
+    {
+        LOG_ERROR("Supervisor: fork of worker " << index << " failed: " << strerror(errno));
+        return NO_WORKER;
+    }
+    LOG_INFO("Supervisor: worker " << index << " started (pid " << pid << ")");
+    return pid;
+}
+
+void WorkerSupervisor::reapWorkers(bool restart)
+{
+    int status;
+    pid_t pid;
+    while ((pid = waitpid(-1, &status, WNOHANG)) > 0)
+    {
+        for (size_t index = 0; index < this->workers.size(); ++index)
+        {
+            if (this->workers[index] != pid)
+            {
+                continue;
+            }
+            int released = this->store->releaseClaims(pid);
+            if (WIFSIGNALED(status))
+            {
+                LOG_WARN("Supervisor: worker " << index << " (pid " << pid << ") killed by signal " << WTERMSIG(status) << ", " << released << " claimed graphs released");
+            }
+            else
+            {
+                LOG_WARN("Supervisor: worker " << index << " (pid " << pid << ") exited with status " << WEXITSTATUS(status) << ", " << released << " claimed graphs released");
+            }
+            this->workers[index] = NO_WORKER;
+            if (restart)
+            {
+                this->workers[index] = startWorker(index);
+                this->numRestarts++;
+            }
+        }
+    }
+}
+
+void WorkerSupervisor::stopWorkers()
+{
+    for (pid_t pid : this->workers)
+    {
+        if (pid != NO_WORKER)
+        {
+            kill(pid, SIGTERM);
+        }
+    }
+    for (pid_t &pid : this->workers)
+    {
+        if (pid != NO_WORKER)
+        {
+            waitpid(pid, nullptr, 0);
+            this->store->releaseClaims(pid);
+            pid = NO_WORKER;
+        }
+    }
+    LOG_INFO("Supervisor: all workers stopped");
+}
+
+std::string WorkerSupervisor::collectStatistics() const
+{
+    std::string report = "********* Worker Processes *********\n";
+    for (size_t index = 0; index < this->workers.size(); ++index)
+    {
+        report += "Worker " + std::to_string(index) + " | pid " + std::to_string(this->workers[index]) + "\n";
+    }
+    report += "Restarts: " + std::to_string(this->numRestarts) + "\n";
+    report += "********* Shared Graph Store *********\n";
+    report += this->store->getStatistics();
+    return report;
+}
+
+void WorkerSupervisor::run()
+{
+    int stdin_fd = fileno(stdin);
+    while (true)
+    {
+        fd_set readfds;
+        FD_ZERO(&readfds);
+        FD_SET(stdin_fd, &readfds);
+        struct timeval timeout = {1, 0};
+        int activity = select(stdin_fd + 1, &readfds, NULL, NULL, &timeout);
+        reapWorkers(true);
+        if (activity <= 0 || !FD_ISSET(stdin_fd, &readfds))
+        {
+            continue;
+        }
+
+        std::string command;
+        if (!std::getline(std::cin, command) || command == "stop")
+        {
+            LOG_INFO("Command: stop");
+            return;
+        }
+        if (command == "stats")
+        {
+            std::string report = collectStatistics();
+            Logger::getInstance().flush();
+            std::cout << report << std::flush;
+        }
+        else
+        {
+            LOG_WARN("Supervisor: only stop and stats are available in multi-process mode - statistics of a worker are on its menu option 5");
+        }
+    }
+}
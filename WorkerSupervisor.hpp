@@ -0,0 +1,40 @@
+#ifndef WORKERSUPERVISOR_HPP
+#define WORKERSUPERVISOR_HPP
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <sys/types.h>
+#include "ServerConfig.hpp"
+#include "SharedGraphStore.hpp"
+
+/*
+    Multi-process mode (--workers=N): creates the shared graph store and runs N worker processes.
+    Every worker is a full server started with the same command line plus --worker=i, so it starts
+    clean (no inherited threads) and binds its own SO_REUSEPORT socket - the kernel spreads the
+    connections over the workers. A worker that dies is restarted and its claimed graphs are
+    returned to the store. The supervisor keeps the console (stop, stats).
+*/
+class WorkerSupervisor
+{
+private:
+    ServerConfig config;
+    std::string executable;                   // Path of the server binary
+    std::vector<std::string> arguments;       // Command line of the workers
+    std::unique_ptr<SharedGraphStore> store;
+    std::vector<pid_t> workers;               // Pid of every worker slot (-1 - not running)
+    int numRestarts;                          // Workers restarted after dying
+
+    pid_t startWorker(int index);
+    void reapWorkers(bool restart);           // Collect dead workers, release their claims, restart them
+    void stopWorkers();                       // SIGTERM every worker and wait for it
+    std::string collectStatistics() const;
+
+public:
+    WorkerSupervisor(const ServerConfig &config, int argc, char *argv[]); // Throws std::runtime_error
+    ~WorkerSupervisor();                                                 // Stops the workers, removes the store
+
+    void run(); // Console loop until stop
+};
+
+#endif